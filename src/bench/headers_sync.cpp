@@ -0,0 +1,153 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <kernel/chainparams.h>
+#include <node/kernel_notifications.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <test/util/setup_common.h>
+#include <timedata.h>
+#include <util/chaintype.h>
+#include <validation.h>
+
+#include <cassert>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace {
+
+//! Height of the BTCBT fork in the synthetic chain; the chain extends as far again after it.
+constexpr int FORK_HEIGHT{3000};
+constexpr int NUM_HEADERS{2 * FORK_HEIGHT};
+//! Headers per message, MAX_HEADERS_RESULTS in net_processing.cpp
+constexpr size_t HEADERS_BATCH_SIZE{2000};
+
+/**
+ * Regtest, with retargeting and the BTCBT fork schedule enabled, so that headers go through the
+ * legacy difficulty adjustment before the fork and the post-fork rules after it.
+ */
+struct ForkingRegTestParams : public CChainParams {
+    explicit ForkingRegTestParams(const CChainParams& base) : CChainParams{base}
+    {
+        consensus.fPowNoRetargeting = false;
+        consensus.fPowAllowMinDifficultyBlocks = false;
+        consensus.btcbt_fork_block_height = FORK_HEIGHT;
+        consensus.btcbt_block_interval = 5 * 60;
+        // Post-fork headers stay in warmup: the ASERT computation needs a powLimit far too low to
+        // mine in a benchmark, it is measured on its own below.
+        consensus.btcbt_asert_anchor_height = NUM_HEADERS + 1;
+    }
+};
+
+/** Mine a chain of NUM_HEADERS headers on top of genesis, with nBits as the rules require. */
+std::vector<CBlockHeader> MineHeaders(const Consensus::Params& consensus, const CBlockHeader& genesis)
+{
+    std::vector<CBlockHeader> headers;
+    std::vector<uint256> hashes;
+    std::deque<CBlockIndex> index;
+    headers.reserve(NUM_HEADERS);
+    hashes.reserve(NUM_HEADERS + 1);
+
+    hashes.push_back(genesis.GetHash());
+    index.emplace_back(genesis);
+    index.back().phashBlock = &hashes.back();
+
+    for (int height = 1; height <= NUM_HEADERS; ++height) {
+        CBlockIndex& prev{index.back()};
+        CBlockHeader header;
+        header.nVersion = VERSIONBITS_TOP_BITS;
+        header.hashPrevBlock = hashes.back();
+        header.hashMerkleRoot = ArithToUint256(arith_uint256(height));
+        header.nTime = prev.nTime + (height <= FORK_HEIGHT ? consensus.nPowTargetSpacing : consensus.btcbt_block_interval);
+        header.nBits = GetNextWorkRequired(&prev, &header, consensus);
+        while (!CheckProofOfWork(header.GetHash(), header.nBits, consensus)) ++header.nNonce;
+
+        headers.push_back(header);
+        hashes.push_back(header.GetHash());
+        index.emplace_back(header);
+        index.back().phashBlock = &hashes.back();
+        index.back().pprev = &prev;
+        index.back().nHeight = height;
+        index.back().BuildSkip();
+    }
+    return headers;
+}
+
+} // namespace
+
+/**
+ * Headers-first sync from genesis through the BTCBT fork: feed a fresh ChainstateManager the
+ * whole header chain in batches of one headers message each, as net_processing does during IBD.
+ * Reported per header.
+ */
+static void HeadersSync(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const ChainTestingSetup>(ChainType::REGTEST)};
+    const ForkingRegTestParams params{testing_setup->m_node.chainman->GetParams()};
+    const CBlockHeader genesis{params.GenesisBlock().GetBlockHeader()};
+    const std::vector<CBlockHeader> headers{MineHeaders(params.GetConsensus(), genesis)};
+
+    bench.batch(NUM_HEADERS).unit("header").run([&] {
+        const ChainstateManager::Options chainman_opts{
+            .chainparams = params,
+            .datadir = testing_setup->m_path_root,
+            .adjusted_time_callback = GetAdjustedTime,
+            .check_block_index = false,
+            .notifications = *testing_setup->m_node.notifications,
+        };
+        const node::BlockManager::Options blockman_opts{
+            .chainparams = params,
+            .blocks_dir = testing_setup->m_path_root / "blocks",
+            .notifications = chainman_opts.notifications,
+        };
+        ChainstateManager chainman{testing_setup->m_node.kernel->interrupt, chainman_opts, blockman_opts};
+        WITH_LOCK(::cs_main, chainman.InitializeChainstate(/*mempool=*/nullptr));
+
+        BlockValidationState state;
+        bool ok{chainman.ProcessNewBlockHeaders({genesis}, /*min_pow_checked=*/true, state)};
+        for (size_t i = 0; ok && i < headers.size(); i += HEADERS_BATCH_SIZE) {
+            const std::vector<CBlockHeader> batch(headers.begin() + i, headers.begin() + std::min(i + HEADERS_BATCH_SIZE, headers.size()));
+            ok = chainman.ProcessNewBlockHeaders(batch, /*min_pow_checked=*/true, state);
+        }
+        assert(ok);
+        assert(WITH_LOCK(::cs_main, return chainman.m_best_header->nHeight) == NUM_HEADERS);
+    });
+}
+
+/**
+ * Difficulty computation alone for post-fork headers with the BTCBT chain's parameters, where every
+ * header goes through ASERT. The fork is moved to a low height to keep the index small.
+ */
+static void HeadersNextWorkRequiredASERT(benchmark::Bench& bench)
+{
+    Consensus::Params consensus{CChainParams::BTCBT()->GetConsensus()};
+    consensus.btcbt_fork_block_height = 100;
+    consensus.btcbt_asert_anchor_height = consensus.btcbt_fork_block_height + 2;
+    constexpr int NUM_BLOCKS{2000};
+
+    std::vector<CBlockIndex> index(consensus.btcbt_asert_anchor_height + NUM_BLOCKS + 1);
+    for (size_t i = 0; i < index.size(); ++i) {
+        index[i].nHeight = i;
+        // Irregular block times, so that the target moves around.
+        index[i].nTime = 1'750'000'000 + i * consensus.btcbt_block_interval + (i % 7) * 37;
+        index[i].pprev = i > 0 ? &index[i - 1] : nullptr;
+        index[i].nBits = i > 0 ? GetNextWorkRequired(&index[i - 1], nullptr, consensus) : consensus.btcbt_asert_anchor_bits;
+        index[i].BuildSkip();
+    }
+
+    bench.batch(NUM_BLOCKS).unit("header").run([&] {
+        for (size_t i = index.size() - NUM_BLOCKS; i < index.size(); ++i) {
+            CBlockHeader header;
+            header.nTime = index[i].nTime;
+            const unsigned int bits{GetNextWorkRequired(&index[i - 1], &header, consensus)};
+            assert(bits == index[i].nBits);
+        }
+    });
+}
+
+BENCHMARK(HeadersSync, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HeadersNextWorkRequiredASERT, benchmark::PriorityLevel::HIGH);
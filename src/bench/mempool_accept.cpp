@@ -0,0 +1,164 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <addresstype.h>
+#include <coins.h>
+#include <consensus/amount.h>
+#include <key.h>
+#include <node/miner.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <script/sign.h>
+#include <script/signingprovider.h>
+#include <sync.h>
+#include <test/util/mining.h>
+#include <test/util/setup_common.h>
+#include <util/time.h>
+#include <util/translation.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//! Transactions accepted per benchmark iteration.
+constexpr size_t TXS_PER_ITERATION{1000};
+constexpr size_t ITERATIONS{5};
+constexpr size_t OUTPUTS_PER_FUNDING_TX{500};
+
+/**
+ * Mine coinbases paying to a P2WPKH key, fan the mature ones out into P2WPKH coins in a further
+ * block, and sign a one-input, one-output transaction spending each of those, none depending on
+ * another.
+ */
+std::vector<CTransactionRef> MakeIndependentSpends(const node::NodeContext& node, size_t count)
+{
+    CKey key;
+    key.MakeNewKey(/*fCompressed=*/true);
+    FillableSigningProvider keystore;
+    keystore.AddKey(key);
+    const CScript p2wpkh{GetScriptForDestination(WitnessV0KeyHash(key.GetPubKey()))};
+
+    const size_t num_funding{(count + OUTPUTS_PER_FUNDING_TX - 1) / OUTPUTS_PER_FUNDING_TX};
+    std::vector<COutPoint> coinbases;
+    for (size_t b = 0; b < COINBASE_MATURITY + num_funding; ++b) {
+        coinbases.push_back(MineBlock(node, p2wpkh));
+    }
+
+    std::vector<CMutableTransaction> funding_txs;
+    for (size_t f = 0; f < num_funding; ++f) {
+        const Coin coinbase{WITH_LOCK(::cs_main, return node.chainman->ActiveChainstate().CoinsTip().AccessCoin(coinbases[f]))};
+        assert(!coinbase.IsSpent());
+        CMutableTransaction funding;
+        funding.vin.emplace_back(coinbases[f]);
+        const CAmount value{(coinbase.out.nValue - COIN / 100) / CAmount(OUTPUTS_PER_FUNDING_TX)};
+        funding.vout.assign(OUTPUTS_PER_FUNDING_TX, CTxOut{value, p2wpkh});
+        std::map<COutPoint, Coin> coins{{coinbases[f], coinbase}};
+        std::map<int, bilingual_str> input_errors;
+        assert(SignTransaction(funding, &keystore, coins, SIGHASH_ALL, input_errors));
+        funding_txs.push_back(std::move(funding));
+    }
+    auto block{PrepareBlock(node, CScript() << OP_TRUE)};
+    // PrepareBlock() dates blocks just past the median time, before the BIP16 switch time, which
+    // would leave P2SH, and with it witness sigop counting, disabled for this block and the mempool.
+    block->nTime = GetTime();
+    for (const auto& funding : funding_txs) block->vtx.push_back(MakeTransactionRef(funding));
+    node::RegenerateCommitments(*block, *node.chainman);
+    assert(!MineBlock(node, block).IsNull());
+
+    std::vector<CTransactionRef> spends;
+    spends.reserve(count);
+    for (const CMutableTransaction& funding : funding_txs) {
+        const uint256 funding_txid{funding.GetHash()};
+        for (uint32_t n = 0; n < funding.vout.size() && spends.size() < count; ++n) {
+            CMutableTransaction spend;
+            spend.vin.emplace_back(COutPoint{funding_txid, n});
+            spend.vout.emplace_back(funding.vout[n].nValue - 1000, p2wpkh);
+            std::map<COutPoint, Coin> coins{{spend.vin[0].prevout, Coin{funding.vout[n], /*nHeightIn=*/1, /*fCoinBaseIn=*/false}}};
+            std::map<int, bilingual_str> input_errors;
+            assert(SignTransaction(spend, &keystore, coins, SIGHASH_ALL, input_errors));
+            spends.push_back(MakeTransactionRef(std::move(spend)));
+        }
+    }
+    return spends;
+}
+
+} // namespace
+
+/** Single-threaded acceptance of independent P2WPKH spends, holding cs_main throughout. */
+static void MempoolAcceptSerial(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST, {"-checkmempool=0"})};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    const std::vector<CTransactionRef> txs{MakeIndependentSpends(testing_setup->m_node, TXS_PER_ITERATION * ITERATIONS)};
+
+    size_t next{0};
+    bench.epochs(ITERATIONS).epochIterations(1).batch(TXS_PER_ITERATION).unit("tx").run([&] {
+        LOCK(::cs_main);
+        for (size_t i = 0; i < TXS_PER_ITERATION; ++i) {
+            const MempoolAcceptResult result{chainman.ProcessTransaction(txs.at(next++))};
+            assert(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+        }
+    });
+}
+
+/**
+ * The same transactions accepted by a pool of threads, which only serialize on cs_main and the
+ * mempool lock for the lookups and the insertion, not for the script checks.
+ */
+static void MempoolAcceptParallel(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST, {"-checkmempool=0"})};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    const std::vector<CTransactionRef> txs{MakeIndependentSpends(testing_setup->m_node, TXS_PER_ITERATION * ITERATIONS)};
+    const unsigned num_threads{std::clamp(std::thread::hardware_concurrency(), 2U, 16U)};
+
+    size_t batch_begin{0};
+    bench.epochs(ITERATIONS).epochIterations(1).batch(TXS_PER_ITERATION).unit("tx").run([&] {
+        std::atomic<size_t> next{batch_begin};
+        const size_t batch_end{batch_begin + TXS_PER_ITERATION};
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < num_threads; ++t) {
+            workers.emplace_back([&] {
+                for (size_t i = next++; i < batch_end; i = next++) {
+                    const MempoolAcceptResult result{chainman.ProcessTransactionConcurrent(txs.at(i))};
+                    assert(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        batch_begin = batch_end;
+    });
+}
+
+/**
+ * The same transactions accepted as one batch per iteration: one cs_main and mempool lock hold,
+ * one coins view, and the scripts verified together on the script check threads.
+ */
+static void MempoolAcceptBatch(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST, {"-checkmempool=0"})};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    const std::vector<CTransactionRef> txs{MakeIndependentSpends(testing_setup->m_node, TXS_PER_ITERATION * ITERATIONS)};
+
+    size_t batch_begin{0};
+    bench.epochs(ITERATIONS).epochIterations(1).batch(TXS_PER_ITERATION).unit("tx").run([&] {
+        const std::vector<CTransactionRef> batch(txs.begin() + batch_begin, txs.begin() + batch_begin + TXS_PER_ITERATION);
+        const auto results{WITH_LOCK(::cs_main, return chainman.ProcessTransactionBatch(batch))};
+        for (const auto& result : results) {
+            assert(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+        }
+        batch_begin += TXS_PER_ITERATION;
+    });
+}
+
+BENCHMARK(MempoolAcceptSerial, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolAcceptParallel, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolAcceptBatch, benchmark::PriorityLevel::HIGH);
@@ -5,9 +5,12 @@
 #include <bench/bench.h>
 #include <kernel/mempool_entry.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <test/util/setup_common.h>
 #include <txmempool.h>
 
+#include <vector>
+
 
 static void AddTx(const CTransactionRef& tx, const CAmount& nFee, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
 {
@@ -134,4 +137,80 @@ static void MempoolEviction(benchmark::Bench& bench)
     });
 }
 
+//! Transactions arriving per benchmark epoch at a mempool that is already full.
+static constexpr size_t OVERLOAD_TXS_PER_EPOCH{10'000};
+static constexpr size_t OVERLOAD_EPOCHS{5};
+
+/**
+ * Keep a 5MB mempool full with a stream of transactions of random feerates, in chains of the given
+ * length, limiting its size after every transaction as mempool acceptance does.
+ */
+static void RunOverload(benchmark::Bench& bench, size_t chain_length, bool trim_to_limit)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN, {"-maxmempool=5", "-checkmempool=0"});
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext det_rand{/*fDeterministic=*/true};
+
+    const auto make_tx = [&](const COutPoint& prevout) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(prevout);
+        tx.vin[0].scriptWitness.stack.push_back(det_rand.randbytes(72));
+        tx.vout.emplace_back(COIN, CScript() << OP_0 << det_rand.randbytes(20));
+        return MakeTransactionRef(std::move(tx));
+    };
+    std::vector<CTransactionRef> txs;
+    COutPoint prevout;
+    const auto next_tx = [&]() -> const CTransactionRef& {
+        if (txs.size() % chain_length == 0) prevout = COutPoint{det_rand.rand256(), 0};
+        txs.push_back(make_tx(prevout));
+        prevout = COutPoint{txs.back()->GetHash(), 0};
+        return txs.back();
+    };
+
+    LOCK2(cs_main, pool.cs);
+    while (pool.DynamicMemoryUsage() <= static_cast<size_t>(pool.m_max_size_bytes)) {
+        AddTx(next_tx(), det_rand.randrange(20000) + 1000, pool);
+    }
+    txs.reserve(txs.size() + OVERLOAD_TXS_PER_EPOCH * OVERLOAD_EPOCHS);
+    for (size_t i = 0; i < OVERLOAD_TXS_PER_EPOCH * OVERLOAD_EPOCHS; ++i) next_tx();
+
+    size_t next{txs.size() - OVERLOAD_TXS_PER_EPOCH * OVERLOAD_EPOCHS};
+    bench.epochs(OVERLOAD_EPOCHS).epochIterations(OVERLOAD_TXS_PER_EPOCH).unit("tx").run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        AddTx(txs.at(next++), det_rand.randrange(20000) + 1000, pool);
+        if (trim_to_limit) {
+            pool.TrimToSize(pool.m_max_size_bytes);
+        } else {
+            pool.LimitSize();
+        }
+    });
+}
+
+/** Independent transactions, trimmed down below the limit once over it. */
+static void MempoolEvictionOverload(benchmark::Bench& bench)
+{
+    RunOverload(bench, /*chain_length=*/1, /*trim_to_limit=*/false);
+}
+
+/** Chains of 25 transactions, trimmed down below the limit once over it. */
+static void MempoolEvictionOverloadChains(benchmark::Bench& bench)
+{
+    RunOverload(bench, /*chain_length=*/25, /*trim_to_limit=*/false);
+}
+
+/** Chains of 25 transactions, trimmed back to the limit after every one. */
+static void MempoolEvictionOverloadChainsPerTx(benchmark::Bench& bench)
+{
+    RunOverload(bench, /*chain_length=*/25, /*trim_to_limit=*/true);
+}
+
+/** Independent transactions, trimmed back to the limit after every one, evicting one at a time. */
+static void MempoolEvictionOverloadPerTx(benchmark::Bench& bench)
+{
+    RunOverload(bench, /*chain_length=*/1, /*trim_to_limit=*/true);
+}
+
 BENCHMARK(MempoolEviction, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolEvictionOverload, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolEvictionOverloadChains, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolEvictionOverloadPerTx, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolEvictionOverloadChainsPerTx, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,56 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <kernel/mempool_persist.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <cassert>
+#include <cstddef>
+
+//! Size of a large mempool, at around 250 bytes per transaction.
+static constexpr size_t DUMP_TXS{500'000};
+
+/** Dump a mempool of independent transactions and short chains to disk. */
+static void MempoolDump(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN, {"-checkmempool=0"})};
+    CTxMemPool& pool{*testing_setup->m_node.mempool};
+    const Chainstate& chainstate{testing_setup->m_node.chainman->ActiveChainstate()};
+    const fs::path dump_path{testing_setup->m_path_root / "mempool.dat"};
+
+    FastRandomContext det_rand{/*fDeterministic=*/true};
+    TestMemPoolEntryHelper entry;
+    {
+        LOCK2(::cs_main, pool.cs);
+        COutPoint prevout;
+        for (size_t i = 0; i < DUMP_TXS; ++i) {
+            // Every fourth transaction starts a new chain.
+            if (i % 4 == 0) prevout = COutPoint{det_rand.rand256(), 0};
+            CMutableTransaction tx;
+            tx.vin.emplace_back(prevout);
+            tx.vin[0].scriptWitness.stack.push_back(det_rand.randbytes(72));
+            tx.vin[0].scriptWitness.stack.push_back(det_rand.randbytes(33));
+            tx.vout.emplace_back(COIN, CScript() << OP_0 << det_rand.randbytes(20));
+            tx.vout.emplace_back(COIN, CScript() << OP_0 << det_rand.randbytes(20));
+            const CTransactionRef ref{MakeTransactionRef(std::move(tx))};
+            pool.addUnchecked(entry.Fee(det_rand.randrange(10000) + 1000).FromTx(ref));
+            prevout = COutPoint{ref->GetHash(), 0};
+        }
+    }
+
+    bench.epochs(3).epochIterations(1).batch(DUMP_TXS).unit("tx").run([&] {
+        const bool dumped{kernel::DumpMempool(pool, dump_path, chainstate, fsbridge::fopen, /*skip_file_commit=*/true)};
+        assert(dumped);
+    });
+}
+
+BENCHMARK(MempoolDump, benchmark::PriorityLevel::HIGH);
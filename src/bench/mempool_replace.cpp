@@ -0,0 +1,135 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <addresstype.h>
+#include <coins.h>
+#include <consensus/amount.h>
+#include <consensus/consensus.h>
+#include <node/miner.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/mining.h>
+#include <test/util/setup_common.h>
+#include <util/rbf.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <cassert>
+#include <vector>
+
+namespace {
+
+//! Conflict graphs set up per benchmark, one of which is replaced per iteration.
+constexpr size_t GRAPHS{50};
+constexpr size_t EPOCHS{5};
+constexpr CAmount ORIGINAL_FEE{1000};
+//! Depth of the replaced chain, the default ancestor limit.
+constexpr size_t CHAIN_DEPTH{25};
+//! Children of the parent whose outputs are all replaced, the most a replacement may evict.
+constexpr size_t CHILDREN{100};
+
+const CScript WITNESS_SCRIPT{CScript() << OP_TRUE};
+
+/** Spend the given outputs of anyone-can-spend P2WSH coins into equal outputs of the same kind, signaling replaceability. */
+CTransactionRef MakeSpend(const std::vector<COutPoint>& prevouts, CAmount value, size_t num_outputs)
+{
+    CMutableTransaction tx;
+    for (const COutPoint& prevout : prevouts) {
+        tx.vin.emplace_back(prevout, CScript{}, MAX_BIP125_RBF_SEQUENCE);
+        tx.vin.back().scriptWitness.stack.emplace_back(WITNESS_SCRIPT.begin(), WITNESS_SCRIPT.end());
+    }
+    tx.vout.assign(num_outputs, CTxOut{value / CAmount(num_outputs), GetScriptForDestination(WitnessV0ScriptHash(WITNESS_SCRIPT))});
+    return MakeTransactionRef(std::move(tx));
+}
+
+/** Mine a transaction splitting a mature coinbase into one coin per conflict graph. */
+std::vector<std::pair<COutPoint, CAmount>> MakeCoins(const node::NodeContext& node)
+{
+    const CScript p2wsh{GetScriptForDestination(WitnessV0ScriptHash(WITNESS_SCRIPT))};
+    std::vector<COutPoint> coinbases;
+    for (int i = 0; i < COINBASE_MATURITY + 1; ++i) coinbases.push_back(MineBlock(node, p2wsh));
+    const Coin coinbase{WITH_LOCK(::cs_main, return node.chainman->ActiveChainstate().CoinsTip().AccessCoin(coinbases[0]))};
+    assert(!coinbase.IsSpent());
+    const CTransactionRef funding{MakeSpend({coinbases[0]}, coinbase.out.nValue - COIN / 100, GRAPHS)};
+
+    auto block{PrepareBlock(node, CScript() << OP_TRUE)};
+    // PrepareBlock() dates blocks before the BIP16 switch time, which would leave witness
+    // verification disabled for the mempool.
+    block->nTime = GetTime();
+    block->vtx.push_back(funding);
+    node::RegenerateCommitments(*block, *node.chainman);
+    assert(!MineBlock(node, block).IsNull());
+
+    std::vector<std::pair<COutPoint, CAmount>> coins;
+    for (uint32_t n = 0; n < funding->vout.size(); ++n) coins.emplace_back(COutPoint{funding->GetHash(), n}, funding->vout[n].nValue);
+    return coins;
+}
+
+void Submit(ChainstateManager& chainman, const CTransactionRef& tx) EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+{
+    const MempoolAcceptResult result{chainman.ProcessTransaction(tx)};
+    assert(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+}
+
+void RunReplacements(benchmark::Bench& bench, ChainstateManager& chainman, const std::vector<CTransactionRef>& replacements)
+{
+    size_t next{0};
+    bench.epochs(EPOCHS).epochIterations(GRAPHS / EPOCHS).unit("replacement").run([&] {
+        LOCK(::cs_main);
+        Submit(chainman, replacements.at(next++));
+    });
+}
+
+} // namespace
+
+/** Replace the root of a chain of 25 transactions, evicting all of it. */
+static void MempoolReplaceChain(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST, {"-checkmempool=0"})};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    std::vector<CTransactionRef> replacements;
+    LOCK(::cs_main);
+    for (const auto& [coin, value] : MakeCoins(testing_setup->m_node)) {
+        COutPoint prevout{coin};
+        CAmount remaining{value};
+        for (size_t i = 0; i < CHAIN_DEPTH; ++i) {
+            remaining -= ORIGINAL_FEE;
+            const CTransactionRef tx{MakeSpend({prevout}, remaining, 1)};
+            Submit(chainman, tx);
+            prevout = COutPoint{tx->GetHash(), 0};
+        }
+        replacements.push_back(MakeSpend({coin}, value - 2 * CHAIN_DEPTH * ORIGINAL_FEE, 1));
+    }
+    RunReplacements(bench, chainman, replacements);
+}
+
+/**
+ * Replace the 100 children of a parent with one transaction spending all the parent's outputs:
+ * 100 direct conflicts, all in the parent's cluster.
+ */
+static void MempoolReplaceWide(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST, {"-checkmempool=0", "-limitdescendantcount=200"})};
+    ChainstateManager& chainman{*testing_setup->m_node.chainman};
+    std::vector<CTransactionRef> replacements;
+    LOCK(::cs_main);
+    for (const auto& [coin, value] : MakeCoins(testing_setup->m_node)) {
+        const CTransactionRef parent{MakeSpend({coin}, value - 10 * ORIGINAL_FEE, CHILDREN)};
+        Submit(chainman, parent);
+        std::vector<COutPoint> outputs;
+        for (uint32_t n = 0; n < CHILDREN; ++n) {
+            outputs.emplace_back(parent->GetHash(), n);
+            Submit(chainman, MakeSpend({outputs.back()}, parent->vout[n].nValue - ORIGINAL_FEE, 1));
+        }
+        CAmount total{0};
+        for (const CTxOut& out : parent->vout) total += out.nValue;
+        replacements.push_back(MakeSpend(outputs, total - 2 * CHILDREN * ORIGINAL_FEE, 1));
+    }
+    RunReplacements(bench, chainman, replacements);
+}
+
+BENCHMARK(MempoolReplaceChain, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolReplaceWide, benchmark::PriorityLevel::HIGH);
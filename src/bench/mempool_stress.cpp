@@ -4,6 +4,8 @@
 
 #include <bench/bench.h>
 #include <kernel/mempool_entry.h>
+#include <node/mempool_fee_estimator.h>
+#include <node/mini_miner.h>
 #include <policy/policy.h>
 #include <random.h>
 #include <test/util/setup_common.h>
@@ -13,7 +15,7 @@
 
 #include <vector>
 
-static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool, CAmount fee = 1000) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
 {
     int64_t nTime = 0;
     unsigned int nHeight = 1;
@@ -21,7 +23,7 @@ static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_R
     bool spendsCoinbase = false;
     unsigned int sigOpCost = 4;
     LockPoints lp;
-    pool.addUnchecked(CTxMemPoolEntry(tx, 1000, nTime, nHeight, sequence, spendsCoinbase, sigOpCost, lp));
+    pool.addUnchecked(CTxMemPoolEntry(tx, fee, nTime, nHeight, sequence, spendsCoinbase, sigOpCost, lp));
 }
 
 struct Available {
@@ -118,5 +120,85 @@ static void MempoolCheck(benchmark::Bench& bench)
     });
 }
 
+static void MempoolLinearizeClusters(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    std::vector<CTransactionRef> ordered_coins = CreateOrderedCoins(det_rand, /*childTxs=*/800, /*min_ancestors=*/1);
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    LOCK2(cs_main, pool.cs);
+    for (auto& tx : ordered_coins) {
+        AddTx(tx, pool, /*fee=*/det_rand.randrange(10000) + 100);
+    }
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        const auto clusters{pool.GetAllClusters()};
+        ankerl::nanobench::doNotOptimizeAway(clusters.size());
+    });
+}
+
+static void MempoolRemoveForBlock(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    std::vector<CTransactionRef> ordered_coins = CreateOrderedCoins(det_rand, /*childTxs=*/800, /*min_ancestors=*/1);
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    // The first half of the transactions is mined, leaving their descendants to be updated.
+    const std::vector<CTransactionRef> block_txs(ordered_coins.begin(), ordered_coins.begin() + ordered_coins.size() / 2);
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (auto& tx : ordered_coins) {
+            AddTx(tx, pool);
+        }
+        pool.removeForBlock(block_txs, /*nBlockHeight=*/1);
+        pool.TrimToSize(0);
+    });
+}
+
+static void MempoolSimulateBlocks(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    std::vector<CTransactionRef> ordered_coins = CreateOrderedCoins(det_rand, /*childTxs=*/800, /*min_ancestors=*/1);
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    int64_t total_vsize{0};
+    {
+        LOCK2(cs_main, pool.cs);
+        for (auto& tx : ordered_coins) {
+            AddTx(tx, pool, /*fee=*/det_rand.randrange(10000) + 100);
+        }
+        total_vsize = pool.GetTotalTxSize();
+    }
+    // Split the mempool into ten blocks.
+    bench.run([&] {
+        const auto blocks{node::MiniMiner{pool}.BuildMockBlocks(total_vsize / 10, /*num_blocks=*/10)};
+        assert(!blocks.empty());
+    });
+}
+
+/** Estimates between mempool changes, answered from the last simulation. */
+static void MempoolFeeEstimateCached(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    std::vector<CTransactionRef> ordered_coins = CreateOrderedCoins(det_rand, /*childTxs=*/800, /*min_ancestors=*/1);
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    const ChainstateManager& chainman = *testing_setup.get()->m_node.chainman;
+    {
+        LOCK2(cs_main, pool.cs);
+        for (auto& tx : ordered_coins) {
+            AddTx(tx, pool, /*fee=*/det_rand.randrange(10000) + 100);
+        }
+    }
+    node::MempoolFeeEstimator estimator;
+    unsigned int target{0};
+    bench.run([&] {
+        ankerl::nanobench::doNotOptimizeAway(estimator.EstimateFee(pool, chainman, target++ % 6 + 1));
+    });
+}
+
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolLinearizeClusters, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolRemoveForBlock, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolSimulateBlocks, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolFeeEstimateCached, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,126 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <kernel/mempool_entry.h>
+#include <policy/fees.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr unsigned int REPLAY_BLOCKS{200};
+constexpr size_t ARRIVALS_PER_BLOCK{400};
+constexpr size_t TXS_PER_BLOCK{350};
+//! Transactions still unconfirmed after this many blocks are evicted from the mempool.
+constexpr unsigned int EXPIRY_BLOCKS{72};
+
+/** What the mempool reported to the estimator around one block. */
+struct ReplayBlock {
+    std::vector<const CTxMemPoolEntry*> arrivals;
+    std::vector<const CTxMemPoolEntry*> evictions;
+    std::vector<const CTxMemPoolEntry*> confirmed;
+};
+
+/** A recorded run of the mempool: a steady inflow of transactions of log-uniform feerates, of
+ *  which blocks confirm the highest paying ones, leaving a backlog that is eventually evicted. */
+struct ReplayTrace {
+    std::vector<std::unique_ptr<CTxMemPoolEntry>> entries;
+    std::vector<ReplayBlock> blocks;
+
+    ReplayTrace()
+    {
+        FastRandomContext rng{/*fDeterministic=*/true};
+        TestMemPoolEntryHelper entry_helper;
+        std::vector<std::pair<const CTxMemPoolEntry*, unsigned int>> pending;
+        for (unsigned int height = 1; height <= REPLAY_BLOCKS; ++height) {
+            ReplayBlock& block{blocks.emplace_back()};
+            for (size_t i = 0; i < ARRIVALS_PER_BLOCK; ++i) {
+                CMutableTransaction mtx;
+                mtx.vin.emplace_back(COutPoint{rng.rand256(), 0});
+                mtx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+                const CTransactionRef tx{MakeTransactionRef(std::move(mtx))};
+                const double feerate{1000 * std::pow(100.0, rng.randrange(1000) / 1000.0)};
+                const CAmount fee{static_cast<CAmount>(feerate * tx->GetTotalSize() / 1000)};
+                entries.push_back(std::make_unique<CTxMemPoolEntry>(entry_helper.Fee(fee).Height(height).FromTx(tx)));
+                block.arrivals.push_back(entries.back().get());
+                pending.emplace_back(entries.back().get(), height);
+            }
+            std::sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+                return a.first->GetModifiedFee() > b.first->GetModifiedFee();
+            });
+            const size_t mined{std::min(TXS_PER_BLOCK, pending.size())};
+            for (size_t i = 0; i < mined; ++i) block.confirmed.push_back(pending[i].first);
+            pending.erase(pending.begin(), pending.begin() + mined);
+            const auto expired{std::partition(pending.begin(), pending.end(), [&](const auto& tx) {
+                return height - tx.second < EXPIRY_BLOCKS;
+            })};
+            for (auto it = expired; it != pending.end(); ++it) block.evictions.push_back(it->first);
+            pending.erase(expired, pending.end());
+        }
+    }
+};
+
+void Replay(const ReplayTrace& trace, CBlockPolicyEstimator& estimator)
+{
+    unsigned int height{0};
+    for (const ReplayBlock& block : trace.blocks) {
+        ++height;
+        for (const CTxMemPoolEntry* entry : block.arrivals) estimator.processTransaction(*entry, /*validFeeEstimate=*/true);
+        for (const CTxMemPoolEntry* entry : block.evictions) estimator.removeTx(entry->GetTx().GetHash(), /*inBlock=*/false);
+        std::vector<const CTxMemPoolEntry*> confirmed{block.confirmed};
+        estimator.processBlock(height + 1, confirmed);
+        FeeCalculation fee_calc;
+        ankerl::nanobench::doNotOptimizeAway(estimator.estimateSmartFee(2, &fee_calc, /*conservative=*/false));
+        ankerl::nanobench::doNotOptimizeAway(estimator.estimateSmartFee(12, &fee_calc, /*conservative=*/true));
+    }
+}
+
+} // namespace
+
+/**
+ * Feed a recorded mempool and block history through a fresh estimator for 5 minute blocks,
+ * querying it after every block.
+ */
+static void PolicyEstimatorReplay(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<>()};
+    const fs::path no_file{testing_setup->m_path_root / "no_fee_estimates.dat"};
+    const ReplayTrace trace;
+
+    bench.batch(REPLAY_BLOCKS).unit("block").run([&] {
+        CBlockPolicyEstimator estimator{no_file, /*read_stale_estimates=*/false, std::chrono::minutes{5}};
+        Replay(trace, estimator);
+    });
+}
+
+/** Queueing mempool additions and removals, as done while holding the mempool lock. */
+static void PolicyEstimatorQueueEvents(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<>()};
+    const fs::path no_file{testing_setup->m_path_root / "no_fee_estimates.dat"};
+    const ReplayTrace trace;
+    CBlockPolicyEstimator estimator{no_file, /*read_stale_estimates=*/false, std::chrono::minutes{5}};
+    estimator.StartBackgroundProcessing();
+
+    size_t next{0};
+    bench.unit("tx").run([&] {
+        const CTxMemPoolEntry& entry{*trace.entries[next++ % trace.entries.size()]};
+        estimator.processTransaction(entry, /*validFeeEstimate=*/true);
+        estimator.removeTx(entry.GetTx().GetHash(), /*inBlock=*/false);
+    });
+    estimator.StopBackgroundProcessing();
+}
+
+BENCHMARK(PolicyEstimatorReplay, benchmark::PriorityLevel::HIGH);
+BENCHMARK(PolicyEstimatorQueueEvents, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,110 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <key.h>
+#include <policy/policy.h>
+#include <pubkey.h>
+#include <random.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+//! Number of calls to operator new() made by this thread.
+thread_local uint64_t g_heap_allocations{0};
+} // namespace
+
+// Count the heap allocations of the benchmarks below. This replaces operator new() for the whole
+// benchmark binary, at the cost of an increment per allocation.
+void* operator new(std::size_t size)
+{
+    ++g_heap_allocations;
+    if (void* p{std::malloc(size ? size : 1)}) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+/** A checker accepting every signature, leaving the cost of signature verification out. */
+class AcceptingSignatureChecker : public BaseSignatureChecker
+{
+public:
+    bool CheckECDSASignature(const std::vector<unsigned char>&, const std::vector<unsigned char>&, const CScript&, SigVersion) const override { return true; }
+    bool CheckSchnorrSignature(Span<const unsigned char>, Span<const unsigned char>, SigVersion, ScriptExecutionData&, ScriptError*) const override { return true; }
+};
+
+/**
+ * Verify the spend of a P2WSH output, showing the heap allocations it takes next to the name of
+ * the benchmark.
+ */
+void VerifyWitnessScriptSpend(benchmark::Bench& bench, const CScript& witness_script, std::vector<std::vector<unsigned char>> witness_stack)
+{
+    const CScript script_pubkey{GetScriptForDestination(WitnessV0ScriptHash{witness_script})};
+    CScriptWitness witness;
+    witness.stack = std::move(witness_stack);
+    witness.stack.emplace_back(witness_script.begin(), witness_script.end());
+    const AcceptingSignatureChecker checker;
+    const auto verify = [&] {
+        ScriptError error;
+        const bool valid{VerifyScript(CScript{}, script_pubkey, &witness, STANDARD_SCRIPT_VERIFY_FLAGS, checker, &error)};
+        assert(valid && error == SCRIPT_ERR_OK);
+    };
+
+    verify();
+    const uint64_t allocations_before{g_heap_allocations};
+    verify();
+    bench.name(strprintf("%s (%u heap allocations)", bench.name(), g_heap_allocations - allocations_before));
+    bench.unit("input").run(verify);
+}
+
+} // namespace
+
+/** A witness script of about 200 stack, hashing and arithmetic operations. */
+static void VerifyStackOpsScript(benchmark::Bench& bench)
+{
+    constexpr int ROUNDS{19};
+    CScript script;
+    for (int i = 0; i < ROUNDS; ++i) {
+        // (data counter -- sha256(data) counter+1), with a few copies and drops of both.
+        script << OP_SWAP << OP_SHA256 << OP_SWAP << OP_1ADD << OP_2DUP << OP_2DROP << OP_OVER << OP_SIZE << OP_NIP << OP_DROP;
+    }
+    script << CScriptNum{1 + ROUNDS} << OP_EQUALVERIFY << OP_DROP << OP_1;
+    VerifyWitnessScriptSpend(bench, script, {std::vector<unsigned char>(32), {1}});
+}
+
+/** A 2-of-3 multisig witness script. */
+static void VerifyMultisigScript(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    CScript script{CScript() << OP_2};
+    std::vector<std::vector<unsigned char>> witness_stack{{}};
+    for (int i = 0; i < 3; ++i) {
+        CKey key;
+        key.MakeNewKey(/*fCompressed=*/true);
+        script << ToByteVector(key.GetPubKey());
+        if (i < 2) {
+            std::vector<unsigned char>& sig{witness_stack.emplace_back()};
+            const bool signed_hash{key.Sign(GetRandHash(), sig)};
+            assert(signed_hash);
+            sig.push_back(SIGHASH_ALL);
+        }
+    }
+    script << OP_3 << OP_CHECKMULTISIG;
+    VerifyWitnessScriptSpend(bench, script, std::move(witness_stack));
+}
+
+BENCHMARK(VerifyStackOpsScript, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyMultisigScript, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,85 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <net.h>
+#include <protocol.h>
+#include <random.h>
+#include <span.h>
+#include <test/util/setup_common.h>
+#include <version.h>
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** Payload size of the messages sent, roughly that of a full block on the legacy network. */
+constexpr size_t PAYLOAD_SIZE{1'000'000};
+
+/** Move bytes between two transports until neither has anything more to send. */
+void Exchange(Transport& a, Transport& b)
+{
+    bool progress{true};
+    while (progress) {
+        progress = false;
+        for (auto [from, to] : {std::pair{&a, &b}, std::pair{&b, &a}}) {
+            const auto& [bytes, more, msg_type] = from->GetBytesToSend(/*have_next_message=*/false);
+            if (bytes.empty()) continue;
+            Span<const uint8_t> remaining{bytes};
+            const bool ok{to->ReceivedBytes(remaining)};
+            assert(ok);
+            from->MarkBytesSent(bytes.size() - remaining.size());
+            progress = progress || remaining.size() != bytes.size();
+        }
+    }
+}
+
+/** Send one shared payload over and over through transport, draining the wire bytes the way
+ *  CConnman::SocketSendData does, with a socket that accepts everything. */
+void SendLoop(benchmark::Bench& bench, Transport& transport)
+{
+    CSerializedNetMsg msg;
+    msg.m_type = NetMsgType::BLOCK;
+    msg.data = FastRandomContext{/*fDeterministic=*/true}.randbytes<uint8_t>(PAYLOAD_SIZE);
+    msg.Share();
+
+    bench.batch(PAYLOAD_SIZE).unit("byte").run([&] {
+        CSerializedNetMsg copy{msg.Copy()};
+        const bool set{transport.SetMessageToSend(copy)};
+        assert(set);
+        while (true) {
+            const auto& [segments, more, msg_type] = transport.GetBytesToSendV(/*have_next_message=*/false);
+            size_t size{0};
+            for (const auto& segment : segments) size += segment.size();
+            if (size == 0) break;
+            transport.MarkBytesSent(size);
+        }
+    });
+}
+
+} // namespace
+
+static void V1TransportSend(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    V1Transport transport{/*node_id=*/0, SER_NETWORK, INIT_PROTO_VERSION};
+    SendLoop(bench, transport);
+}
+
+static void V2TransportSend(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    V2Transport initiator{/*nodeid=*/0, /*initiating=*/true, SER_NETWORK, INIT_PROTO_VERSION};
+    V2Transport responder{/*nodeid=*/1, /*initiating=*/false, SER_NETWORK, INIT_PROTO_VERSION};
+    // Complete the handshake, so that application messages can be sent.
+    Exchange(initiator, responder);
+    SendLoop(bench, initiator);
+}
+
+BENCHMARK(V1TransportSend, benchmark::PriorityLevel::HIGH);
+BENCHMARK(V2TransportSend, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,141 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <arith_uint256.h>
+#include <kernel/mempool_entry.h>
+#include <net.h>
+#include <net_processing.h>
+#include <primitives/transaction.h>
+#include <protocol.h>
+#include <script/script.h>
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/time.h>
+#include <validation.h>
+#include <version.h>
+
+#include <cassert>
+#include <deque>
+#include <vector>
+
+namespace {
+
+//! Peers of a node with the default -maxconnections.
+constexpr int NUM_INBOUND_PEERS{115};
+constexpr int NUM_OUTBOUND_FULL_RELAY_PEERS{8};
+constexpr int NUM_BLOCK_RELAY_PEERS{2};
+//! Sustained relay rate with full 32 MB blocks every five minutes.
+constexpr int TXS_PER_SECOND{300};
+//! Seconds simulated per iteration, an average inbound trickle interval.
+constexpr int SECONDS_PER_ITERATION{5};
+//! Batches of transactions kept in the mempool, older ones are removed as if mined.
+constexpr size_t MEMPOOL_BATCHES{4};
+//! Enough distinct transactions that the peers' known-inventory filters have forgotten the
+//! oldest ones by the time they come around again.
+constexpr int NUM_TXS{100'000};
+
+std::vector<CTransactionRef> MakeTransactions()
+{
+    std::vector<CTransactionRef> txs;
+    txs.reserve(NUM_TXS);
+    for (int i = 0; i < NUM_TXS; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint{ArithToUint256(arith_uint256(i + 1)), 0};
+        tx.vin[0].scriptSig = CScript() << OP_1;
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+        txs.push_back(MakeTransactionRef(std::move(tx)));
+    }
+    return txs;
+}
+
+} // namespace
+
+/**
+ * Transaction announcement to a full set of peers at the target relay rate: each simulated second,
+ * new transactions enter the mempool and are queued for relay, and every peer gets a SendMessages
+ * call, trickling inventory as its timer comes due. Reported per relayed transaction.
+ */
+static void TxRelayInvBroadcast(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    auto& connman{static_cast<ConnmanTestMsg&>(*testing_setup->m_node.connman)};
+    PeerManager& peerman{*testing_setup->m_node.peerman};
+    CTxMemPool& pool{*testing_setup->m_node.mempool};
+    const std::vector<CTransactionRef> txs{MakeTransactions()};
+
+    // Pings go unanswered, don't disconnect peers over it.
+    connman.SetPeerConnectTimeout(std::chrono::hours{24 * 365});
+    SetMockTime(GetTime<std::chrono::seconds>());
+
+    std::vector<CNode*> peers;
+    NodeId id{0};
+    const auto add_peers{[&](int count, ConnectionType conn_type) {
+        for (int i = 0; i < count; ++i, ++id) {
+            in_addr ip;
+            ip.s_addr = htonl(0x0a000000 + id);
+            peers.push_back(new CNode{id,
+                                      /*sock=*/nullptr,
+                                      CAddress{CService{ip, 8333}, NODE_NONE},
+                                      /*nKeyedNetGroupIn=*/0,
+                                      /*nLocalHostNonceIn=*/0,
+                                      CAddress{},
+                                      /*addrNameIn=*/"",
+                                      conn_type,
+                                      /*inbound_onion=*/false});
+            LOCK(NetEventsInterface::g_msgproc_mutex);
+            connman.Handshake(*peers.back(), /*successfully_connected=*/true, ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+                              ServiceFlags(NODE_NETWORK | NODE_WITNESS), PROTOCOL_VERSION, /*relay_txs=*/true);
+            connman.AddTestNode(*peers.back());
+        }
+    }};
+    add_peers(NUM_INBOUND_PEERS, ConnectionType::INBOUND);
+    add_peers(NUM_OUTBOUND_FULL_RELAY_PEERS, ConnectionType::OUTBOUND_FULL_RELAY);
+    add_peers(NUM_BLOCK_RELAY_PEERS, ConnectionType::BLOCK_RELAY);
+
+    size_t next_tx{0};
+    std::deque<std::vector<CTransactionRef>> batches;
+    bench.batch(TXS_PER_SECOND * SECONDS_PER_ITERATION).unit("tx").run([&] {
+        batches.emplace_back();
+        for (int second = 0; second < SECONDS_PER_ITERATION; ++second) {
+            for (int i = 0; i < TXS_PER_SECOND; ++i) {
+                const CTransactionRef& tx{txs[next_tx]};
+                next_tx = (next_tx + 1) % txs.size();
+                {
+                    LOCK2(cs_main, pool.cs);
+                    // Spread feerates, so that the announcement order matters.
+                    const CAmount fee{1000 + int64_t(next_tx % 97) * 100};
+                    pool.addUnchecked(CTxMemPoolEntry(tx, fee, /*time=*/0, /*entry_height=*/1, /*entry_sequence=*/0,
+                                                      /*spends_coinbase=*/false, /*sigops_cost=*/4, LockPoints{}));
+                }
+                peerman.RelayTransaction(tx->GetHash(), tx->GetWitnessHash());
+                batches.back().push_back(tx);
+            }
+            SetMockTime(GetMockTime() + std::chrono::seconds{1});
+            LOCK(NetEventsInterface::g_msgproc_mutex);
+            for (CNode* peer : peers) {
+                peerman.SendMessages(peer);
+                connman.FlushSendBuffer(*peer);
+            }
+        }
+        if (batches.size() > MEMPOOL_BATCHES) {
+            LOCK(pool.cs);
+            for (const auto& tx : batches.front()) pool.removeRecursive(*tx, MemPoolRemovalReason::BLOCK);
+            batches.pop_front();
+        }
+    });
+
+    for (CNode* peer : peers) {
+        assert(!peer->fDisconnect);
+        peerman.FinalizeNode(*peer);
+    }
+    connman.ClearTestNodes();
+    SetMockTime(0);
+}
+
+BENCHMARK(TxRelayInvBroadcast, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <txrequest.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+//! As many peers as a node with the default -maxconnections announces transactions from.
+static constexpr NodeId ANNOUNCING_PEERS{125};
+//! Transactions announced by every peer, for 100k outstanding announcements.
+static constexpr size_t ANNOUNCED_TXS{800};
+
+/**
+ * Every peer announces the same transactions, each is requested from one of them, and all are
+ * forgotten once received, with 100k announcements outstanding at the peak.
+ */
+static void TxRequestTrackerAnnounce(benchmark::Bench& bench)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<GenTxid> gtxids;
+    for (size_t i = 0; i < ANNOUNCED_TXS; ++i) gtxids.push_back(GenTxid::Wtxid(rng.rand256()));
+    TxRequestTracker tracker{/*deterministic=*/true};
+    std::chrono::microseconds now{1s};
+
+    bench.batch(ANNOUNCING_PEERS * ANNOUNCED_TXS).unit("announcement").run([&] {
+        for (NodeId peer = 0; peer < ANNOUNCING_PEERS; ++peer) {
+            for (const GenTxid& gtxid : gtxids) tracker.ReceivedInv(peer, gtxid, /*preferred=*/peer < 8, now);
+        }
+        assert(tracker.Size() == ANNOUNCING_PEERS * ANNOUNCED_TXS);
+        now += 1s;
+        size_t requested{0};
+        for (NodeId peer = 0; peer < ANNOUNCING_PEERS; ++peer) {
+            for (const GenTxid& gtxid : tracker.GetRequestable(peer, now)) {
+                tracker.RequestedTx(peer, gtxid.GetHash(), now + 60s);
+                ++requested;
+            }
+        }
+        assert(requested == ANNOUNCED_TXS);
+        for (const GenTxid& gtxid : gtxids) tracker.ForgetTxHash(gtxid.GetHash());
+        assert(tracker.Size() == 0);
+    });
+}
+
+/** Peers disconnecting while 100k announcements are outstanding. */
+static void TxRequestTrackerDisconnect(benchmark::Bench& bench)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<GenTxid> gtxids;
+    for (size_t i = 0; i < ANNOUNCED_TXS; ++i) gtxids.push_back(GenTxid::Wtxid(rng.rand256()));
+    TxRequestTracker tracker{/*deterministic=*/true};
+    const std::chrono::microseconds now{1s};
+
+    bench.batch(ANNOUNCING_PEERS * ANNOUNCED_TXS).unit("announcement").run([&] {
+        for (NodeId peer = 0; peer < ANNOUNCING_PEERS; ++peer) {
+            for (const GenTxid& gtxid : gtxids) tracker.ReceivedInv(peer, gtxid, /*preferred=*/peer < 8, now);
+        }
+        for (NodeId peer = 0; peer < ANNOUNCING_PEERS; ++peer) tracker.DisconnectedPeer(peer);
+        assert(tracker.Size() == 0);
+    });
+}
+
+BENCHMARK(TxRequestTrackerAnnounce, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxRequestTrackerDisconnect, benchmark::PriorityLevel::HIGH);
@@ -2,17 +2,29 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <bench/bench.h>
+#include <checkqueue.h>
+#include <common/system.h>
 #include <key.h>
+#include <policy/policy.h>
+#include <pubkey.h>
+#include <random.h>
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/bitcoinconsensus.h>
 #endif
 #include <script/script.h>
 #include <script/interpreter.h>
+#include <script/sigcache.h>
 #include <streams.h>
+#include <test/util/setup_common.h>
 #include <test/util/transaction_utils.h>
+#include <validation.h>
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <vector>
 
 // Microbenchmark for verification of a basic P2WPKH script. Can be easily
 // modified to measure performance of other types of scripts.
@@ -95,5 +107,196 @@ static void VerifyNestedIfScript(benchmark::Bench& bench)
     });
 }
 
+namespace {
+
+//! Post-fork maximum serialized block size.
+constexpr size_t TAPROOT_BLOCK_SIZE{32'000'000};
+constexpr size_t TAPROOT_INPUTS_PER_TX{4};
+constexpr size_t TAPROOT_KEYS{64};
+
+/** A block filled with transactions spending taproot outputs through the key path. */
+struct TaprootBlock {
+    std::vector<CTransactionRef> txs;
+    std::vector<PrecomputedTransactionData> txdata;
+    size_t inputs{0};
+
+    TaprootBlock()
+    {
+        FastRandomContext rng{/*fDeterministic=*/true};
+        std::vector<CKey> keys(TAPROOT_KEYS);
+        std::vector<CTxOut> outputs;
+        for (CKey& key : keys) {
+            key.MakeNewKey(/*fCompressed=*/true);
+            const WitnessV1Taproot dest{XOnlyPubKey{key.GetPubKey()}};
+            outputs.emplace_back(COIN, GetScriptForDestination(dest));
+        }
+
+        std::vector<CMutableTransaction> mtxs;
+        std::vector<std::vector<CTxOut>> spent_outputs;
+        for (size_t size = 0; size < TAPROOT_BLOCK_SIZE; size += GetSerializeSize(mtxs.back(), PROTOCOL_VERSION)) {
+            CMutableTransaction& mtx{mtxs.emplace_back()};
+            std::vector<CTxOut>& spent{spent_outputs.emplace_back()};
+            for (size_t i = 0; i < TAPROOT_INPUTS_PER_TX; ++i) {
+                mtx.vin.emplace_back(COutPoint{rng.rand256(), 0});
+                mtx.vin.back().scriptWitness.stack.emplace_back(64);
+                spent.push_back(outputs[rng.randrange(TAPROOT_KEYS)]);
+            }
+            mtx.vout.assign(2, outputs[0]);
+        }
+
+        txdata.resize(mtxs.size());
+        for (size_t t = 0; t < mtxs.size(); ++t) {
+            CMutableTransaction& mtx{mtxs[t]};
+            PrecomputedTransactionData unsigned_txdata;
+            unsigned_txdata.Init(mtx, std::vector<CTxOut>{spent_outputs[t]});
+            for (size_t i = 0; i < mtx.vin.size(); ++i) {
+                ScriptExecutionData execdata;
+                execdata.m_annex_init = true;
+                execdata.m_annex_present = false;
+                uint256 sighash;
+                const bool hashed{SignatureHashSchnorr(sighash, execdata, mtx, i, SIGHASH_DEFAULT, SigVersion::TAPROOT, unsigned_txdata, MissingDataBehavior::FAIL)};
+                assert(hashed);
+                const size_t key{size_t(std::find(outputs.begin(), outputs.end(), spent_outputs[t][i]) - outputs.begin())};
+                const bool signed_input{keys[key].SignSchnorr(sighash, mtx.vin[i].scriptWitness.stack[0], /*merkle_root=*/nullptr, rng.rand256())};
+                assert(signed_input);
+            }
+            txs.push_back(MakeTransactionRef(std::move(mtx)));
+            txdata[t].Init(*txs.back(), std::move(spent_outputs[t]));
+            inputs += txs.back()->vin.size();
+        }
+    }
+};
+
+/** Check the scripts of a 32 MB block of taproot spends on a script check queue, as ConnectBlock does. */
+void VerifyTaprootBlock(benchmark::Bench& bench, bool batch_schnorr)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    TaprootBlock block;
+    const unsigned int flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_TAPROOT};
+
+    CCheckQueue<CScriptCheck, SchnorrBatch> queue{128};
+    queue.StartWorkerThreads(GetNumCores() - 1);
+    bench.epochs(1).epochIterations(1).batch(block.inputs).unit("input").run([&] {
+        CCheckQueueControl<CScriptCheck, SchnorrBatch> control(&queue);
+        for (size_t t = 0; t < block.txs.size(); ++t) {
+            const CTransaction& tx{*block.txs[t]};
+            std::vector<CScriptCheck> checks;
+            for (unsigned int i = 0; i < tx.vin.size(); ++i) {
+                checks.emplace_back(block.txdata[t].m_spent_outputs[i], tx, i, flags, /*cacheIn=*/false, &block.txdata[t], batch_schnorr);
+            }
+            control.Add(std::move(checks));
+        }
+        const bool valid{control.Wait()};
+        assert(valid);
+    });
+    queue.StopWorkerThreads();
+}
+
+enum class StandardSpend { P2PKH, P2WPKH, P2TR };
+
+/** A transaction spending an output of a standard template, signed by its owner. */
+struct SignedSpend {
+    CTxOut spent;
+    CTransactionRef tx;
+    PrecomputedTransactionData txdata;
+
+    explicit SignedSpend(StandardSpend type)
+    {
+        CKey key;
+        key.MakeNewKey(/*fCompressed=*/true);
+        const CPubKey pubkey{key.GetPubKey()};
+        switch (type) {
+        case StandardSpend::P2PKH: spent = CTxOut{COIN, GetScriptForDestination(PKHash{pubkey})}; break;
+        case StandardSpend::P2WPKH: spent = CTxOut{COIN, GetScriptForDestination(WitnessV0KeyHash{pubkey})}; break;
+        case StandardSpend::P2TR: spent = CTxOut{COIN, GetScriptForDestination(WitnessV1Taproot{XOnlyPubKey{pubkey}})}; break;
+        }
+
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(COutPoint{GetRandHash(), 0});
+        mtx.vout.emplace_back(COIN / 2, spent.scriptPubKey);
+        std::vector<unsigned char> sig;
+        if (type == StandardSpend::P2TR) {
+            // The sighash precomputation is only done for inputs with a witness.
+            mtx.vin[0].scriptWitness.stack.emplace_back(64);
+            PrecomputedTransactionData unsigned_txdata;
+            unsigned_txdata.Init(mtx, {spent});
+            ScriptExecutionData execdata;
+            execdata.m_annex_init = true;
+            execdata.m_annex_present = false;
+            uint256 sighash;
+            const bool hashed{SignatureHashSchnorr(sighash, execdata, mtx, 0, SIGHASH_DEFAULT, SigVersion::TAPROOT, unsigned_txdata, MissingDataBehavior::FAIL)};
+            assert(hashed);
+            sig.resize(64);
+            const bool signed_input{key.SignSchnorr(sighash, sig, /*merkle_root=*/nullptr, GetRandHash())};
+            assert(signed_input);
+            mtx.vin[0].scriptWitness.stack[0] = sig;
+        } else {
+            const bool witness{type == StandardSpend::P2WPKH};
+            const CScript script_code{GetScriptForDestination(PKHash{pubkey})};
+            const uint256 sighash{SignatureHash(script_code, mtx, 0, SIGHASH_ALL, spent.nValue, witness ? SigVersion::WITNESS_V0 : SigVersion::BASE)};
+            const bool signed_input{key.Sign(sighash, sig)};
+            assert(signed_input);
+            sig.push_back(SIGHASH_ALL);
+            if (witness) {
+                mtx.vin[0].scriptWitness.stack = {sig, ToByteVector(pubkey)};
+            } else {
+                mtx.vin[0].scriptSig << sig << ToByteVector(pubkey);
+            }
+        }
+        tx = MakeTransactionRef(std::move(mtx));
+        txdata.Init(*tx, {spent});
+    }
+};
+
+using VerifyFunction = bool (*)(const CScript&, const CScript&, const CScriptWitness*, unsigned int, const BaseSignatureChecker&, ScriptError*);
+
+/**
+ * Verify a spend of a standard template with either VerifyScript() or the interpreter alone. Its
+ * signature is in the signature cache, as for most transactions a block confirms, so that the
+ * work around the signature check is measured rather than the check itself.
+ */
+void VerifyStandardSpend(benchmark::Bench& bench, StandardSpend type, VerifyFunction verify)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    SignedSpend spend{type};
+    const unsigned int flags{STANDARD_SCRIPT_VERIFY_FLAGS};
+    const CTxIn& txin{spend.tx->vin[0]};
+    const auto check = [&](bool store) {
+        ScriptError error;
+        const bool valid{verify(txin.scriptSig, spend.spent.scriptPubKey, &txin.scriptWitness, flags,
+                                CachingTransactionSignatureChecker{spend.tx.get(), 0, spend.spent.nValue, store, spend.txdata}, &error)};
+        assert(valid && error == SCRIPT_ERR_OK);
+    };
+    check(/*store=*/true);
+    bench.unit("input").run([&] { check(/*store=*/false); });
+}
+
+} // namespace
+
+static void VerifyP2PKHSpend(benchmark::Bench& bench) { VerifyStandardSpend(bench, StandardSpend::P2PKH, VerifyScript); }
+static void VerifyP2PKHSpendInterpreted(benchmark::Bench& bench) { VerifyStandardSpend(bench, StandardSpend::P2PKH, VerifyScriptWithInterpreter); }
+static void VerifyP2WPKHSpend(benchmark::Bench& bench) { VerifyStandardSpend(bench, StandardSpend::P2WPKH, VerifyScript); }
+static void VerifyP2WPKHSpendInterpreted(benchmark::Bench& bench) { VerifyStandardSpend(bench, StandardSpend::P2WPKH, VerifyScriptWithInterpreter); }
+static void VerifyP2TRKeyPathSpend(benchmark::Bench& bench) { VerifyStandardSpend(bench, StandardSpend::P2TR, VerifyScript); }
+static void VerifyP2TRKeyPathSpendInterpreted(benchmark::Bench& bench) { VerifyStandardSpend(bench, StandardSpend::P2TR, VerifyScriptWithInterpreter); }
+
+static void VerifyTaprootBlockIndividually(benchmark::Bench& bench)
+{
+    VerifyTaprootBlock(bench, /*batch_schnorr=*/false);
+}
+
+static void VerifyTaprootBlockBatched(benchmark::Bench& bench)
+{
+    VerifyTaprootBlock(bench, /*batch_schnorr=*/true);
+}
+
 BENCHMARK(VerifyScriptBench, benchmark::PriorityLevel::HIGH);
 BENCHMARK(VerifyNestedIfScript, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2PKHSpend, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2PKHSpendInterpreted, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2WPKHSpend, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2WPKHSpendInterpreted, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2TRKeyPathSpend, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyP2TRKeyPathSpendInterpreted, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyTaprootBlockIndividually, benchmark::PriorityLevel::LOW);
+BENCHMARK(VerifyTaprootBlockBatched, benchmark::PriorityLevel::LOW);
@@ -66,7 +66,9 @@ public:
 
     /** Encrypt a packet. Only after Initialize().
      *
-     * It must hold that output.size() == contents.size() + EXPANSION.
+     * It must hold that output.size() == contents.size() + EXPANSION. Encryption may happen in
+     * place: contents is allowed to be output.subspan(LENGTH_LEN + HEADER_LEN, contents.size()),
+     * but must not otherwise overlap with output.
      */
     void Encrypt(Span<const std::byte> contents, Span<const std::byte> aad, bool ignore, Span<std::byte> output) noexcept;
 
@@ -11,9 +11,16 @@
 
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 
-template <typename T>
+/** Batch type of a CCheckQueue whose verifications defer no work. */
+struct NoCheckBatch {
+    bool empty() const { return true; }
+    bool Verify() { return true; }
+};
+
+template <typename T, typename B = NoCheckBatch>
 class CCheckQueueControl;
 
 /**
@@ -25,8 +32,15 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * If T provides an operator() taking a B&, every worker passes its own B
+  * to it, in which verifications can defer part of their work to do it at
+  * once, such as checking signatures in a batch. A worker verifies its B
+  * (through B::Verify()) once the master waits for the results and the
+  * queue is empty, and the result counts as that of the verifications
+  * that added to it.
   */
-template <typename T>
+template <typename T, typename B = NoCheckBatch>
 class CCheckQueue
 {
 private:
@@ -59,6 +73,9 @@ private:
      */
     unsigned int nTodo GUARDED_BY(m_mutex){0};
 
+    //! Whether the master is done adding work, so that no more verifications can be added to the workers' batches.
+    bool m_master_waiting GUARDED_BY(m_mutex){false};
+
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
 
@@ -71,26 +88,43 @@ private:
         std::condition_variable& cond = fMaster ? m_master_cv : m_worker_cv;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
+        B batch;
         unsigned int nNow = 0;
+        //! Verifications processed by this worker whose result also depends on its batch.
+        unsigned int nDeferred = 0;
+        bool fFirst = true;
         bool fOk = true;
         do {
             {
                 WAIT_LOCK(m_mutex, lock);
                 // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
+                if (!fFirst) {
                     fAllOk &= fOk;
-                    nTodo -= nNow;
+                    if (batch.empty()) {
+                        nTodo -= nNow + nDeferred;
+                        nDeferred = 0;
+                    } else {
+                        nDeferred += nNow;
+                    }
                     if (nTodo == 0 && !fMaster)
                         // We processed the last element; inform the master it can exit and return the result
                         m_master_cv.notify_one();
                 } else {
-                    // first iteration
+                    fFirst = false;
                     nTotal++;
+                    if (fMaster) {
+                        m_master_waiting = true;
+                        // Workers holding deferred work can verify it now.
+                        m_worker_cv.notify_all();
+                    }
                 }
+                nNow = 0;
                 // logically, the do loop starts here
                 while (queue.empty() && !m_request_stop) {
+                    if (!batch.empty() && m_master_waiting) break;
                     if (fMaster && nTodo == 0) {
                         nTotal--;
+                        m_master_waiting = false;
                         bool fRet = fAllOk;
                         // reset the status for new work later
                         fAllOk = true;
@@ -105,22 +139,33 @@ private:
                     return false;
                 }
 
-                // Decide how many work units to process now.
+                // Decide how many work units to process now, if any: none when verifying the batch.
                 // * Do not try to do everything at once, but aim for increasingly smaller batches so
                 //   all workers finish approximately simultaneously.
                 // * Try to account for idle jobs which will instantly start helping.
                 // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                auto start_it = queue.end() - nNow;
-                vChecks.assign(std::make_move_iterator(start_it), std::make_move_iterator(queue.end()));
-                queue.erase(start_it, queue.end());
+                if (!queue.empty()) {
+                    nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
+                    auto start_it = queue.end() - nNow;
+                    vChecks.assign(std::make_move_iterator(start_it), std::make_move_iterator(queue.end()));
+                    queue.erase(start_it, queue.end());
+                }
                 // Check whether we need to do work at all
                 fOk = fAllOk;
             }
-            // execute work
-            for (T& check : vChecks)
-                if (fOk)
-                    fOk = check();
+            // execute work, or verify the batch if no more work can be added to it
+            if (vChecks.empty()) {
+                fOk = batch.Verify() && fOk;
+            }
+            for (T& check : vChecks) {
+                if (fOk) {
+                    if constexpr (std::is_invocable_r_v<bool, T&, B&>) {
+                        fOk = check(batch);
+                    } else {
+                        fOk = check();
+                    }
+                }
+            }
             vChecks.clear();
         } while (true);
     }
@@ -203,18 +248,18 @@ public:
  * RAII-style controller object for a CCheckQueue that guarantees the passed
  * queue is finished before continuing.
  */
-template <typename T>
+template <typename T, typename B>
 class CCheckQueueControl
 {
 private:
-    CCheckQueue<T> * const pqueue;
+    CCheckQueue<T, B> * const pqueue;
     bool fDone;
 
 public:
     CCheckQueueControl() = delete;
     CCheckQueueControl(const CCheckQueueControl&) = delete;
     CCheckQueueControl& operator=(const CCheckQueueControl&) = delete;
-    explicit CCheckQueueControl(CCheckQueue<T> * const pqueueIn) : pqueue(pqueueIn), fDone(false)
+    explicit CCheckQueueControl(CCheckQueue<T, B> * const pqueueIn) : pqueue(pqueueIn), fDone(false)
     {
         // passed queue is supposed to be unused, or nullptr
         if (pqueue != nullptr) {
@@ -0,0 +1,90 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cluster_linearize.h>
+
+#include <util/check.h>
+
+#include <numeric>
+
+namespace cluster_linearize {
+
+std::vector<uint32_t> Linearize(const std::vector<ClusterTx>& cluster)
+{
+    const size_t n{cluster.size()};
+    std::vector<uint32_t> linearization(n);
+    std::iota(linearization.begin(), linearization.end(), 0);
+    if (n <= 1 || n > MAX_LINEARIZATION_SEARCH) return linearization;
+    linearization.clear();
+
+    // Ancestor sets (including the transaction itself) as bitsets, and the reverse relation.
+    const size_t words{(n + 63) / 64};
+    std::vector<uint64_t> ancestors(n * words, 0);
+    std::vector<std::vector<uint32_t>> descendants(n);
+    // Fee and size of each transaction's ancestor set, counting only transactions not yet linearized.
+    std::vector<CAmount> anc_fee(n, 0);
+    std::vector<int64_t> anc_size(n, 0);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t* anc{&ancestors[i * words]};
+        anc[i / 64] |= uint64_t{1} << (i % 64);
+        for (const uint32_t parent : cluster[i].parents) {
+            Assume(parent < i);
+            for (size_t w = 0; w < words; ++w) anc[w] |= ancestors[parent * words + w];
+        }
+        for (uint32_t j = 0; j <= i; ++j) {
+            if (!((anc[j / 64] >> (j % 64)) & 1)) continue;
+            descendants[j].push_back(i);
+            anc_fee[i] += cluster[j].fee;
+            anc_size[i] += cluster[j].size;
+        }
+    }
+
+    std::vector<bool> done(n, false);
+    while (linearization.size() < n) {
+        // The remaining transaction with the best ancestor set; smaller sets win ties.
+        uint32_t best{0};
+        bool found{false};
+        for (uint32_t i = 0; i < n; ++i) {
+            if (done[i]) continue;
+            if (!found || FeerateHigher(anc_fee[i], anc_size[i], anc_fee[best], anc_size[best]) ||
+                (!FeerateHigher(anc_fee[best], anc_size[best], anc_fee[i], anc_size[i]) && anc_size[i] < anc_size[best])) {
+                best = i;
+                found = true;
+            }
+        }
+        // Append its remaining ancestors in position order, which is topological.
+        const uint64_t* anc{&ancestors[best * words]};
+        for (uint32_t j = 0; j <= best; ++j) {
+            if (done[j] || !((anc[j / 64] >> (j % 64)) & 1)) continue;
+            done[j] = true;
+            linearization.push_back(j);
+            for (const uint32_t desc : descendants[j]) {
+                anc_fee[desc] -= cluster[j].fee;
+                anc_size[desc] -= cluster[j].size;
+            }
+        }
+    }
+    return linearization;
+}
+
+std::vector<Chunk> ChunkLinearization(const std::vector<ClusterTx>& cluster, const std::vector<uint32_t>& linearization)
+{
+    std::vector<Chunk> chunks;
+    for (uint32_t pos = 0; pos < linearization.size(); ++pos) {
+        const ClusterTx& tx{cluster[linearization[pos]]};
+        chunks.push_back({tx.fee, tx.size, pos, pos + 1});
+        // Merge into the previous chunk for as long as that would raise its feerate.
+        while (chunks.size() > 1 && FeerateHigher(chunks.back().fee, chunks.back().size,
+                                                  chunks[chunks.size() - 2].fee, chunks[chunks.size() - 2].size)) {
+            const Chunk last{chunks.back()};
+            chunks.pop_back();
+            chunks.back().fee += last.fee;
+            chunks.back().size += last.size;
+            chunks.back().end = last.end;
+        }
+    }
+    return chunks;
+}
+
+} // namespace cluster_linearize
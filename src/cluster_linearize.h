@@ -0,0 +1,64 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CLUSTER_LINEARIZE_H
+#define BITCOIN_CLUSTER_LINEARIZE_H
+
+#include <consensus/amount.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Ordering of clusters of connected mempool transactions for inclusion in blocks.
+ *
+ * A linearization is a topologically valid order of a cluster's transactions. Cutting it into
+ * chunks, runs of consecutive transactions whose combined feerate is no lower than that of the
+ * chunk after them, gives each transaction the feerate it is effectively mined at: its chunk
+ * feerate. Mining, eviction and replacement all compare chunk feerates.
+ */
+namespace cluster_linearize {
+
+/** A transaction of a cluster, as needed to linearize it. */
+struct ClusterTx {
+    CAmount fee{0};
+    int64_t size{0};
+    /** Positions of the transaction's in-cluster parents, all lower than its own. */
+    std::vector<uint32_t> parents;
+};
+
+/** A run of consecutive transactions of a linearization, included together. */
+struct Chunk {
+    CAmount fee{0};
+    int64_t size{0};
+    /** Positions in the linearization covered by this chunk: [begin, end). */
+    uint32_t begin{0};
+    uint32_t end{0};
+};
+
+/** Clusters larger than this keep the topological order they are given in, rather than being
+ *  searched for their best ancestor sets, which is quadratic in the cluster size. */
+static constexpr size_t MAX_LINEARIZATION_SEARCH{1000};
+
+/** Whether fee_a/size_a is a higher feerate than fee_b/size_b. */
+inline bool FeerateHigher(CAmount fee_a, int64_t size_a, CAmount fee_b, int64_t size_b)
+{
+    return (double)fee_a * size_b > (double)fee_b * size_a;
+}
+
+/**
+ * Linearize a cluster given in topological order: repeatedly append the remaining transaction
+ * whose remaining ancestor set has the highest feerate, together with that ancestor set.
+ *
+ * @returns positions into cluster, in linearization order.
+ */
+std::vector<uint32_t> Linearize(const std::vector<ClusterTx>& cluster);
+
+/** Cut a linearization into chunks of non-increasing feerate. */
+std::vector<Chunk> ChunkLinearization(const std::vector<ClusterTx>& cluster, const std::vector<uint32_t>& linearization);
+
+} // namespace cluster_linearize
+
+#endif // BITCOIN_CLUSTER_LINEARIZE_H
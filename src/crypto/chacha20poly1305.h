@@ -45,7 +45,9 @@ public:
 
     /** Encrypt a message (given split into plain1 + plain2) with a specified 96-bit nonce and aad.
      *
-     * Requires cipher.size() = plain1.size() + plain2.size() + EXPANSION.
+     * Requires cipher.size() = plain1.size() + plain2.size() + EXPANSION. Each of plain1 and
+     * plain2 may coincide exactly with the part of cipher it is encrypted into (in-place
+     * encryption), but must not partially overlap it.
      */
     void Encrypt(Span<const std::byte> plain1, Span<const std::byte> plain2, Span<const std::byte> aad, Nonce96 nonce, Span<std::byte> cipher) noexcept;
 
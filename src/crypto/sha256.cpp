@@ -39,11 +39,21 @@ namespace sha256d64_avx2
 void Transform_8way(unsigned char* out, const unsigned char* in);
 }
 
+namespace sha256d80_avx2
+{
+void Transform_8way(unsigned char* out, const unsigned char* in);
+}
+
 namespace sha256d64_x86_shani
 {
 void Transform_2way(unsigned char* out, const unsigned char* in);
 }
 
+namespace sha256d80_x86_shani
+{
+void Transform_2way(unsigned char* out, const unsigned char* in);
+}
+
 namespace sha256_x86_shani
 {
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
@@ -476,11 +486,54 @@ void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
     WriteBE32(out + 28, s[7]);
 }
 
+template<TransformType tr>
+void TransformD80Wrapper(unsigned char* out, const unsigned char* in)
+{
+    uint32_t s[8];
+    unsigned char buffer1[64] = {
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0x80
+    };
+    unsigned char buffer2[64] = {
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0
+    };
+    std::copy(in + 64, in + 80, buffer1);
+    sha256::Initialize(s);
+    tr(s, in, 1);
+    tr(s, buffer1, 1);
+    WriteBE32(buffer2 + 0, s[0]);
+    WriteBE32(buffer2 + 4, s[1]);
+    WriteBE32(buffer2 + 8, s[2]);
+    WriteBE32(buffer2 + 12, s[3]);
+    WriteBE32(buffer2 + 16, s[4]);
+    WriteBE32(buffer2 + 20, s[5]);
+    WriteBE32(buffer2 + 24, s[6]);
+    WriteBE32(buffer2 + 28, s[7]);
+    sha256::Initialize(s);
+    tr(s, buffer2, 1);
+    WriteBE32(out + 0, s[0]);
+    WriteBE32(out + 4, s[1]);
+    WriteBE32(out + 8, s[2]);
+    WriteBE32(out + 12, s[3]);
+    WriteBE32(out + 16, s[4]);
+    WriteBE32(out + 20, s[5]);
+    WriteBE32(out + 24, s[6]);
+    WriteBE32(out + 28, s[7]);
+}
+
 TransformType Transform = sha256::Transform;
 TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformD64Type TransformD80 = TransformD80Wrapper<sha256::Transform>;
+TransformD64Type TransformD80_2way = nullptr;
+TransformD64Type TransformD80_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -564,6 +617,30 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformD80 and its multi-way variants against the generic implementation, on the
+    // 8 consecutive 80-byte messages in data.
+    unsigned char expected_d80[256];
+    for (int i = 0; i < 8; ++i) {
+        TransformD80Wrapper<sha256::Transform>(expected_d80 + 32 * i, data + 1 + 80 * i);
+        unsigned char out[32];
+        TransformD80(out, data + 1 + 80 * i);
+        if (!std::equal(out, out + 32, expected_d80 + 32 * i)) return false;
+    }
+
+    // Test TransformD80_2way, if available.
+    if (TransformD80_2way) {
+        unsigned char out[64];
+        TransformD80_2way(out, data + 1);
+        if (!std::equal(out, out + 64, expected_d80)) return false;
+    }
+
+    // Test TransformD80_8way, if available.
+    if (TransformD80_8way) {
+        unsigned char out[256];
+        TransformD80_8way(out, data + 1);
+        if (!std::equal(out, out + 256, expected_d80)) return false;
+    }
+
     return true;
 }
 
@@ -587,6 +664,9 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     TransformD64_2way = nullptr;
     TransformD64_4way = nullptr;
     TransformD64_8way = nullptr;
+    TransformD80 = TransformD80Wrapper<sha256::Transform>;
+    TransformD80_2way = nullptr;
+    TransformD80_8way = nullptr;
 
 #if defined(USE_ASM) && defined(HAVE_GETCPUID)
     bool have_sse4 = false;
@@ -621,6 +701,8 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
         Transform = sha256_x86_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_x86_shani::Transform>;
         TransformD64_2way = sha256d64_x86_shani::Transform_2way;
+        TransformD80 = TransformD80Wrapper<sha256_x86_shani::Transform>;
+        TransformD80_2way = sha256d80_x86_shani::Transform_2way;
         ret = "x86_shani(1way,2way)";
         have_sse4 = false; // Disable SSE4/AVX2;
         have_avx2 = false;
@@ -631,6 +713,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #if defined(__x86_64__) || defined(__amd64__)
         Transform = sha256_sse4::Transform;
         TransformD64 = TransformD64Wrapper<sha256_sse4::Transform>;
+        TransformD80 = TransformD80Wrapper<sha256_sse4::Transform>;
         ret = "sse4(1way)";
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
@@ -642,6 +725,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformD80_8way = sha256d80_avx2::Transform_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -676,6 +760,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
         Transform = sha256_arm_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_arm_shani::Transform>;
         TransformD64_2way = sha256d64_arm_shani::Transform_2way;
+        TransformD80 = TransformD80Wrapper<sha256_arm_shani::Transform>;
         ret = "arm_shani(1way,2way)";
     }
 #endif
@@ -774,3 +859,29 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+void SHA256D80(unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    if (TransformD80_8way) {
+        while (blocks >= 8) {
+            TransformD80_8way(out, in);
+            out += 256;
+            in += 640;
+            blocks -= 8;
+        }
+    }
+    if (TransformD80_2way) {
+        while (blocks >= 2) {
+            TransformD80_2way(out, in);
+            out += 64;
+            in += 160;
+            blocks -= 2;
+        }
+    }
+    while (blocks) {
+        TransformD80(out, in);
+        out += 32;
+        in += 80;
+        --blocks;
+    }
+}
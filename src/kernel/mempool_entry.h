@@ -14,12 +14,14 @@
 #include <util/epochguard.h>
 #include <util/overflow.h>
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <set>
 #include <stddef.h>
 #include <stdint.h>
+#include <vector>
 
 class CBlockIndex;
 
@@ -50,6 +52,68 @@ struct CompareIteratorByHash {
     }
 };
 
+/**
+ * The in-mempool parents or children of a mempool entry, as a vector of references sorted by
+ * txid. Most transactions only have a few of them, for which a flat vector costs one pointer per
+ * link instead of a tree node, and iterates in the same order as a std::set would.
+ */
+template <typename Ref>
+class MemPoolEntryLinks
+{
+    std::vector<Ref> m_refs;
+
+    typename std::vector<Ref>::iterator LowerBound(const Ref& ref)
+    {
+        return std::lower_bound(m_refs.begin(), m_refs.end(), ref, CompareIteratorByHash{});
+    }
+    typename std::vector<Ref>::const_iterator LowerBound(const Ref& ref) const
+    {
+        return std::lower_bound(m_refs.begin(), m_refs.end(), ref, CompareIteratorByHash{});
+    }
+
+public:
+    using value_type = Ref;
+    using const_iterator = typename std::vector<Ref>::const_iterator;
+    using iterator = const_iterator;
+
+    const_iterator begin() const { return m_refs.begin(); }
+    const_iterator end() const { return m_refs.end(); }
+    size_t size() const { return m_refs.size(); }
+    bool empty() const { return m_refs.empty(); }
+
+    size_t count(const Ref& ref) const
+    {
+        const auto it{LowerBound(ref)};
+        return it != m_refs.end() && !CompareIteratorByHash{}(ref, *it);
+    }
+
+    std::pair<const_iterator, bool> insert(const Ref& ref)
+    {
+        auto it{LowerBound(ref)};
+        if (it != m_refs.end() && !CompareIteratorByHash{}(ref, *it)) return {it, false};
+        if (m_refs.size() == m_refs.capacity()) {
+            // Grow by one at a time for the common small cases, then geometrically.
+            const auto pos{it - m_refs.begin()};
+            m_refs.reserve(m_refs.size() < 4 ? m_refs.size() + 1 : m_refs.size() * 2);
+            it = m_refs.begin() + pos;
+        }
+        return {m_refs.insert(it, ref), true};
+    }
+
+    size_t erase(const Ref& ref)
+    {
+        const auto it{LowerBound(ref)};
+        if (it == m_refs.end() || CompareIteratorByHash{}(ref, *it)) return 0;
+        m_refs.erase(it);
+        // Give the memory back once a transaction loses its last link, e.g. when its children are
+        // mined, rather than holding on to it for as long as it stays in the mempool.
+        if (m_refs.empty()) m_refs.shrink_to_fit();
+        return 1;
+    }
+
+    size_t DynamicMemoryUsage() const { return memusage::DynamicUsage(m_refs); }
+};
+
 /** \class CTxMemPoolEntry
  *
  * CTxMemPoolEntry stores data about the corresponding transaction, as well
@@ -67,8 +131,10 @@ class CTxMemPoolEntry
 public:
     typedef std::reference_wrapper<const CTxMemPoolEntry> CTxMemPoolEntryRef;
     // two aliases, should the types ever diverge
-    typedef std::set<CTxMemPoolEntryRef, CompareIteratorByHash> Parents;
-    typedef std::set<CTxMemPoolEntryRef, CompareIteratorByHash> Children;
+    typedef MemPoolEntryLinks<CTxMemPoolEntryRef> Parents;
+    typedef MemPoolEntryLinks<CTxMemPoolEntryRef> Children;
+    /** Set of entries for graph traversals, which may grow large. */
+    typedef std::set<CTxMemPoolEntryRef, CompareIteratorByHash> EntryRefSet;
 
 private:
     const CTransactionRef tx;
@@ -4,9 +4,12 @@
 
 #include <kernel/mempool_persist.h>
 
+#include <chain.h>
 #include <clientversion.h>
 #include <consensus/amount.h>
+#include <kernel/mempool_entry.h>
 #include <logging.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <streams.h>
@@ -19,6 +22,7 @@
 #include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
@@ -34,7 +38,10 @@ using fsbridge::FopenFn;
 
 namespace kernel {
 
-static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+static const uint64_t MEMPOOL_DUMP_VERSION_NO_TIP{1};
+static const uint64_t MEMPOOL_DUMP_VERSION{2};
+//! Transactions submitted to the mempool at once while loading, in one hold of cs_main.
+static constexpr size_t LOAD_BATCH_SIZE{1000};
 
 bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active_chainstate, ImportMempoolOptions&& opts)
 {
@@ -52,14 +59,55 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
     int64_t failed = 0;
     int64_t already_there = 0;
     int64_t unbroadcast = 0;
+    int64_t scripts_skipped = 0;
     const auto now{NodeClock::now()};
 
     try {
         uint64_t version;
         file >> version;
-        if (version != MEMPOOL_DUMP_VERSION) {
+        if (version != MEMPOOL_DUMP_VERSION_NO_TIP && version != MEMPOOL_DUMP_VERSION) {
             return false;
         }
+        uint256 dump_tip;
+        uint32_t dump_script_flags{0};
+        if (version >= MEMPOOL_DUMP_VERSION) {
+            file >> dump_tip;
+            file >> dump_script_flags;
+        }
+        const bool scripts_trusted{opts.trust_verified_scripts && version >= MEMPOOL_DUMP_VERSION &&
+                                   dump_script_flags == STANDARD_SCRIPT_VERIFY_FLAGS};
+
+        std::vector<CTransactionRef> batch;
+        std::vector<int64_t> batch_times;
+        // Blocks may connect while loading, so whether the tip is still the one of the dump is
+        // checked for every batch. If it is not, the scripts are verified on the script check
+        // threads.
+        const auto submit_batch = [&] {
+            if (batch.empty()) return;
+            LOCK(cs_main);
+            const CBlockIndex* tip{active_chainstate.m_chain.Tip()};
+            const bool scripts_verified{scripts_trusted && tip && tip->GetBlockHash() == dump_tip};
+            const auto results{AcceptBatchToMemoryPool(active_chainstate, batch, batch_times, scripts_verified)};
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (results[i].m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                    ++count;
+                    if (scripts_verified) ++scripts_skipped;
+                } else {
+                    // mempool may contain the transaction already, e.g. from
+                    // wallet(s) having loaded it while we were processing
+                    // mempool transactions; consider these as valid, instead of
+                    // failed, but mark them as 'already there'
+                    if (pool.exists(GenTxid::Txid(batch[i]->GetHash()))) {
+                        ++already_there;
+                    } else {
+                        ++failed;
+                    }
+                }
+            }
+            batch.clear();
+            batch_times.clear();
+        };
+
         uint64_t num;
         file >> num;
         while (num) {
@@ -80,27 +128,21 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
                 pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
             }
             if (nTime > TicksSinceEpoch<std::chrono::seconds>(now - pool.m_expiry)) {
-                LOCK(cs_main);
-                const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
-                if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
-                } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(GenTxid::Txid(tx->GetHash()))) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
-                }
+                batch.push_back(std::move(tx));
+                batch_times.push_back(nTime);
             } else {
                 ++expired;
             }
-            if (active_chainstate.m_chainman.m_interrupt)
-                return false;
+            if (batch.size() >= LOAD_BATCH_SIZE) {
+                submit_batch();
+                if (active_chainstate.m_chainman.m_interrupt)
+                    return false;
+            }
         }
+        submit_batch();
+        if (active_chainstate.m_chainman.m_interrupt)
+            return false;
+
         std::map<uint256, CAmount> mapDeltas;
         file >> mapDeltas;
 
@@ -125,32 +167,55 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
         return false;
     }
 
-    LogPrintf("Imported mempool transactions from disk: %i succeeded, %i failed, %i expired, %i already there, %i waiting for initial broadcast\n", count, failed, expired, already_there, unbroadcast);
+    LogPrintf("Imported mempool transactions from disk: %i succeeded (%i without script checks), %i failed, %i expired, %i already there, %i waiting for initial broadcast\n",
+              count, scripts_skipped, failed, expired, already_there, unbroadcast);
     return true;
 }
 
-bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mockable_fopen_function, bool skip_file_commit)
+bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, const Chainstate& active_chainstate,
+                 FopenFn mockable_fopen_function, bool skip_file_commit)
 {
     auto start = SteadyClock::now();
 
+    /** What is written of a transaction, copied while holding the mempool lock. */
+    struct DumpEntry {
+        uint64_t ancestor_count;
+        CTransactionRef tx;
+        int64_t time;
+        CAmount fee_delta;
+    };
+
     std::map<uint256, CAmount> mapDeltas;
-    std::vector<TxMempoolInfo> vinfo;
+    std::vector<DumpEntry> entries;
     std::set<uint256> unbroadcast_txids;
+    uint256 tip_hash;
 
     static Mutex dump_mutex;
     LOCK(dump_mutex);
 
     {
-        LOCK(pool.cs);
+        // cs_main keeps the tip in step with the mempool contents. Only copy under the locks, in
+        // one pass over the mempool; the transactions are ordered after they are released.
+        LOCK2(::cs_main, pool.cs);
+        if (const CBlockIndex* tip{active_chainstate.m_chain.Tip()}) tip_hash = tip->GetBlockHash();
         for (const auto &i : pool.mapDeltas) {
             mapDeltas[i.first] = i.second;
         }
-        vinfo = pool.infoAll();
+        entries.reserve(pool.mapTx.size());
+        for (const CTxMemPoolEntry& entry : pool.mapTx) {
+            entries.push_back({entry.GetCountWithAncestors(), entry.GetSharedTx(), count_seconds(entry.GetTime()),
+                               entry.GetModifiedFee() - entry.GetFee()});
+        }
         unbroadcast_txids = pool.GetUnbroadcastTxs();
     }
 
     auto mid = SteadyClock::now();
 
+    // A transaction has more ancestors than any of its parents, so this writes parents first.
+    std::sort(entries.begin(), entries.end(), [](const DumpEntry& a, const DumpEntry& b) {
+        return a.ancestor_count < b.ancestor_count;
+    });
+
     try {
         FILE* filestr{mockable_fopen_function(dump_path + ".new", "wb")};
         if (!filestr) {
@@ -161,12 +226,14 @@ bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mock
 
         uint64_t version = MEMPOOL_DUMP_VERSION;
         file << version;
+        file << tip_hash;
+        file << uint32_t{STANDARD_SCRIPT_VERIFY_FLAGS};
 
-        file << (uint64_t)vinfo.size();
-        for (const auto& i : vinfo) {
+        file << (uint64_t)entries.size();
+        for (const auto& i : entries) {
             file << *(i.tx);
-            file << int64_t{count_seconds(i.m_time)};
-            file << int64_t{i.nFeeDelta};
+            file << i.time;
+            file << int64_t{i.fee_delta};
             mapDeltas.erase(i.tx->GetHash());
         }
 
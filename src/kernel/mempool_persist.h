@@ -12,8 +12,12 @@ class CTxMemPool;
 
 namespace kernel {
 
-/** Dump the mempool to a file. */
+/**
+ * Dump the mempool to a file, along with the tip and script verification flags its transactions
+ * were verified against. The mempool is only locked while it is copied, not while it is written.
+ */
 bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path,
+                 const Chainstate& active_chainstate,
                  fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen,
                  bool skip_file_commit = false);
 
@@ -22,6 +26,9 @@ struct ImportMempoolOptions {
     bool use_current_time{false};
     bool apply_fee_delta_priority{true};
     bool apply_unbroadcast_set{true};
+    /** Don't verify the scripts again if the file was dumped at the current tip with the current
+     * script verification flags. Only for the node's own mempool.dat, never for imported files. */
+    bool trust_verified_scripts{false};
 };
 /** Import the file and attempt to add its contents to the mempool. */
 bool LoadMempool(CTxMemPool& pool, const fs::path& load_path,
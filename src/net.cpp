@@ -117,12 +117,34 @@ GlobalMutex g_maplocalhost_mutex;
 std::map<CNetAddr, LocalServiceInfo> mapLocalHost GUARDED_BY(g_maplocalhost_mutex);
 std::string strSubVersion;
 
+SharedNetMsgPayload::SharedNetMsgPayload(std::vector<unsigned char>&& data_in)
+    : data{std::move(data_in)}, hash{Hash(data)} {}
+
+CSerializedNetMsg& CSerializedNetMsg::Share()
+{
+    if (!m_shared_payload) {
+        m_shared_payload = std::make_shared<const SharedNetMsgPayload>(std::move(data));
+        ClearShrink(data);
+    }
+    return *this;
+}
+
+void CSerializedNetMsg::ClearPayload() noexcept
+{
+    ClearShrink(data);
+    m_shared_payload.reset();
+}
+
 size_t CSerializedNetMsg::GetMemoryUsage() const noexcept
 {
     // Don't count the dynamic memory used for the m_type string, by assuming it fits in the
     // "small string" optimization area (which stores data inside the object itself, up to some
     // size; 15 bytes in modern libstdc++).
-    return sizeof(*this) + memusage::DynamicUsage(data);
+    size_t usage = sizeof(*this) + memusage::DynamicUsage(data);
+    if (m_shared_payload) {
+        usage += memusage::DynamicUsage(m_shared_payload) + memusage::DynamicUsage(m_shared_payload->data);
+    }
+    return usage;
 }
 
 void CConnman::AddAddrFetch(const std::string& strDest)
@@ -800,18 +822,25 @@ CNetMessage V1Transport::GetReceivedMessage(const std::chrono::microseconds time
     return msg;
 }
 
+Transport::BytesToSendV Transport::GetBytesToSendV(bool have_next_message) const noexcept
+{
+    const auto& [data, more, msg_type] = GetBytesToSend(have_next_message);
+    return {{data, {}}, more, msg_type};
+}
+
 bool V1Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
     // Determine whether a new message can be set.
     LOCK(m_send_mutex);
-    if (m_sending_header || m_bytes_sent < m_message_to_send.data.size()) return false;
+    if (m_sending_header || m_bytes_sent < m_message_to_send.Payload().size()) return false;
 
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    // create dbl-sha256 checksum (shared payloads carry a precomputed one)
+    const Span<const unsigned char> payload{msg.Payload()};
+    const uint256 hash = msg.m_shared_payload ? msg.m_shared_payload->hash : Hash(payload);
 
     // create header
-    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.data.size());
+    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), payload.size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
@@ -833,11 +862,11 @@ Transport::BytesToSend V1Transport::GetBytesToSend(bool have_next_message) const
         return {Span{m_header_to_send}.subspan(m_bytes_sent),
                 // We have more to send after the header if the message has payload, or if there
                 // is a next message after that.
-                have_next_message || !m_message_to_send.data.empty(),
+                have_next_message || !m_message_to_send.Payload().empty(),
                 m_message_to_send.m_type
                };
     } else {
-        return {Span{m_message_to_send.data}.subspan(m_bytes_sent),
+        return {m_message_to_send.Payload().subspan(m_bytes_sent),
                 // We only have more to send after this message's payload if there is another
                 // message.
                 have_next_message,
@@ -846,18 +875,38 @@ Transport::BytesToSend V1Transport::GetBytesToSend(bool have_next_message) const
     }
 }
 
+Transport::BytesToSendV V1Transport::GetBytesToSendV(bool have_next_message) const noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    LOCK(m_send_mutex);
+    if (m_sending_header) {
+        // Hand out the header and the payload together, so they can go out in one write.
+        return {{Span{m_header_to_send}.subspan(m_bytes_sent), m_message_to_send.Payload()},
+                have_next_message,
+                m_message_to_send.m_type
+               };
+    } else {
+        return {{m_message_to_send.Payload().subspan(m_bytes_sent), {}},
+                have_next_message,
+                m_message_to_send.m_type
+               };
+    }
+}
+
 void V1Transport::MarkBytesSent(size_t bytes_sent) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
     LOCK(m_send_mutex);
     m_bytes_sent += bytes_sent;
-    if (m_sending_header && m_bytes_sent == m_header_to_send.size()) {
-        // We're done sending a message's header. Switch to sending its data bytes.
+    if (m_sending_header && m_bytes_sent >= m_header_to_send.size()) {
+        // We're done sending a message's header. Switch to sending its data bytes, carrying over
+        // any of those already sent along with the header by a scatter-gather write.
         m_sending_header = false;
-        m_bytes_sent = 0;
-    } else if (!m_sending_header && m_bytes_sent == m_message_to_send.data.size()) {
-        // We're done sending a message's data. Wipe the data vector to reduce memory consumption.
-        ClearShrink(m_message_to_send.data);
+        m_bytes_sent -= m_header_to_send.size();
+    }
+    if (!m_sending_header && m_bytes_sent == m_message_to_send.Payload().size()) {
+        // We're done sending a message's data. Wipe the payload to reduce memory consumption.
+        m_message_to_send.ClearPayload();
         m_bytes_sent = 0;
     }
 }
@@ -1457,26 +1506,29 @@ bool V2Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
     // is available) and the send buffer is empty. This limits the number of messages in the send
     // buffer to just one, and leaves the responsibility for queueing them up to the caller.
     if (!(m_send_state == SendState::READY && m_send_buffer.empty())) return false;
-    // Construct contents (encoding message type + payload).
-    std::vector<uint8_t> contents;
+    // Construct contents (encoding message type + payload) directly at its place in the send
+    // buffer, and encrypt it there, so the payload is copied only once.
+    const Span<const unsigned char> payload{msg.Payload()};
     auto short_message_id = V2_MESSAGE_MAP(msg.m_type);
+    const size_t type_len = short_message_id ? 1 : 1 + CMessageHeader::COMMAND_SIZE;
+    const size_t contents_len = type_len + payload.size();
+    const size_t contents_pos = BIP324Cipher::LENGTH_LEN + BIP324Cipher::HEADER_LEN;
+    // Initialize the message type area with zeroes: for long message types, this means
+    // contents[0] and the unused positions in contents[1..13] remain 0x00.
+    m_send_buffer.assign(contents_pos + type_len, 0);
+    m_send_buffer.resize(contents_len + BIP324Cipher::EXPANSION);
+    const auto contents = Span{m_send_buffer}.subspan(contents_pos, contents_len);
     if (short_message_id) {
-        contents.resize(1 + msg.data.size());
         contents[0] = *short_message_id;
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1);
     } else {
-        // Initialize with zeroes, and then write the message type string starting at offset 1.
-        // This means contents[0] and the unused positions in contents[1..13] remain 0x00.
-        contents.resize(1 + CMessageHeader::COMMAND_SIZE + msg.data.size(), 0);
-        std::copy(msg.m_type.begin(), msg.m_type.end(), contents.data() + 1);
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1 + CMessageHeader::COMMAND_SIZE);
-    }
-    // Construct ciphertext in send buffer.
-    m_send_buffer.resize(contents.size() + BIP324Cipher::EXPANSION);
+        std::copy(msg.m_type.begin(), msg.m_type.end(), contents.begin() + 1);
+    }
+    std::copy(payload.begin(), payload.end(), contents.begin() + type_len);
+    // Encrypt in place, turning the send buffer into ciphertext.
     m_cipher.Encrypt(MakeByteSpan(contents), {}, false, MakeWritableByteSpan(m_send_buffer));
     m_send_type = msg.m_type;
     // Release memory
-    ClearShrink(msg.data);
+    msg.ClearPayload();
     return true;
 }
 
@@ -1497,6 +1549,16 @@ Transport::BytesToSend V2Transport::GetBytesToSend(bool have_next_message) const
     };
 }
 
+Transport::BytesToSendV V2Transport::GetBytesToSendV(bool have_next_message) const noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    if (WITH_LOCK(m_send_mutex, return m_send_state == SendState::V1)) {
+        return m_v1_fallback.GetBytesToSendV(have_next_message);
+    }
+    // The ciphertext of a packet is always contiguous.
+    return Transport::GetBytesToSendV(have_next_message);
+}
+
 void V2Transport::MarkBytesSent(size_t bytes_sent) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
@@ -1585,15 +1647,19 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 ++it;
             }
         }
-        const auto& [data, more, msg_type] = node.m_transport->GetBytesToSend(it != node.vSendMsg.end());
-        // We rely on the 'more' value returned by GetBytesToSend to correctly predict whether more
+        // Fetch the pending bytes as (possibly) several buffers, e.g. a v1 header and its
+        // payload, which are then written with a single gathering send.
+        const auto& [data, more, msg_type] = node.m_transport->GetBytesToSendV(it != node.vSendMsg.end());
+        size_t data_size{0};
+        for (const auto& segment : data) data_size += segment.size();
+        // We rely on the 'more' value returned by GetBytesToSendV to correctly predict whether more
         // bytes are still to be sent, to correctly set the MSG_MORE flag. As a sanity check,
         // verify that the previously returned 'more' was correct.
-        if (expected_more.has_value()) Assume(!data.empty() == *expected_more);
+        if (expected_more.has_value()) Assume((data_size > 0) == *expected_more);
         expected_more = more;
-        data_left = !data.empty(); // will be overwritten on next loop if all of data gets sent
+        data_left = data_size > 0; // will be overwritten on next loop if all of data gets sent
         int nBytes = 0;
-        if (!data.empty()) {
+        if (data_size > 0) {
             LOCK(node.m_sock_mutex);
             // There is no socket in case we've already disconnected, or in test cases without
             // real connections. In these cases, we bail out immediately and just leave things
@@ -1607,7 +1673,7 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 flags |= MSG_MORE;
             }
 #endif
-            nBytes = node.m_sock->Send(reinterpret_cast<const char*>(data.data()), data.size(), flags);
+            nBytes = node.m_sock->SendV(data, flags);
         }
         if (nBytes > 0) {
             node.m_last_send = GetTime<std::chrono::seconds>();
@@ -1619,7 +1685,7 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 node.AccountForSentBytes(msg_type, nBytes);
             }
             nSentSize += nBytes;
-            if ((size_t)nBytes != data.size()) {
+            if ((size_t)nBytes != data_size) {
                 // could not send full message; stop sending more
                 break;
             }
@@ -3738,10 +3804,11 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
-    size_t nMessageSize = msg.data.size();
+    const Span<const unsigned char> payload{msg.Payload()};
+    size_t nMessageSize = payload.size();
     LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", msg.m_type, nMessageSize, pnode->GetId());
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pnode->addr, msg.m_type, msg.data, /*is_incoming=*/false);
+        CaptureMessage(pnode->addr, msg.m_type, payload, /*is_incoming=*/false);
     }
 
     TRACE6(net, outbound_message,
@@ -3749,8 +3816,8 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         pnode->m_addr_name.c_str(),
         pnode->ConnectionTypeAsString().c_str(),
         msg.m_type.c_str(),
-        msg.data.size(),
-        msg.data.data()
+        payload.size(),
+        payload.data()
     );
 
     size_t nBytesSent = 0;
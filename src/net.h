@@ -31,6 +31,7 @@
 #include <util/sock.h>
 #include <util/threadinterrupt.h>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -113,6 +114,15 @@ struct AddedNodeInfo {
 class CNodeStats;
 class CClientUIInterface;
 
+/** Immutable message payload that can be referenced by many CSerializedNetMsg objects at once. */
+struct SharedNetMsgPayload {
+    explicit SharedNetMsgPayload(std::vector<unsigned char>&& data_in);
+
+    const std::vector<unsigned char> data;
+    /** Double-SHA256 of data, from which the v1 header checksum is taken. */
+    const uint256 hash;
+};
+
 struct CSerializedNetMsg {
     CSerializedNetMsg() = default;
     CSerializedNetMsg(CSerializedNetMsg&&) = default;
@@ -121,18 +131,39 @@ struct CSerializedNetMsg {
     CSerializedNetMsg(const CSerializedNetMsg& msg) = delete;
     CSerializedNetMsg& operator=(const CSerializedNetMsg&) = delete;
 
+    /** Copy this message. If the payload is shared, only the reference is copied. */
     CSerializedNetMsg Copy() const
     {
         CSerializedNetMsg copy;
         copy.data = data;
         copy.m_type = m_type;
+        copy.m_shared_payload = m_shared_payload;
         return copy;
     }
 
+    /** Move data into a refcounted SharedNetMsgPayload, so that the message can be handed to
+     *  many peers (through Copy()) without duplicating the payload bytes. */
+    CSerializedNetMsg& Share();
+
+    /** The payload bytes, wherever they are stored. */
+    Span<const unsigned char> Payload() const noexcept
+    {
+        if (m_shared_payload) return m_shared_payload->data;
+        return data;
+    }
+
+    /** Drop the payload (owned or shared), releasing its memory. */
+    void ClearPayload() noexcept;
+
     std::vector<unsigned char> data;
     std::string m_type;
+    /** When set, the payload lives here instead of in data (which is then empty). */
+    std::shared_ptr<const SharedNetMsgPayload> m_shared_payload;
 
-    /** Compute total memory usage of this object (own memory + any dynamic memory). */
+    /** Compute total memory usage of this object (own memory + any dynamic memory).
+     *
+     * A shared payload is counted in full, as every queued reference keeps it alive and the
+     * per-peer send buffer limits should not depend on how a message was constructed. */
     size_t GetMemoryUsage() const noexcept;
 };
 
@@ -352,9 +383,31 @@ public:
      */
     virtual BytesToSend GetBytesToSend(bool have_next_message) const noexcept = 0;
 
-    /** Report how many bytes returned by the last GetBytesToSend() have been sent.
+    /** Maximum number of buffers in a BytesToSendV. */
+    static constexpr size_t MAX_SEND_SEGMENTS{2};
+
+    /** Return type for GetBytesToSendV: like BytesToSend, except that the bytes to be sent are
+     *  split over up to MAX_SEND_SEGMENTS spans (unused trailing ones are empty), and "more"
+     *  refers to what follows the last of them. */
+    using BytesToSendV = std::tuple<
+        std::array<Span<const uint8_t>, MAX_SEND_SEGMENTS> /*to_send*/,
+        bool /*more*/,
+        const std::string& /*m_type*/
+    >;
+
+    /** Scatter-gather variant of GetBytesToSend, so that e.g. a message header and its payload
+     *  can be handed to the socket in a single system call without first being concatenated.
+     *
+     * The first span is what GetBytesToSend() would return; the spans that follow are bytes of
+     * the same message that GetBytesToSend() would return after the earlier ones were marked as
+     * sent. The default implementation only returns the first span.
+     */
+    virtual BytesToSendV GetBytesToSendV(bool have_next_message) const noexcept;
+
+    /** Report how many bytes returned by the last GetBytesToSend() or GetBytesToSendV() have been sent.
      *
-     * bytes_sent cannot exceed to_send.size() of the last GetBytesToSend() result.
+     * bytes_sent cannot exceed to_send.size() of the last GetBytesToSend() result, or the total
+     * size of the spans of the last GetBytesToSendV() result.
      *
      * If bytes_sent=0, this call has no effect.
      */
@@ -415,7 +468,7 @@ private:
     CSerializedNetMsg m_message_to_send GUARDED_BY(m_send_mutex);
     /** Whether we're currently sending header bytes or message bytes. */
     bool m_sending_header GUARDED_BY(m_send_mutex) {false};
-    /** How many bytes have been sent so far (from m_header_to_send, or from m_message_to_send.data). */
+    /** How many bytes have been sent so far (from m_header_to_send, or from m_message_to_send's payload). */
     size_t m_bytes_sent GUARDED_BY(m_send_mutex) {0};
 
 public:
@@ -446,6 +499,7 @@ public:
 
     bool SetMessageToSend(CSerializedNetMsg& msg) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     BytesToSend GetBytesToSend(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
+    BytesToSendV GetBytesToSendV(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     void MarkBytesSent(size_t bytes_sent) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     size_t GetSendMemoryUsage() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     bool ShouldReconnectV1() const noexcept override { return false; }
@@ -662,6 +716,7 @@ public:
     // Send side functions.
     bool SetMessageToSend(CSerializedNetMsg& msg) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     BytesToSend GetBytesToSend(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
+    BytesToSendV GetBytesToSendV(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     void MarkBytesSent(size_t bytes_sent) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     size_t GetSendMemoryUsage() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
 
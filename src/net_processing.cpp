@@ -22,6 +22,7 @@
 #include <merkleblock.h>
 #include <netbase.h>
 #include <netmessagemaker.h>
+#include <node/blockservecache.h>
 #include <node/blockstorage.h>
 #include <node/txreconciliation.h>
 #include <policy/fees.h>
@@ -40,6 +41,7 @@
 #include <txorphanage.h>
 #include <txrequest.h>
 #include <util/check.h> // For NDEBUG compile time check
+#include <util/hasher.h>
 #include <util/strencodings.h>
 #include <util/trace.h>
 #include <validation.h>
@@ -51,6 +53,8 @@
 #include <memory>
 #include <optional>
 #include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
 
 
 /** Headers download timeout.
@@ -93,6 +97,9 @@ static constexpr int32_t MAX_PEER_TX_REQUEST_IN_FLIGHT = 100;
  *  rate (by our own policy, see INVENTORY_BROADCAST_PER_SECOND) for several minutes, while not receiving
  *  the actual transaction (from any peer) in response to requests for them. */
 static constexpr int32_t MAX_PEER_TX_ANNOUNCEMENTS = 5000;
+/** Maximum number of a peer's orphan transactions to reconsider at once, after their parents were
+ *  accepted. Their scripts are verified in parallel, and the mempool is trimmed once for all of them. */
+static constexpr size_t MAX_ORPHANS_RECONSIDERED{25};
 /** How long to delay requesting transactions via txids, if we have wtxid-relaying peers */
 static constexpr auto TXID_RELAY_DELAY{2s};
 /** How long to delay requesting transactions from non-preferred peers */
@@ -105,6 +112,19 @@ static constexpr auto GETDATA_TX_INTERVAL{60s};
 static const unsigned int MAX_GETDATA_SZ = 1000;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Maximum estimated size of the blocks requested at any given time from a single peer. */
+static constexpr uint64_t MAX_BLOCK_BYTES_IN_TRANSIT_PER_PEER{64 << 20};
+/** Maximum estimated size of the blocks requested at any given time from all peers combined. A peer
+ *  with nothing in flight may always be asked for one block, so that downloads can't stall on it. */
+static constexpr uint64_t MAX_BLOCK_BYTES_IN_TRANSIT{512 << 20};
+/** How much block data to keep queued at a peer whose download rate we have measured, expressed in
+ *  the time it needs to deliver it (on top of its ping time). Faster peers are thus given more blocks
+ *  at once, and every peer's queue drains in about the same time. */
+static constexpr auto BLOCK_DOWNLOAD_QUEUE_TIME{2s};
+/** Size assumed for blocks we request before we have received any. */
+static constexpr double DEFAULT_BLOCK_SIZE_ESTIMATE{1'000'000};
+/** Weight of a new sample in the moving averages of block sizes and download rates. */
+static constexpr double BLOCK_DOWNLOAD_EWMA_WEIGHT{0.125};
 /** Default time during which a peer must stall block download progress before being disconnected.
  * the actual timeout is increased temporarily if peers are disconnected for hitting the timeout */
 static constexpr auto BLOCK_STALLING_TIMEOUT_DEFAULT{2s};
@@ -123,6 +143,9 @@ static const int MAX_BLOCKTXN_DEPTH = 10;
  *  degree of disordering of blocks on disk (which make reindexing and pruning harder). We'll probably
  *  want to make this a per-peer adaptive value at some point. */
 static const unsigned int BLOCK_DOWNLOAD_WINDOW = 1024;
+/** Estimated size of the block download window. The window is shrunk below BLOCK_DOWNLOAD_WINDOW
+ *  blocks when blocks are large, to keep the amount of out-of-order data bounded. */
+static constexpr uint64_t BLOCK_DOWNLOAD_WINDOW_BYTES{1ULL << 30};
 /** Block download timeout base, expressed in multiples of the block interval (i.e. 10 min) */
 static constexpr double BLOCK_DOWNLOAD_TIMEOUT_BASE = 1;
 /** Additional block download timeout per parallel downloading peer (i.e. 5 min) */
@@ -151,10 +174,16 @@ static constexpr auto OUTBOUND_INVENTORY_BROADCAST_INTERVAL{2s};
 static constexpr unsigned int INVENTORY_BROADCAST_PER_SECOND = 7;
 /** Target number of tx inventory items to send per transmission. */
 static constexpr unsigned int INVENTORY_BROADCAST_TARGET = INVENTORY_BROADCAST_PER_SECOND * count_seconds(INBOUND_INVENTORY_BROADCAST_INTERVAL);
-/** Maximum number of inventory items to send per transmission. */
-static constexpr unsigned int INVENTORY_BROADCAST_MAX = 1000;
+/** Maximum number of inventory items to send per transmission. Sized for twice an inbound interval's
+ *  worth of the ~300 tx/s that full 32 MB blocks every five minutes amount to. */
+static constexpr unsigned int INVENTORY_BROADCAST_MAX = 3000;
 static_assert(INVENTORY_BROADCAST_MAX >= INVENTORY_BROADCAST_TARGET, "INVENTORY_BROADCAST_MAX too low");
 static_assert(INVENTORY_BROADCAST_MAX <= MAX_PEER_TX_ANNOUNCEMENTS, "INVENTORY_BROADCAST_MAX too high");
+/** How long the relay order looked up for announced transactions is shared between peers before
+ *  it is looked up again. Inbound peers all trickle at the same time, within one such period. */
+static constexpr auto TX_INV_ORDER_CACHE_LIFETIME{1s};
+/** Time scale of the moving average of the rate at which transactions are queued for relay. */
+static constexpr auto TX_INFLOW_AVERAGING_WINDOW{30s};
 /** Average delay between feefilter broadcasts in seconds. */
 static constexpr auto AVG_FEEFILTER_BROADCAST_INTERVAL{10min};
 /** Maximum feefilter broadcast delay after significant change. */
@@ -185,6 +214,10 @@ struct QueuedBlock {
     const CBlockIndex* pindex;
     /** Optional, used for CMPCTBLOCK downloads */
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;
+    /** When the block was requested. */
+    std::chrono::microseconds m_requested_time{0us};
+    /** Size the block was estimated to have when it was requested. */
+    uint64_t m_estimated_size{0};
 };
 
 /**
@@ -279,7 +312,7 @@ struct Peer {
          *  non-wtxid-relay peers, wtxid for wtxid-relay peers). We use the
          *  mempool to sort transactions in dependency order before relay, so
          *  this does not have to be sorted. */
-        std::set<uint256> m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
+        std::unordered_set<uint256, SaltedTxidHasher> m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
         /** Whether the peer has requested us to send our complete mempool. Only
          *  permitted if the peer has NetPermissionFlags::Mempool or we advertise
          *  NODE_BLOOM. See BIP35. */
@@ -424,6 +457,10 @@ struct CNodeState {
     std::list<QueuedBlock> vBlocksInFlight;
     //! When the first entry in vBlocksInFlight started downloading. Don't care when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! Sum of the estimated sizes of the blocks in vBlocksInFlight.
+    uint64_t m_block_bytes_in_flight{0};
+    //! Moving average of the rate at which this peer delivers the blocks we request, in bytes per second, or 0 if unknown.
+    double m_block_download_rate{0};
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /** Whether this peer wants invs or cmpctblocks (when possible) for block announcements. */
@@ -477,6 +514,16 @@ struct CNodeState {
     CNodeState(bool is_inbound) : m_is_inbound(is_inbound) {}
 };
 
+/** What is needed to order and filter a transaction announcement without going back to the mempool. */
+struct TxInvOrderInfo {
+    /** Null if the transaction was no longer in the mempool when looked up. */
+    CTransactionRef tx;
+    uint64_t ancestor_count{0};
+    /** Fee and virtual size, unmodified by prioritisation as in CompareTxMemPoolEntryByScore. */
+    CAmount fee{0};
+    int32_t vsize{0};
+};
+
 class PeerManagerImpl final : public PeerManager
 {
 public:
@@ -577,8 +624,9 @@ private:
     /**
      * Reconsider orphan transactions after a parent has been accepted to the mempool.
      *
-     * @peer[in]  peer     The peer whose orphan transactions we will reconsider. Generally only
-     *                     one orphan will be reconsidered on each call of this function. If an
+     * @peer[in]  peer     The peer whose orphan transactions we will reconsider. Up to
+     *                     MAX_ORPHANS_RECONSIDERED orphans are submitted to the mempool as a
+     *                     batch on each call of this function. If an
      *                     accepted orphan has orphaned children, those will need to be
      *                     reconsidered, creating more work, possibly for other peers.
      * @return             True if meaningful work was done (an orphan was accepted/rejected).
@@ -608,8 +656,8 @@ private:
      * occasional non-connecting header (this can happen due to BIP 130 headers
      * announcements for blocks interacting with the 2hr (MAX_FUTURE_BLOCK_TIME) rule). */
     void HandleFewUnconnectingHeaders(CNode& pfrom, Peer& peer, const std::vector<CBlockHeader>& headers) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
-    /** Return true if the headers connect to each other, false otherwise */
-    bool CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers) const;
+    /** Return true if the headers connect to each other, false otherwise. hashes are the hashes of headers. */
+    bool CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers, Span<const uint256> hashes) const;
     /** Try to continue a low-work headers sync that has already begun.
      * Assumes the caller has already verified the headers connect, and has
      * checked that each header satisfies the proof-of-work target included in
@@ -748,6 +796,30 @@ private:
 
     std::atomic<std::chrono::microseconds> m_next_inv_to_inbounds{0us};
 
+    /** Relay order of recently announced transactions, keyed by the hash they are announced by
+     *  (txid or wtxid). Looked up in the mempool once and shared by all peers trickling within
+     *  TX_INV_ORDER_CACHE_LIFETIME, rather than taking the mempool lock per comparison per peer. */
+    std::unordered_map<uint256, TxInvOrderInfo, SaltedTxidHasher> m_tx_inv_order_cache GUARDED_BY(g_msgproc_mutex);
+    /** Time after which m_tx_inv_order_cache is cleared. */
+    std::chrono::microseconds m_tx_inv_order_cache_expiry GUARDED_BY(g_msgproc_mutex){0us};
+
+    /** Number of times RelayTransaction was called, to measure mempool inflow. */
+    std::atomic<uint64_t> m_txs_relayed{0};
+    /** m_txs_relayed and the time at the last inflow measurement. */
+    uint64_t m_txs_relayed_last GUARDED_BY(g_msgproc_mutex){0};
+    std::chrono::microseconds m_tx_inflow_time GUARDED_BY(g_msgproc_mutex){0us};
+    /** Moving average of transactions queued for relay per second. */
+    double m_tx_inflow_rate GUARDED_BY(g_msgproc_mutex){0.0};
+
+    /** Start a new m_tx_inv_order_cache period and update m_tx_inflow_rate, if the current one is over. */
+    void MaybeResetTxInvOrder(std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
+    /** Look up the relay order of the given transactions that m_tx_inv_order_cache doesn't have yet. */
+    void FetchTxInvOrder(const std::vector<uint256>& hashes, bool wtxid_relay) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
+    /** Maximum number of transactions to announce to a peer in one trickle, given how many are queued. */
+    size_t GetInvBroadcastMax(size_t queued) const EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
     /** Number of nodes with fSyncStarted. */
     int nSyncStarted GUARDED_BY(cs_main) = 0;
 
@@ -930,6 +1002,22 @@ private:
     */
     void FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain=nullptr, NodeId* nodeStaller=nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /** Update the block size estimate and the download rate estimates after a block arrived from
+     *  nodeid, before its request is removed.
+     */
+    void RecordBlockDownload(NodeId nodeid, const uint256& hash, size_t block_size, std::chrono::microseconds ping_time) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Number of additional blocks to request from a peer, based on its download rate and ping time
+     *  and on the per-peer and global limits on the size of the blocks in flight.
+     */
+    unsigned int GetBlockDownloadBudget(const CNodeState& state, std::chrono::microseconds ping_time) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Size of the block download window in blocks, based on the block size estimate. */
+    int GetBlockDownloadWindow() const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Time a typical peer needs to deliver the blocks in flight from this peer, or 0 if we don't know yet. */
+    std::chrono::microseconds ExpectedBlockDownloadTime(const CNodeState& state) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     /* Multimap used to preserve insertion order */
     typedef std::multimap<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator>> BlockDownloadMap;
     BlockDownloadMap mapBlocksInFlight GUARDED_BY(cs_main);
@@ -966,6 +1054,15 @@ private:
     /** Number of peers from which we're downloading blocks. */
     int m_peers_downloading_from GUARDED_BY(cs_main) = 0;
 
+    /** Sum of the estimated sizes of all blocks in flight. */
+    uint64_t m_block_bytes_in_flight GUARDED_BY(cs_main){0};
+
+    /** Moving average of the size of the blocks we received, used as the size estimate for blocks we request. */
+    double m_avg_block_size GUARDED_BY(cs_main){DEFAULT_BLOCK_SIZE_ESTIMATE};
+
+    /** Moving average of the block download rates measured across all peers, in bytes per second, or 0 if unknown. */
+    double m_block_download_rate GUARDED_BY(cs_main){0};
+
     /** Storage for orphan information */
     TxOrphanage m_orphanage;
 
@@ -1187,6 +1284,8 @@ void PeerManagerImpl::RemoveBlockRequest(const uint256& hash, std::optional<Node
             // First block on the queue was received, update the start download time for the next one
             state.m_downloading_since = std::max(state.m_downloading_since, GetTime<std::chrono::microseconds>());
         }
+        state.m_block_bytes_in_flight -= list_it->m_estimated_size;
+        m_block_bytes_in_flight -= list_it->m_estimated_size;
         state.vBlocksInFlight.erase(list_it);
 
         if (state.vBlocksInFlight.empty()) {
@@ -1221,11 +1320,15 @@ bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, st
     // Make sure it's not being fetched already from same peer.
     RemoveBlockRequest(hash, nodeid);
 
+    const auto now{GetTime<std::chrono::microseconds>()};
+    const uint64_t estimated_size{static_cast<uint64_t>(m_avg_block_size)};
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {&block, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool) : nullptr)});
+            {&block, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&m_mempool) : nullptr), now, estimated_size});
+    state->m_block_bytes_in_flight += estimated_size;
+    m_block_bytes_in_flight += estimated_size;
     if (state->vBlocksInFlight.size() == 1) {
         // We're starting a block download (batch) from this peer.
-        state->m_downloading_since = GetTime<std::chrono::microseconds>();
+        state->m_downloading_since = now;
         m_peers_downloading_from++;
     }
     auto itInFlight = mapBlocksInFlight.insert(std::make_pair(hash, std::make_pair(nodeid, it)));
@@ -1381,10 +1484,10 @@ void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int co
         return;
 
     const CBlockIndex *pindexWalk = state->pindexLastCommonBlock;
-    // Never fetch further than the best block we know the peer has, or more than BLOCK_DOWNLOAD_WINDOW + 1 beyond the last
+    // Never fetch further than the best block we know the peer has, or more than the download window + 1 beyond the last
     // linked block we have in common with this peer. The +1 is so we can detect stalling, namely if we would be able to
     // download that next block if the window were 1 larger.
-    int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
+    int nWindowEnd = state->pindexLastCommonBlock->nHeight + GetBlockDownloadWindow();
 
     FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller);
 }
@@ -1415,7 +1518,62 @@ void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned
         return;
     }
 
-    FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + BLOCK_DOWNLOAD_WINDOW, target_block->nHeight));
+    FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + GetBlockDownloadWindow(), target_block->nHeight));
+}
+
+void PeerManagerImpl::RecordBlockDownload(NodeId nodeid, const uint256& hash, size_t block_size, std::chrono::microseconds ping_time)
+{
+    m_avg_block_size += BLOCK_DOWNLOAD_EWMA_WEIGHT * (block_size - m_avg_block_size);
+
+    // Only the block at the front of the queue tells us how fast the peer is: it has been in transfer
+    // since m_downloading_since. Blocks delivered out of order are not measured.
+    CNodeState& state = *Assert(State(nodeid));
+    if (state.vBlocksInFlight.empty() || state.vBlocksInFlight.front().pindex->GetBlockHash() != hash) return;
+    auto elapsed{GetTime<std::chrono::microseconds>() - state.m_downloading_since};
+    if (state.m_downloading_since == state.vBlocksInFlight.front().m_requested_time && ping_time != std::chrono::microseconds::max()) {
+        // The peer was idle when we asked for the block, so the request itself took a round trip.
+        elapsed -= ping_time;
+    }
+    if (elapsed <= 0us) return;
+
+    const double rate{block_size / std::chrono::duration<double>(elapsed).count()};
+    for (double* avg : {&state.m_block_download_rate, &m_block_download_rate}) {
+        *avg = *avg == 0 ? rate : *avg + BLOCK_DOWNLOAD_EWMA_WEIGHT * (rate - *avg);
+    }
+}
+
+unsigned int PeerManagerImpl::GetBlockDownloadBudget(const CNodeState& state, std::chrono::microseconds ping_time) const
+{
+    const uint64_t in_flight{state.vBlocksInFlight.size()};
+    if (in_flight >= MAX_BLOCKS_IN_TRANSIT_PER_PEER) return 0;
+
+    uint64_t peer_limit{MAX_BLOCK_BYTES_IN_TRANSIT_PER_PEER};
+    if (state.m_block_download_rate > 0) {
+        // Keep just enough queued at the peer to keep its link busy until our next requests reach it.
+        if (ping_time == std::chrono::microseconds::max()) ping_time = 0us;
+        const double queue_time{std::chrono::duration<double>(BLOCK_DOWNLOAD_QUEUE_TIME + ping_time).count()};
+        peer_limit = std::min<uint64_t>(peer_limit, state.m_block_download_rate * queue_time);
+    }
+    const uint64_t bytes{std::min(peer_limit - std::min(peer_limit, state.m_block_bytes_in_flight),
+                                  MAX_BLOCK_BYTES_IN_TRANSIT - std::min(MAX_BLOCK_BYTES_IN_TRANSIT, m_block_bytes_in_flight))};
+    uint64_t blocks{static_cast<uint64_t>(bytes / std::max(m_avg_block_size, 1.0))};
+    if (in_flight == 0) blocks = std::max<uint64_t>(blocks, 1);
+    return std::min<uint64_t>(blocks, MAX_BLOCKS_IN_TRANSIT_PER_PEER - in_flight);
+}
+
+int PeerManagerImpl::GetBlockDownloadWindow() const
+{
+    const double window{BLOCK_DOWNLOAD_WINDOW_BYTES / std::max(m_avg_block_size, 1.0)};
+    return std::clamp<double>(window, MAX_BLOCKS_IN_TRANSIT_PER_PEER, BLOCK_DOWNLOAD_WINDOW);
+}
+
+std::chrono::microseconds PeerManagerImpl::ExpectedBlockDownloadTime(const CNodeState& state) const
+{
+    if (m_block_download_rate == 0) return 0us;
+    // Use the current size estimate rather than the ones the requests were made with, which may
+    // predate any block having been received.
+    const double bytes{state.vBlocksInFlight.size() * m_avg_block_size};
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>{bytes / m_block_download_rate});
 }
 
 void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller)
@@ -1613,6 +1771,8 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
     m_num_preferred_download_peers -= state->fPreferredDownload;
     m_peers_downloading_from -= (!state->vBlocksInFlight.empty());
     assert(m_peers_downloading_from >= 0);
+    assert(m_block_bytes_in_flight >= state->m_block_bytes_in_flight);
+    m_block_bytes_in_flight -= state->m_block_bytes_in_flight;
     m_outbound_peers_with_protect_from_disconnect -= state->m_chain_sync.m_protect;
     assert(m_outbound_peers_with_protect_from_disconnect >= 0);
 
@@ -1623,6 +1783,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
         assert(mapBlocksInFlight.empty());
         assert(m_num_preferred_download_peers == 0);
         assert(m_peers_downloading_from == 0);
+        assert(m_block_bytes_in_flight == 0);
         assert(m_outbound_peers_with_protect_from_disconnect == 0);
         assert(m_wtxid_relay_peers == 0);
         assert(m_txrequest.Size() == 0);
@@ -1675,6 +1836,7 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
             if (queue.pindex)
                 stats.vHeightInFlight.push_back(queue.pindex->nHeight);
         }
+        stats.m_block_download_rate = state->m_block_download_rate;
     }
 
     PeerRef peer = GetPeerRef(nodeid);
@@ -1996,7 +2158,12 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
 
     uint256 hashBlock(pblock->GetHash());
     const std::shared_future<CSerializedNetMsg> lazy_ser{
-        std::async(std::launch::deferred, [&] { return msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
+        std::async(std::launch::deferred, [&] {
+            // Shared, so that the per-peer Copy() below doesn't duplicate the payload.
+            CSerializedNetMsg msg{msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock)};
+            msg.Share();
+            return msg;
+        })};
 
     {
         auto most_recent_block_txs = std::make_unique<std::map<uint256, CTransactionRef>>();
@@ -2149,6 +2316,7 @@ void PeerManagerImpl::SendPings()
 
 void PeerManagerImpl::RelayTransaction(const uint256& txid, const uint256& wtxid)
 {
+    ++m_txs_relayed;
     LOCK(m_peer_mutex);
     for(auto& it : m_peer_map) {
         Peer& peer = *it.second;
@@ -2286,7 +2454,19 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         return;
     }
     std::shared_ptr<const CBlock> pblock;
-    if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
+    if (m_opts.block_serve_cache && (inv.IsMsgBlk() || inv.IsMsgWitnessBlk())) {
+        // Serve full blocks from the cache of serialized blocks, so that a block requested by
+        // many peers is only read from disk and serialized once, and shared between their send
+        // queues.
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        msg.m_shared_payload = m_opts.block_serve_cache->GetOrRead(m_chainman.m_blockman, *pindex, inv.IsMsgWitnessBlk());
+        if (!msg.m_shared_payload) {
+            assert(!"cannot load block from disk");
+        }
+        m_connman.PushMessage(&pfrom, std::move(msg));
+        // Don't set pblock as we've sent the block
+    } else if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
         pblock = a_recent_block;
     } else if (inv.IsMsgWitnessBlk()) {
         // Fast-path: in this case it is possible to serve the block directly from disk,
@@ -2483,14 +2663,17 @@ void PeerManagerImpl::SendBlockTransactions(CNode& pfrom, Peer& peer, const CBlo
 
 bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer)
 {
+    // Both checks below need the header hashes; compute them in one batch.
+    const std::vector<uint256> hashes{GetBlockHeaderHashes(headers)};
+
     // Do these headers have proof-of-work matching what's claimed?
-    if (!HasValidProofOfWork(headers, consensusParams)) {
+    if (!HasValidProofOfWork(headers, hashes, consensusParams)) {
         Misbehaving(peer, 100, "header with invalid proof of work");
         return false;
     }
 
     // Are these headers connected to each other?
-    if (!CheckHeadersAreContinuous(headers)) {
+    if (!CheckHeadersAreContinuous(headers, hashes)) {
         Misbehaving(peer, 20, "non-continuous headers sequence");
         return false;
     }
@@ -2548,14 +2731,12 @@ void PeerManagerImpl::HandleFewUnconnectingHeaders(CNode& pfrom, Peer& peer,
     }
 }
 
-bool PeerManagerImpl::CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers) const
+bool PeerManagerImpl::CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers, Span<const uint256> hashes) const
 {
-    uint256 hashLastBlock;
-    for (const CBlockHeader& header : headers) {
-        if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
+    for (size_t i = 1; i < headers.size(); ++i) {
+        if (headers[i].hashPrevBlock != hashes[i - 1]) {
             return false;
         }
-        hashLastBlock = header.GetHash();
     }
     return true;
 }
@@ -2999,81 +3180,92 @@ bool PeerManagerImpl::ProcessOrphanTx(Peer& peer)
     AssertLockHeld(g_msgproc_mutex);
     LOCK(cs_main);
 
-    CTransactionRef porphanTx = nullptr;
-
-    while (CTransactionRef porphanTx = m_orphanage.GetTxToReconsider(peer.m_id)) {
-        const MempoolAcceptResult result = m_chainman.ProcessTransaction(porphanTx);
-        const TxValidationState& state = result.m_state;
-        const uint256& orphanHash = porphanTx->GetHash();
-        const uint256& orphan_wtxid = porphanTx->GetWitnessHash();
-
-        if (result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-            LogPrint(BCLog::TXPACKAGES, "   accepted orphan tx %s (wtxid=%s)\n", orphanHash.ToString(), orphan_wtxid.ToString());
-            LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (wtxid=%s) (poolsz %u txn, %u kB)\n",
-                peer.m_id,
-                orphanHash.ToString(),
-                orphan_wtxid.ToString(),
-                m_mempool.size(), m_mempool.DynamicMemoryUsage() / 1000);
-            RelayTransaction(orphanHash, porphanTx->GetWitnessHash());
-            m_orphanage.AddChildrenToWorkSet(*porphanTx);
-            m_orphanage.EraseTx(orphanHash);
-            for (const CTransactionRef& removedTx : result.m_replaced_transactions.value()) {
-                AddToCompactExtraTransactions(removedTx);
+    bool processed{false};
+    std::vector<CTransactionRef> orphans;
+    while (!processed && !(orphans = m_orphanage.GetTxsToReconsider(peer.m_id, MAX_ORPHANS_RECONSIDERED)).empty()) {
+        const std::vector<MempoolAcceptResult> results{m_chainman.ProcessTransactionBatch(orphans)};
+        for (size_t i = 0; i < orphans.size(); ++i) {
+            const CTransactionRef& porphanTx = orphans[i];
+            std::optional<MempoolAcceptResult> single_result;
+            if (results[i].m_state.GetResult() == TxValidationResult::TX_CONFLICT ||
+                results[i].m_state.GetRejectReason() == "txn-mempool-conflict") {
+                // A batch can neither replace mempool transactions nor contain two spends of the
+                // same coin. Give such an orphan the chance to replace on its own.
+                single_result.emplace(m_chainman.ProcessTransaction(porphanTx));
             }
-            return true;
-        } else if (state.GetResult() != TxValidationResult::TX_MISSING_INPUTS) {
-            if (state.IsInvalid()) {
-                LogPrint(BCLog::TXPACKAGES, "   invalid orphan tx %s (wtxid=%s) from peer=%d. %s\n",
-                    orphanHash.ToString(),
-                    orphan_wtxid.ToString(),
+            const MempoolAcceptResult& result = single_result ? *single_result : results[i];
+            const TxValidationState& state = result.m_state;
+            const uint256& orphanHash = porphanTx->GetHash();
+            const uint256& orphan_wtxid = porphanTx->GetWitnessHash();
+
+            if (result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                LogPrint(BCLog::TXPACKAGES, "   accepted orphan tx %s (wtxid=%s)\n", orphanHash.ToString(), orphan_wtxid.ToString());
+                LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (wtxid=%s) (poolsz %u txn, %u kB)\n",
                     peer.m_id,
-                    state.ToString());
-                LogPrint(BCLog::MEMPOOLREJ, "%s (wtxid=%s) from peer=%d was not accepted: %s\n",
                     orphanHash.ToString(),
                     orphan_wtxid.ToString(),
-                    peer.m_id,
-                    state.ToString());
-                // Maybe punish peer that gave us an invalid orphan tx
-                MaybePunishNodeForTx(peer.m_id, state);
-            }
-            // Has inputs but not accepted to mempool
-            // Probably non-standard or insufficient fee
-            LogPrint(BCLog::TXPACKAGES, "   removed orphan tx %s (wtxid=%s)\n", orphanHash.ToString(), orphan_wtxid.ToString());
-            if (state.GetResult() != TxValidationResult::TX_WITNESS_STRIPPED) {
-                // We can add the wtxid of this transaction to our reject filter.
-                // Do not add txids of witness transactions or witness-stripped
-                // transactions to the filter, as they can have been malleated;
-                // adding such txids to the reject filter would potentially
-                // interfere with relay of valid transactions from peers that
-                // do not support wtxid-based relay. See
-                // https://github.com/bitcoin/bitcoin/issues/8279 for details.
-                // We can remove this restriction (and always add wtxids to
-                // the filter even for witness stripped transactions) once
-                // wtxid-based relay is broadly deployed.
-                // See also comments in https://github.com/bitcoin/bitcoin/pull/18044#discussion_r443419034
-                // for concerns around weakening security of unupgraded nodes
-                // if we start doing this too early.
-                m_recent_rejects.insert(porphanTx->GetWitnessHash());
-                // If the transaction failed for TX_INPUTS_NOT_STANDARD,
-                // then we know that the witness was irrelevant to the policy
-                // failure, since this check depends only on the txid
-                // (the scriptPubKey being spent is covered by the txid).
-                // Add the txid to the reject filter to prevent repeated
-                // processing of this transaction in the event that child
-                // transactions are later received (resulting in
-                // parent-fetching by txid via the orphan-handling logic).
-                if (state.GetResult() == TxValidationResult::TX_INPUTS_NOT_STANDARD && porphanTx->GetWitnessHash() != porphanTx->GetHash()) {
-                    // We only add the txid if it differs from the wtxid, to
-                    // avoid wasting entries in the rolling bloom filter.
-                    m_recent_rejects.insert(porphanTx->GetHash());
+                    m_mempool.size(), m_mempool.DynamicMemoryUsage() / 1000);
+                RelayTransaction(orphanHash, porphanTx->GetWitnessHash());
+                m_orphanage.AddChildrenToWorkSet(*porphanTx);
+                m_orphanage.EraseTx(orphanHash);
+                for (const CTransactionRef& removedTx : result.m_replaced_transactions.value()) {
+                    AddToCompactExtraTransactions(removedTx);
+                }
+                processed = true;
+            } else if (state.GetResult() != TxValidationResult::TX_MISSING_INPUTS) {
+                if (state.IsInvalid()) {
+                    LogPrint(BCLog::TXPACKAGES, "   invalid orphan tx %s (wtxid=%s) from peer=%d. %s\n",
+                        orphanHash.ToString(),
+                        orphan_wtxid.ToString(),
+                        peer.m_id,
+                        state.ToString());
+                    LogPrint(BCLog::MEMPOOLREJ, "%s (wtxid=%s) from peer=%d was not accepted: %s\n",
+                        orphanHash.ToString(),
+                        orphan_wtxid.ToString(),
+                        peer.m_id,
+                        state.ToString());
+                    // Maybe punish peer that gave us an invalid orphan tx
+                    MaybePunishNodeForTx(peer.m_id, state);
                 }
+                // Has inputs but not accepted to mempool
+                // Probably non-standard or insufficient fee
+                LogPrint(BCLog::TXPACKAGES, "   removed orphan tx %s (wtxid=%s)\n", orphanHash.ToString(), orphan_wtxid.ToString());
+                if (state.GetResult() != TxValidationResult::TX_WITNESS_STRIPPED) {
+                    // We can add the wtxid of this transaction to our reject filter.
+                    // Do not add txids of witness transactions or witness-stripped
+                    // transactions to the filter, as they can have been malleated;
+                    // adding such txids to the reject filter would potentially
+                    // interfere with relay of valid transactions from peers that
+                    // do not support wtxid-based relay. See
+                    // https://github.com/bitcoin/bitcoin/issues/8279 for details.
+                    // We can remove this restriction (and always add wtxids to
+                    // the filter even for witness stripped transactions) once
+                    // wtxid-based relay is broadly deployed.
+                    // See also comments in https://github.com/bitcoin/bitcoin/pull/18044#discussion_r443419034
+                    // for concerns around weakening security of unupgraded nodes
+                    // if we start doing this too early.
+                    m_recent_rejects.insert(porphanTx->GetWitnessHash());
+                    // If the transaction failed for TX_INPUTS_NOT_STANDARD,
+                    // then we know that the witness was irrelevant to the policy
+                    // failure, since this check depends only on the txid
+                    // (the scriptPubKey being spent is covered by the txid).
+                    // Add the txid to the reject filter to prevent repeated
+                    // processing of this transaction in the event that child
+                    // transactions are later received (resulting in
+                    // parent-fetching by txid via the orphan-handling logic).
+                    if (state.GetResult() == TxValidationResult::TX_INPUTS_NOT_STANDARD && porphanTx->GetWitnessHash() != porphanTx->GetHash()) {
+                        // We only add the txid if it differs from the wtxid, to
+                        // avoid wasting entries in the rolling bloom filter.
+                        m_recent_rejects.insert(porphanTx->GetHash());
+                    }
+                }
+                m_orphanage.EraseTx(orphanHash);
+                processed = true;
             }
-            m_orphanage.EraseTx(orphanHash);
-            return true;
         }
     }
 
-    return false;
+    return processed;
 }
 
 bool PeerManagerImpl::PrepareBlockFilterRequest(CNode& node, Peer& peer,
@@ -4194,7 +4386,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         const uint256& hash = peer->m_wtxid_relay ? wtxid : txid;
         AddKnownTx(*peer, hash);
 
-        LOCK(cs_main);
+        WAIT_LOCK(cs_main, lock);
 
         m_txrequest.ReceivedResponse(pfrom.GetId(), txid);
         if (tx.HasWitness()) m_txrequest.ReceivedResponse(pfrom.GetId(), wtxid);
@@ -4243,7 +4435,12 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
-        const MempoolAcceptResult result = m_chainman.ProcessTransaction(ptx);
+        const MempoolAcceptResult result = [&] {
+            // Verify the scripts without cs_main, so that RPC threads accepting transactions
+            // and block validation are not held up.
+            REVERSE_LOCK(lock);
+            return m_chainman.ProcessTransactionConcurrent(ptx);
+        }();
         const TxValidationState& state = result.m_state;
 
         if (result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
@@ -4309,7 +4506,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 m_txrequest.ForgetTxHash(tx.GetWitnessHash());
 
                 // DoS prevention: do not allow m_orphanage to grow unbounded (see CVE-2012-3789)
-                m_orphanage.LimitOrphans(m_opts.max_orphan_txs);
+                m_orphanage.LimitOrphans(m_opts.max_orphan_txs, m_opts.max_orphan_usage);
             } else {
                 LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s (wtxid=%s)\n",
                          tx.GetHash().ToString(),
@@ -4685,6 +4882,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        const size_t block_size{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
         vRecv >> *pblock;
 
@@ -4698,6 +4896,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            RecordBlockDownload(pfrom.GetId(), hash, block_size, pfrom.m_min_ping_time.load());
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -5458,26 +5657,72 @@ void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::mi
 }
 
 namespace {
+/** Orders m_tx_inv_order_cache entries as CTxMemPool::CompareDepthAndScore orders the transactions. */
 class CompareInvMempoolOrder
 {
-    CTxMemPool* mp;
-    bool m_wtxid_relay;
 public:
-    explicit CompareInvMempoolOrder(CTxMemPool *_mempool, bool use_wtxid)
-    {
-        mp = _mempool;
-        m_wtxid_relay = use_wtxid;
-    }
+    using Candidate = const std::pair<const uint256, TxInvOrderInfo>*;
 
-    bool operator()(std::set<uint256>::iterator a, std::set<uint256>::iterator b)
+    bool operator()(Candidate a, Candidate b) const
     {
         /* As std::make_heap produces a max-heap, we want the entries with the
          * fewest ancestors/highest fee to sort later. */
-        return mp->CompareDepthAndScore(*b, *a, m_wtxid_relay);
+        return Sooner(b->second, a->second);
+    }
+
+private:
+    static bool Sooner(const TxInvOrderInfo& a, const TxInvOrderInfo& b)
+    {
+        if (a.ancestor_count != b.ancestor_count) return a.ancestor_count < b.ancestor_count;
+        const double f1 = (double)a.fee * b.vsize;
+        const double f2 = (double)b.fee * a.vsize;
+        if (f1 == f2) return b.tx->GetHash() < a.tx->GetHash();
+        return f1 > f2;
     }
 };
 } // namespace
 
+void PeerManagerImpl::MaybeResetTxInvOrder(std::chrono::microseconds now)
+{
+    if (now < m_tx_inv_order_cache_expiry) return;
+    m_tx_inv_order_cache.clear();
+    m_tx_inv_order_cache_expiry = now + TX_INV_ORDER_CACHE_LIFETIME;
+
+    const uint64_t relayed{m_txs_relayed.load()};
+    if (m_tx_inflow_time > 0us) {
+        const std::chrono::duration<double> elapsed{now - m_tx_inflow_time};
+        const double rate{(relayed - m_txs_relayed_last) / elapsed.count()};
+        m_tx_inflow_rate += (rate - m_tx_inflow_rate) * std::min(1.0, elapsed / TX_INFLOW_AVERAGING_WINDOW);
+    }
+    m_txs_relayed_last = relayed;
+    m_tx_inflow_time = now;
+}
+
+void PeerManagerImpl::FetchTxInvOrder(const std::vector<uint256>& hashes, bool wtxid_relay)
+{
+    if (hashes.empty()) return;
+    LOCK(m_mempool.cs);
+    for (const uint256& hash : hashes) {
+        const auto it{wtxid_relay ? m_mempool.get_iter_from_wtxid(hash) : m_mempool.mapTx.find(hash)};
+        TxInvOrderInfo& info{m_tx_inv_order_cache[hash]};
+        if (it == m_mempool.mapTx.end()) continue;
+        info.tx = it->GetSharedTx();
+        info.ancestor_count = it->GetCountWithAncestors();
+        info.fee = it->GetFee();
+        info.vsize = it->GetTxSize();
+    }
+}
+
+size_t PeerManagerImpl::GetInvBroadcastMax(size_t queued) const
+{
+    // Keep up with the rate transactions come in at, with headroom for peers that draw long delays.
+    const auto inflow_target{static_cast<size_t>(m_tx_inflow_rate * count_seconds(INBOUND_INVENTORY_BROADCAST_INTERVAL) * 2)};
+    // Drain a backlog faster, but no reason to drain out at many times the network's capacity,
+    // especially since we have many peers and some will draw much shorter delays.
+    const size_t broadcast_max{std::max<size_t>(INVENTORY_BROADCAST_TARGET, inflow_target) + (queued / 1000) * 5};
+    return std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
+}
+
 bool PeerManagerImpl::RejectIncomingTxs(const CNode& peer) const
 {
     // block-relay-only peers may never send txs to us
@@ -5802,41 +6047,47 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
 
                 // Determine transactions to relay
                 if (fSendTrickle) {
-                    // Produce a vector with all candidates for sending
-                    std::vector<std::set<uint256>::iterator> vInvTx;
+                    // Look up the relay order of candidates no other peer has needed it for yet,
+                    // under a single mempool lock.
+                    MaybeResetTxInvOrder(current_time);
+                    std::vector<uint256> missing;
+                    for (const uint256& hash : tx_relay->m_tx_inventory_to_send) {
+                        if (!m_tx_inv_order_cache.count(hash)) missing.push_back(hash);
+                    }
+                    FetchTxInvOrder(missing, peer->m_wtxid_relay);
+
+                    // Produce a vector with all candidates for sending that are still in the mempool
+                    std::vector<CompareInvMempoolOrder::Candidate> vInvTx;
                     vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
-                    for (std::set<uint256>::iterator it = tx_relay->m_tx_inventory_to_send.begin(); it != tx_relay->m_tx_inventory_to_send.end(); it++) {
-                        vInvTx.push_back(it);
+                    for (auto it = tx_relay->m_tx_inventory_to_send.begin(); it != tx_relay->m_tx_inventory_to_send.end();) {
+                        const auto& candidate{*m_tx_inv_order_cache.find(*it)};
+                        if (!candidate.second.tx) {
+                            it = tx_relay->m_tx_inventory_to_send.erase(it);
+                            continue;
+                        }
+                        vInvTx.push_back(&candidate);
+                        ++it;
                     }
                     const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
                     // Topologically and fee-rate sort the inventory we send for privacy and priority reasons.
                     // A heap is used so that not all items need sorting if only a few are being sent.
-                    CompareInvMempoolOrder compareInvMempoolOrder(&m_mempool, peer->m_wtxid_relay);
+                    CompareInvMempoolOrder compareInvMempoolOrder;
                     std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
-                    // No reason to drain out at many times the network's capacity,
-                    // especially since we have many peers and some will draw much shorter delays.
                     unsigned int nRelayedTransactions = 0;
                     LOCK(tx_relay->m_bloom_filter_mutex);
-                    size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
-                    broadcast_max = std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
+                    const size_t broadcast_max{GetInvBroadcastMax(tx_relay->m_tx_inventory_to_send.size())};
                     while (!vInvTx.empty() && nRelayedTransactions < broadcast_max) {
                         // Fetch the top element from the heap
                         std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
-                        std::set<uint256>::iterator it = vInvTx.back();
+                        const auto& [hash, txinfo] = *vInvTx.back();
                         vInvTx.pop_back();
-                        uint256 hash = *it;
                         CInv inv(peer->m_wtxid_relay ? MSG_WTX : MSG_TX, hash);
                         // Remove it from the to-be-sent set
-                        tx_relay->m_tx_inventory_to_send.erase(it);
+                        tx_relay->m_tx_inventory_to_send.erase(hash);
                         // Check if not in the filter already
                         if (tx_relay->m_tx_inventory_known_filter.contains(hash)) {
                             continue;
                         }
-                        // Not in the mempool anymore? don't bother sending it.
-                        auto txinfo = m_mempool.info(ToGenTxid(inv));
-                        if (!txinfo.tx) {
-                            continue;
-                        }
                         // Peer told you to not send transactions at that feerate? Don't bother sending it.
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
                             continue;
@@ -5860,9 +6111,11 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         if (!vInv.empty())
             m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
 
-        // Detect whether we're stalling
+        // Detect whether we're stalling. On top of the stalling timeout, the peer gets the time a typical peer
+        // would need to deliver the blocks it has in flight, as large blocks can take longer than the
+        // timeout to arrive from a peer that is not stalling at all.
         auto stalling_timeout = m_block_stalling_timeout.load();
-        if (state.m_stalling_since.count() && state.m_stalling_since < current_time - stalling_timeout) {
+        if (state.m_stalling_since.count() && state.m_stalling_since < current_time - stalling_timeout - ExpectedBlockDownloadTime(state)) {
             // Stalling only triggers when the block download window cannot move. During normal steady state,
             // the download window should be much larger than the to-be-downloaded set of blocks, so disconnection
             // should only happen during initial block download.
@@ -5934,8 +6187,8 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            auto get_inflight_budget = [&state]() {
-                return std::max(0, MAX_BLOCKS_IN_TRANSIT_PER_PEER - static_cast<int>(state.vBlocksInFlight.size()));
+            auto get_inflight_budget = [&]() EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+                return GetBlockDownloadBudget(state, pto->m_min_ping_time.load());
             };
 
             // If a snapshot chainstate is in use, we want to find its next blocks
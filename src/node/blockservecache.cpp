@@ -0,0 +1,85 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockservecache.h>
+
+#include <chain.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <validation.h>
+#include <version.h>
+
+#include <utility>
+#include <vector>
+
+namespace node {
+
+std::shared_ptr<const SharedNetMsgPayload> BlockServeCache::Get(const uint256& block_hash, bool witness)
+{
+    LOCK(m_mutex);
+    auto it = m_index.find(Key{block_hash, witness});
+    if (it == m_index.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->payload;
+}
+
+void BlockServeCache::Insert(const uint256& block_hash, bool witness, std::shared_ptr<const SharedNetMsgPayload> payload)
+{
+    if (!payload || payload->data.size() > m_max_usage) return;
+    const Key key{block_hash, witness};
+
+    LOCK(m_mutex);
+    // Another thread may have raced us to it; the contents are identical either way.
+    if (m_index.count(key)) return;
+    while (m_usage + payload->data.size() > m_max_usage) {
+        const Entry& victim = m_lru.back();
+        m_usage -= victim.payload->data.size();
+        m_index.erase(victim.key);
+        m_lru.pop_back();
+        ++m_evictions;
+    }
+    m_usage += payload->data.size();
+    m_lru.push_front(Entry{key, std::move(payload)});
+    m_index.emplace(key, m_lru.begin());
+}
+
+std::shared_ptr<const SharedNetMsgPayload> BlockServeCache::GetOrRead(const BlockManager& blockman, const CBlockIndex& index, bool witness)
+{
+    const uint256 block_hash{index.GetBlockHash()};
+    if (auto payload{Get(block_hash, witness)}) return payload;
+
+    std::vector<uint8_t> block_data;
+    if (witness) {
+        // The network format with witness matches the format on disk.
+        const FlatFilePos pos{WITH_LOCK(::cs_main, return index.GetBlockPos())};
+        if (!blockman.ReadRawBlockFromDisk(block_data, pos)) return nullptr;
+    } else {
+        CBlock block;
+        if (!blockman.ReadBlockFromDisk(block, index)) return nullptr;
+        CVectorWriter{SERIALIZE_TRANSACTION_NO_WITNESS | PROTOCOL_VERSION, block_data, 0, block};
+    }
+    auto payload{std::make_shared<const SharedNetMsgPayload>(std::move(block_data))};
+    Insert(block_hash, witness, payload);
+    return payload;
+}
+
+BlockServeCache::Stats BlockServeCache::GetStats() const
+{
+    LOCK(m_mutex);
+    Stats stats;
+    stats.entries = m_lru.size();
+    stats.usage = m_usage;
+    stats.max_usage = m_max_usage;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+} // namespace node
@@ -0,0 +1,93 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKSERVECACHE_H
+#define BITCOIN_NODE_BLOCKSERVECACHE_H
+
+#include <net.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+class CBlockIndex;
+
+namespace node {
+class BlockManager;
+
+/** Default for -blockservecache, the memory budget of the BlockServeCache in MiB. */
+static constexpr int64_t DEFAULT_BLOCK_SERVE_CACHE_SIZE{128};
+
+/**
+ * Bounded LRU cache of serialized blocks, as sent in response to getdata(MSG_BLOCK /
+ * MSG_WITNESS_BLOCK) and served over REST.
+ *
+ * Peers catching up on the chain tend to request the same recent blocks, which would otherwise be
+ * read from disk and reserialized for every single request. Blocks are cached separately with and
+ * without witness data, as SharedNetMsgPayload objects, so that a hit can be queued to any number
+ * of peers without copying the bytes.
+ *
+ * The memory budget covers the serialized bytes of all entries; a block that doesn't fit in it
+ * at all is never cached. Thread-safe.
+ */
+class BlockServeCache
+{
+public:
+    struct Stats {
+        size_t entries{0};
+        //! Bytes of serialized blocks currently held
+        size_t usage{0};
+        size_t max_usage{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+    };
+
+    explicit BlockServeCache(size_t max_usage) : m_max_usage{max_usage} {}
+
+    /** Look up a serialized block, marking it as most recently used. Counts a hit or a miss. */
+    std::shared_ptr<const SharedNetMsgPayload> Get(const uint256& block_hash, bool witness) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Add a serialized block, evicting least recently used entries to stay within budget. */
+    void Insert(const uint256& block_hash, bool witness, std::shared_ptr<const SharedNetMsgPayload> payload) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Return the serialized block for index, reading it from disk (and caching it) on a miss.
+     *  Returns nullptr if the block could not be read. */
+    std::shared_ptr<const SharedNetMsgPayload> GetOrRead(const BlockManager& blockman, const CBlockIndex& index, bool witness) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Stats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Key {
+        uint256 block_hash;
+        bool witness;
+        bool operator==(const Key& other) const { return block_hash == other.block_hash && witness == other.witness; }
+    };
+    struct KeyHasher {
+        size_t operator()(const Key& key) const { return key.block_hash.GetUint64(0) ^ size_t{key.witness}; }
+    };
+    struct Entry {
+        Key key;
+        std::shared_ptr<const SharedNetMsgPayload> payload;
+    };
+
+    const size_t m_max_usage;
+
+    mutable Mutex m_mutex;
+    //! Entries, from most to least recently used
+    std::list<Entry> m_lru GUARDED_BY(m_mutex);
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHasher> m_index GUARDED_BY(m_mutex);
+    size_t m_usage GUARDED_BY(m_mutex){0};
+    uint64_t m_hits GUARDED_BY(m_mutex){0};
+    uint64_t m_misses GUARDED_BY(m_mutex){0};
+    uint64_t m_evictions GUARDED_BY(m_mutex){0};
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKSERVECACHE_H
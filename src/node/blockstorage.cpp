@@ -191,10 +191,16 @@ const CBlockIndex* BlockManager::LookupBlockIndex(const uint256& hash) const
 }
 
 CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header)
+{
+    return AddToBlockIndex(block, block.GetHash(), best_header);
+}
+
+CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, const uint256& hash, CBlockIndex*& best_header)
 {
     AssertLockHeld(cs_main);
+    Assume(hash == block.GetHash());
 
-    auto [mi, inserted] = m_block_index.try_emplace(block.GetHash(), block);
+    auto [mi, inserted] = m_block_index.try_emplace(hash, block);
     if (!inserted) {
         return &mi->second;
     }
@@ -11,7 +11,9 @@
 #include <net.h>
 #include <net_processing.h>
 #include <netgroup.h>
+#include <node/blockservecache.h>
 #include <node/kernel_notifications.h>
+#include <node/mempool_fee_estimator.h>
 #include <policy/fees.h>
 #include <scheduler.h>
 #include <txmempool.h>
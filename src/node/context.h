@@ -33,7 +33,9 @@ class WalletLoader;
 } // namespace interfaces
 
 namespace node {
+class BlockServeCache;
 class KernelNotifications;
+class MempoolFeeEstimator;
 
 //! NodeContext struct containing references to chain state and connection
 //! state.
@@ -55,6 +57,8 @@ struct NodeContext {
     std::unique_ptr<CTxMemPool> mempool;
     std::unique_ptr<const NetGroupManager> netgroupman;
     std::unique_ptr<CBlockPolicyEstimator> fee_estimator;
+    std::unique_ptr<MempoolFeeEstimator> mempool_fee_estimator;
+    std::unique_ptr<BlockServeCache> block_serve_cache;
     std::unique_ptr<PeerManager> peerman;
     std::unique_ptr<ChainstateManager> chainman;
     std::unique_ptr<BanMan> banman;
@@ -0,0 +1,54 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/mempool_fee_estimator.h>
+
+#include <consensus/consensus.h>
+#include <kernel/cs_main.h>
+#include <node/miner.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <algorithm>
+
+namespace node {
+
+/** Weight BlockAssembler sets aside for the block header and the coinbase transaction. */
+static constexpr int64_t COINBASE_RESERVED_WEIGHT{4000};
+
+int64_t MempoolFeeEstimator::GetBlockVsize(const CTxMemPool& mempool, const ChainstateManager& chainman)
+{
+    const int height{WITH_LOCK(::cs_main, return chainman.ActiveChain().Height()) + 1};
+    const size_t weight{GetTemplateMaxBlockWeight(mempool.size(), height, chainman.GetParams())};
+    return std::max<int64_t>(0, int64_t(weight) - COINBASE_RESERVED_WEIGHT) / WITNESS_SCALE_FACTOR;
+}
+
+void MempoolFeeEstimator::Update(const CTxMemPool& mempool, const ChainstateManager& chainman)
+{
+    AssertLockHeld(m_mutex);
+    // Read the counter before the mempool contents: should the mempool change in between, the
+    // next query runs the simulation again.
+    const std::pair<unsigned int, int64_t> key{mempool.GetTransactionsUpdated(), GetBlockVsize(mempool, chainman)};
+    if (m_cache_key == key) return;
+    m_blocks = MiniMiner{mempool}.BuildMockBlocks(key.second, MAX_TARGET);
+    m_cache_key = key;
+}
+
+CFeeRate MempoolFeeEstimator::EstimateFee(const CTxMemPool& mempool, const ChainstateManager& chainman, unsigned int target)
+{
+    LOCK(m_mutex);
+    Update(mempool, chainman);
+    target = std::clamp(target, 1U, MAX_TARGET);
+    if (target > m_blocks.size() || !m_blocks[target - 1].full) return CFeeRate{0};
+    return m_blocks[target - 1].min_feerate;
+}
+
+std::vector<MempoolFeeEstimator::MockBlock> MempoolFeeEstimator::GetBlocks(const CTxMemPool& mempool, const ChainstateManager& chainman, size_t count)
+{
+    LOCK(m_mutex);
+    Update(mempool, chainman);
+    return {m_blocks.begin(), m_blocks.begin() + std::min(count, m_blocks.size())};
+}
+
+} // namespace node
@@ -0,0 +1,62 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_MEMPOOL_FEE_ESTIMATOR_H
+#define BITCOIN_NODE_MEMPOOL_FEE_ESTIMATOR_H
+
+#include <node/mini_miner.h>
+#include <policy/feerate.h>
+#include <sync.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class ChainstateManager;
+class CTxMemPool;
+
+namespace node {
+
+/**
+ * Fee estimation from the current contents of the mempool, as opposed to the confirmation
+ * history CBlockPolicyEstimator learns from.
+ *
+ * The next blocks are simulated with MiniMiner at the block weight CreateNewBlock() would use for
+ * the current mempool and chain height. A transaction makes it into block k if it pays at least
+ * the lowest package feerate in it, provided the block is full. The simulation is cached until the
+ * mempool or the block weight changes, so that repeated queries are cheap. Thread-safe.
+ */
+class MempoolFeeEstimator
+{
+public:
+    /** Highest confirmation target, and number of blocks simulated at most. */
+    static constexpr unsigned int MAX_TARGET{1008};
+
+    using MockBlock = MiniMiner::MockBlock;
+
+    /** Feerate needed to be included within target blocks, or 0 if the mempool does not fill that
+     *  many blocks and any feerate the mempool accepts will do. */
+    CFeeRate EstimateFee(const CTxMemPool& mempool, const ChainstateManager& chainman, unsigned int target) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Up to count simulated next blocks. */
+    std::vector<MockBlock> GetBlocks(const CTxMemPool& mempool, const ChainstateManager& chainman, size_t count) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Virtual size available to transactions in each simulated block. */
+    static int64_t GetBlockVsize(const CTxMemPool& mempool, const ChainstateManager& chainman);
+
+private:
+    Mutex m_mutex;
+    /** Mempool update counter and block vsize the cached simulation was run for. */
+    std::optional<std::pair<unsigned int, int64_t>> m_cache_key GUARDED_BY(m_mutex);
+    std::vector<MockBlock> m_blocks GUARDED_BY(m_mutex);
+
+    /** Rerun the simulation if the mempool or the block vsize changed since the last one. */
+    void Update(const CTxMemPool& mempool, const ChainstateManager& chainman) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_MEMPOOL_FEE_ESTIMATOR_H
@@ -10,6 +10,7 @@
 
 #include <chain.h>
 #include <chainparams.h>
+#include <cluster_linearize.h>
 #include <coins.h>
 #include <common/args.h>
 #include <consensus/amount.h>
@@ -152,6 +153,18 @@ void ApplyArgsManOptions(const ArgsManager& args, BlockAssembler::Options& optio
 
 // 찾기용 앵커(끝): ApplyArgsManOptions LOG FIX REPLACE END
 
+size_t GetTemplateMaxBlockWeight(size_t mempool_tx_count, int height, const CChainParams& params)
+{
+    if (params.GetChainType() == ChainType::REGTEST) return 4'000'000;
+    if (mempool_tx_count == 0) return DEFAULT_BLOCK_MAX_WEIGHT;
+    const auto& consensus = params.GetConsensus();
+    const size_t hard_cap = (params.GetChainType() == ChainType::BTCBT)
+        ? static_cast<size_t>(consensus.btcbt_max_block_size) * WITNESS_SCALE_FACTOR
+        : static_cast<size_t>(MAX_BLOCK_WEIGHT);
+    const int target = GetAdaptiveMaxBlockWeight(mempool_tx_count, height, consensus);
+    return std::clamp<size_t>(target, 4000, hard_cap);
+}
+
 
 // 찾기용 앵커(시작): ConfiguredOptions LOG FIX REPLACE START
 static BlockAssembler::Options ConfiguredOptions(const CTxMemPool* mempool, const Chainstate& chainstate)
@@ -289,25 +302,10 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     // 찾기용 앵커(시작): CreateNewBlock LOG FIX REPLACE START
     {
         const CChainParams& params = chainparams;
-        const auto& consensus = params.GetConsensus();
-        const bool is_regtest = (params.GetChainType() == ChainType::REGTEST);
         const int mp = (m_mempool ? static_cast<int>(m_mempool->size()) : 0);
 
         // const m_options를 수정할 수 없으므로, '의도한 값'을 계산해서 현재 값과 비교만 수행
-              size_t desired_weight = 0;
-        if (is_regtest) {
-            desired_weight = 4'000'000;
-        } else if (mp == 0) {
-            desired_weight = (size_t)DEFAULT_BLOCK_MAX_WEIGHT;
-        } else {
-            const size_t btcbt_max_weight = (size_t)consensus.btcbt_max_block_size * (size_t)WITNESS_SCALE_FACTOR;
-
-            const size_t hard_cap =
-                (params.GetChainType() == ChainType::BTCBT) ? btcbt_max_weight : (size_t)MAX_BLOCK_WEIGHT;
-
-            const int target = GetAdaptiveMaxBlockWeight((size_t)mp, nHeight, consensus);
-            desired_weight = (size_t)std::clamp<int>(target, 4000, (int)hard_cap);
-        }
+        const size_t desired_weight{GetTemplateMaxBlockWeight(mp, nHeight, params)};
         // 로그: 현재 값과 의도한 값 비교(필요 시 추적)
         LogPrintf("CreateNewBlock: mp=%d, height=%d, nBlockMaxWeight(cur)=%zu, desired=%zu\n",
                   mp, nHeight, static_cast<size_t>(m_options.nBlockMaxWeight), desired_weight);
@@ -325,11 +323,10 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     pblock->nTime = TicksSinceEpoch<std::chrono::seconds>(GetAdjustedTime());
     m_lock_time_cutoff = pindexPrev->GetMedianTimePast();
 
-    int nPackagesSelected = 0;
-    int nDescendantsUpdated = 0;
+    int nChunksSelected = 0;
     if (m_mempool) {
         LOCK(m_mempool->cs);
-        addPackageTxs(*m_mempool, nPackagesSelected, nDescendantsUpdated);
+        addChunks(*m_mempool, nChunksSelected);
     }
 
     m_last_block_num_txs = nBlockTx;
@@ -373,25 +370,14 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     }
 
     const auto time_2{SteadyClock::now()};
-    LogPrint(BCLog::BENCH, "CreateNewBlock() packages: %.2fms (%d packages, %d updated descendants), validity: %.2fms (total %.2fms)\n",
-             Ticks<MillisecondsDouble>(time_2 - time_start), nPackagesSelected, nDescendantsUpdated,
+    LogPrint(BCLog::BENCH, "CreateNewBlock() chunks: %.2fms (%d chunks), validity: %.2fms (total %.2fms)\n",
+             Ticks<MillisecondsDouble>(time_2 - time_start), nChunksSelected,
              Ticks<MillisecondsDouble>(time_2 - time_2),
              Ticks<MillisecondsDouble>(time_2 - time_start));
 
     return std::move(pblocktemplate);
 }
 
-void BlockAssembler::onlyUnconfirmed(CTxMemPool::setEntries& testSet)
-{
-    for (auto it = testSet.begin(); it != testSet.end(); ) {
-        if (inBlock.count(*it)) {
-            testSet.erase(it++);
-        } else {
-            ++it;
-        }
-    }
-}
-
 bool BlockAssembler::TestPackage(uint64_t packageSize, int64_t packageSigOpsCost) const
 {
     if (nBlockWeight + WITNESS_SCALE_FACTOR * packageSize >= m_options.nBlockMaxWeight) return false;
@@ -410,7 +396,7 @@ bool BlockAssembler::TestPackage(uint64_t packageSize, int64_t packageSigOpsCost
     return true;
 }
 
-bool BlockAssembler::TestPackageTransactions(const CTxMemPool::setEntries& package) const
+bool BlockAssembler::TestPackageTransactions(Span<const CTxMemPool::txiter> package) const
 {
     for (CTxMemPool::txiter it : package) {
         if (!IsFinalTx(it->GetTx(), nHeight, m_lock_time_cutoff)) return false;
@@ -435,94 +421,46 @@ void BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
                   iter->GetTx().GetHash().ToString());
     }
 }
-static int UpdatePackagesForAdded(const CTxMemPool& mempool,
-                                  const CTxMemPool::setEntries& alreadyAdded,
-                                  indexed_modified_transaction_set& mapModifiedTx)
-    EXCLUSIVE_LOCKS_REQUIRED(mempool.cs)
-{
-    AssertLockHeld(mempool.cs);
-    int nDescendantsUpdated = 0;
-    for (CTxMemPool::txiter it : alreadyAdded) {
-        CTxMemPool::setEntries descendants;
-        mempool.CalculateDescendants(it, descendants);
-        for (CTxMemPool::txiter desc : descendants) {
-            if (alreadyAdded.count(desc)) continue;
-            ++nDescendantsUpdated;
-            modtxiter mit = mapModifiedTx.find(desc);
-            if (mit == mapModifiedTx.end()) {
-                CTxMemPoolModifiedEntry modEntry(desc);
-                mit = mapModifiedTx.insert(modEntry).first;
-            }
-            mapModifiedTx.modify(mit, update_for_parent_inclusion(it));
-        }
-    }
-    return nDescendantsUpdated;
-}
-
-void BlockAssembler::SortForBlock(const CTxMemPool::setEntries& package,
-                                  std::vector<CTxMemPool::txiter>& sortedEntries)
-{
-    sortedEntries.clear();
-    sortedEntries.insert(sortedEntries.begin(), package.begin(), package.end());
-    std::sort(sortedEntries.begin(), sortedEntries.end(), CompareTxIterByAncestorCount());
-}
-
-void BlockAssembler::addPackageTxs(const CTxMemPool& mempool, int& nPackagesSelected, int& nDescendantsUpdated)
+void BlockAssembler::addChunks(const CTxMemPool& mempool, int& nChunksSelected)
 {
     AssertLockHeld(mempool.cs);
 
-    indexed_modified_transaction_set mapModifiedTx;
-    CTxMemPool::setEntries failedTx;
-
-    auto mi = mempool.mapTx.get<ancestor_score>().begin();
-    CTxMemPool::txiter iter;
+    const std::vector<CTxMemPool::Cluster> clusters{mempool.GetAllClusters()};
+    std::vector<std::pair<size_t, size_t>> chunks; // (cluster, chunk within the cluster)
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        for (size_t k = 0; k < clusters[c].chunks.size(); ++k) chunks.emplace_back(c, k);
+    }
+    // Highest chunk feerate first. The chunks of a cluster never increase in feerate, so a stable
+    // sort keeps them in their cluster's order.
+    std::stable_sort(chunks.begin(), chunks.end(), [&](const auto& a, const auto& b) {
+        const auto& chunk_a{clusters[a.first].chunks[a.second]};
+        const auto& chunk_b{clusters[b.first].chunks[b.second]};
+        return cluster_linearize::FeerateHigher(chunk_a.fee, chunk_a.size, chunk_b.fee, chunk_b.size);
+    });
 
     const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
     int64_t nConsecutiveFailed = 0;
 
-    while (mi != mempool.mapTx.get<ancestor_score>().end() || !mapModifiedTx.empty()) {
-        if (mi != mempool.mapTx.get<ancestor_score>().end()) {
-            auto it = mempool.mapTx.project<0>(mi);
-            if (mapModifiedTx.count(it) || inBlock.count(it) || failedTx.count(it)) {
-                ++mi;
-                continue;
-            }
-        }
-
-        bool fUsingModified = false;
-        modtxscoreiter modit = mapModifiedTx.get<ancestor_score>().begin();
-        if (mi == mempool.mapTx.get<ancestor_score>().end()) {
-            iter = modit->iter;
-            fUsingModified = true;
-        } else {
-            iter = mempool.mapTx.project<0>(mi);
-            if (modit != mapModifiedTx.get<ancestor_score>().end() &&
-                CompareTxMemPoolEntryByAncestorFee()(*modit, CTxMemPoolModifiedEntry(iter))) {
-                iter = modit->iter;
-                fUsingModified = true;
-            } else {
-                ++mi;
-            }
-        }
-
-        assert(!inBlock.count(iter));
-        uint64_t packageSize = iter->GetSizeWithAncestors();
-        CAmount packageFees = iter->GetModFeesWithAncestors();
-        int64_t packageSigOpsCost = iter->GetSigOpCostWithAncestors();
-
-        if (fUsingModified) {
-            packageSize = modit->nSizeWithAncestors;
-            packageFees = modit->nModFeesWithAncestors;
-            packageSigOpsCost = modit->nSigOpCostWithAncestors;
-        }
-
-        if (packageFees < m_options.blockMinFeeRate.GetFee(packageSize)) return;
-
-        if (!TestPackage(packageSize, packageSigOpsCost)) {
-            if (fUsingModified) {
-                mapModifiedTx.get<ancestor_score>().erase(modit);
-                failedTx.insert(iter);
-            }
+    for (const auto& [c, k] : chunks) {
+        const cluster_linearize::Chunk& chunk{clusters[c].chunks[k]};
+        const Span<const CTxMemPool::txiter> txs{Span{clusters[c].txs}.subspan(chunk.begin, chunk.end - chunk.begin)};
+
+        if (chunk.fee < m_options.blockMinFeeRate.GetFee(static_cast<uint32_t>(chunk.size))) return;
+
+        // An earlier chunk of the cluster may have been left out, and this one depend on it.
+        const CTxMemPool::setEntries in_chunk(txs.begin(), txs.end());
+        const bool parents_included{std::all_of(txs.begin(), txs.end(), [&](CTxMemPool::txiter it) {
+            const auto& parents{it->GetMemPoolParentsConst()};
+            return std::all_of(parents.begin(), parents.end(), [&](const CTxMemPoolEntry& parent) {
+                const auto parent_it{mempool.mapTx.iterator_to(parent)};
+                return inBlock.count(parent_it) || in_chunk.count(parent_it);
+            });
+        })};
+        if (!parents_included) continue;
+
+        int64_t chunkSigOpsCost = 0;
+        for (CTxMemPool::txiter it : txs) chunkSigOpsCost += it->GetSigOpCost();
+        if (!TestPackage(chunk.size, chunkSigOpsCost)) {
             ++nConsecutiveFailed;
             if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES &&
                 nBlockWeight > m_options.nBlockMaxWeight - 4000) {
@@ -531,30 +469,11 @@ void BlockAssembler::addPackageTxs(const CTxMemPool& mempool, int& nPackagesSele
             continue;
         }
 
-        auto ancestors = mempool.AssumeCalculateMemPoolAncestors(__func__, *iter,
-                            CTxMemPool::Limits::NoLimits(), false);
-        onlyUnconfirmed(ancestors);
-        ancestors.insert(iter);
-
-        if (!TestPackageTransactions(ancestors)) {
-            if (fUsingModified) {
-                mapModifiedTx.get<ancestor_score>().erase(modit);
-                failedTx.insert(iter);
-            }
-            continue;
-        }
+        if (!TestPackageTransactions(txs)) continue;
 
         nConsecutiveFailed = 0;
-        std::vector<CTxMemPool::txiter> sortedEntries;
-        SortForBlock(ancestors, sortedEntries);
-
-        for (CTxMemPool::txiter sortedIt : sortedEntries) {
-            AddToBlock(sortedIt);
-            mapModifiedTx.erase(sortedIt);
-        }
-
-        ++nPackagesSelected;
-        nDescendantsUpdated += UpdatePackagesForAdded(mempool, ancestors, mapModifiedTx);
+        for (CTxMemPool::txiter it : txs) AddToBlock(it);
+        ++nChunksSelected;
     }
 }
 
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <queue>
 #include <utility>
 
 namespace node {
@@ -69,11 +70,10 @@ MiniMiner::MiniMiner(const CTxMemPool& mempool, const std::vector<COutPoint>& ou
         return;
     }
 
-    // Add every entry to m_entries_by_txid and m_entries, except the ones that will be replaced.
+    // Add every entry to m_entries_by_txid, except the ones that will be replaced.
     for (const auto& txiter : cluster) {
         if (!m_to_be_replaced.count(txiter->GetTx().GetHash())) {
-            auto [mapiter, success] = m_entries_by_txid.emplace(txiter->GetTx().GetHash(), MiniMinerMempoolEntry(txiter));
-            m_entries.push_back(mapiter);
+            m_entries_by_txid.emplace(txiter->GetTx().GetHash(), MiniMinerMempoolEntry(txiter));
         } else {
             auto outpoints_it = m_requested_outpoints_by_txid.find(txiter->GetTx().GetHash());
             if (outpoints_it != m_requested_outpoints_by_txid.end()) {
@@ -122,37 +122,44 @@ MiniMiner::MiniMiner(const CTxMemPool& mempool, const std::vector<COutPoint>& ou
     SanityCheck();
 }
 
-// Compare by min(ancestor feerate, individual feerate), then iterator
+MiniMiner::MiniMiner(const CTxMemPool& mempool)
+{
+    LOCK(mempool.cs);
+    for (auto txiter = mempool.mapTx.begin(); txiter != mempool.mapTx.end(); ++txiter) {
+        m_entries_by_txid.emplace(txiter->GetTx().GetHash(), MiniMinerMempoolEntry(txiter));
+    }
+    for (auto txiter = mempool.mapTx.begin(); txiter != mempool.mapTx.end(); ++txiter) {
+        CTxMemPool::setEntries descendants;
+        mempool.CalculateDescendants(txiter, descendants);
+        std::vector<MockEntryMap::iterator> cached_descendants;
+        cached_descendants.reserve(descendants.size());
+        for (const auto& desc_txiter : descendants) {
+            cached_descendants.push_back(m_entries_by_txid.find(desc_txiter->GetTx().GetHash()));
+        }
+        m_descendant_set_by_txid.emplace(txiter->GetTx().GetHash(), std::move(cached_descendants));
+    }
+    SanityCheck();
+}
+
+// Mining score: min(ancestor feerate, individual feerate)
 //
 // Under the ancestor-based mining approach, high-feerate children can pay for parents, but high-feerate
 // parents do not incentive inclusion of their children. Therefore the mining algorithm only considers
 // transactions for inclusion on basis of the minimum of their own feerate or their ancestor feerate.
-struct AncestorFeerateComparator
+static CFeeRate MiningScore(const MiniMinerMempoolEntry& e)
 {
-    template<typename I>
-    bool operator()(const I& a, const I& b) const {
-        auto min_feerate = [](const MiniMinerMempoolEntry& e) -> CFeeRate {
-            const CAmount ancestor_fee{e.GetModFeesWithAncestors()};
-            const int64_t ancestor_size{e.GetSizeWithAncestors()};
-            const CAmount tx_fee{e.GetModifiedFee()};
-            const int64_t tx_size{e.GetTxSize()};
-            // Comparing ancestor feerate with individual feerate:
-            //     ancestor_fee / ancestor_size <= tx_fee / tx_size
-            // Avoid division and possible loss of precision by
-            // multiplying both sides by the sizes:
-            return ancestor_fee * tx_size < tx_fee * ancestor_size ?
-                       CFeeRate(ancestor_fee, ancestor_size) :
-                       CFeeRate(tx_fee, tx_size);
-        };
-        CFeeRate a_feerate{min_feerate(a->second)};
-        CFeeRate b_feerate{min_feerate(b->second)};
-        if (a_feerate != b_feerate) {
-            return a_feerate > b_feerate;
-        }
-        // Use txid as tiebreaker for stable sorting
-        return a->first < b->first;
-    }
-};
+    const CAmount ancestor_fee{e.GetModFeesWithAncestors()};
+    const int64_t ancestor_size{e.GetSizeWithAncestors()};
+    const CAmount tx_fee{e.GetModifiedFee()};
+    const int64_t tx_size{e.GetTxSize()};
+    // Comparing ancestor feerate with individual feerate:
+    //     ancestor_fee / ancestor_size <= tx_fee / tx_size
+    // Avoid division and possible loss of precision by
+    // multiplying both sides by the sizes:
+    return ancestor_fee * tx_size < tx_fee * ancestor_size ?
+               CFeeRate(ancestor_fee, ancestor_size) :
+               CFeeRate(tx_fee, tx_size);
+}
 
 void MiniMiner::DeleteAncestorPackage(const std::set<MockEntryMap::iterator, IteratorComparator>& ancestors)
 {
@@ -180,40 +187,45 @@ void MiniMiner::DeleteAncestorPackage(const std::set<MockEntryMap::iterator, Ite
         // respective descendants exactly once.
         Assume(anc->second.GetModFeesWithAncestors() == 0);
         Assume(anc->second.GetSizeWithAncestors() == 0);
-        auto vec_it = std::find(m_entries.begin(), m_entries.end(), anc);
-        Assume(vec_it != m_entries.end());
-        m_entries.erase(vec_it);
         m_entries_by_txid.erase(anc);
     }
 }
 
 void MiniMiner::SanityCheck() const
 {
-    // m_entries, m_entries_by_txid, and m_descendant_set_by_txid all same size
-    Assume(m_entries.size() == m_entries_by_txid.size());
-    Assume(m_entries.size() == m_descendant_set_by_txid.size());
+    // m_entries_by_txid and m_descendant_set_by_txid are the same size
+    Assume(m_entries_by_txid.size() == m_descendant_set_by_txid.size());
     // Cached ancestor values should be at least as large as the transaction's own fee and size
-    Assume(std::all_of(m_entries.begin(), m_entries.end(), [](const auto& entry) {
-        return entry->second.GetSizeWithAncestors() >= entry->second.GetTxSize() &&
-               entry->second.GetModFeesWithAncestors() >= entry->second.GetModifiedFee();}));
+    Assume(std::all_of(m_entries_by_txid.begin(), m_entries_by_txid.end(), [](const auto& entry) {
+        return entry.second.GetSizeWithAncestors() >= entry.second.GetTxSize() &&
+               entry.second.GetModFeesWithAncestors() >= entry.second.GetModifiedFee();}));
     // None of the entries should be to-be-replaced transactions
     Assume(std::all_of(m_to_be_replaced.begin(), m_to_be_replaced.end(),
         [&](const auto& txid){return m_entries_by_txid.find(txid) == m_entries_by_txid.end();}));
 }
 
-void MiniMiner::BuildMockTemplate(const CFeeRate& target_feerate)
+void MiniMiner::SelectPackages(const std::function<bool(CAmount, int64_t)>& include)
 {
-    while (!m_entries_by_txid.empty()) {
-        // Sort again, since transaction removal may change some m_entries' ancestor feerates.
-        std::sort(m_entries.begin(), m_entries.end(), AncestorFeerateComparator());
+    // Candidates by mining score, ties broken by txid for stable results. A transaction's score
+    // only changes when some of its ancestors are mined, at which point it is queued again with
+    // its new score: queued scores that are outdated, or of transactions mined since, are skipped.
+    using Candidate = std::pair<CFeeRate, uint256>;
+    const auto lower_priority = [](const Candidate& a, const Candidate& b) {
+        if (a.first != b.first) return a.first < b.first;
+        return b.second < a.second;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(lower_priority)> candidates{lower_priority};
+    for (const auto& [txid, entry] : m_entries_by_txid) {
+        candidates.emplace(MiningScore(entry), txid);
+    }
 
+    while (!candidates.empty()) {
         // Pick highest ancestor feerate entry.
-        auto best_iter = m_entries.begin();
-        Assume(best_iter != m_entries.end());
-        const auto ancestor_package_size = (*best_iter)->second.GetSizeWithAncestors();
-        const auto ancestor_package_fee = (*best_iter)->second.GetModFeesWithAncestors();
-        // Stop here. Everything that didn't "make it into the block" has bumpfee.
-        if (ancestor_package_fee < target_feerate.GetFee(ancestor_package_size)) {
+        const auto [score, txid] = candidates.top();
+        candidates.pop();
+        const auto best_iter{m_entries_by_txid.find(txid)};
+        if (best_iter == m_entries_by_txid.end() || MiningScore(best_iter->second) != score) continue;
+        if (!include(best_iter->second.GetModFeesWithAncestors(), best_iter->second.GetSizeWithAncestors())) {
             break;
         }
 
@@ -222,7 +234,7 @@ void MiniMiner::BuildMockTemplate(const CFeeRate& target_feerate)
         std::set<MockEntryMap::iterator, IteratorComparator> ancestors;
         {
             std::set<MockEntryMap::iterator, IteratorComparator> to_process;
-            to_process.insert(*best_iter);
+            to_process.insert(best_iter);
             while (!to_process.empty()) {
                 auto iter = to_process.begin();
                 Assume(iter != to_process.end());
@@ -237,14 +249,57 @@ void MiniMiner::BuildMockTemplate(const CFeeRate& target_feerate)
                 to_process.erase(iter);
             }
         }
+        // Mining the package changes the scores of its remaining descendants.
+        std::set<uint256> rescored;
+        for (const auto& anc : ancestors) {
+            for (const auto& descendant : m_descendant_set_by_txid.at(anc->first)) {
+                if (ancestors.count(descendant) == 0) rescored.insert(descendant->first);
+            }
+        }
         DeleteAncestorPackage(ancestors);
-        SanityCheck();
+        for (const auto& desc_txid : rescored) {
+            candidates.emplace(MiningScore(m_entries_by_txid.at(desc_txid)), desc_txid);
+        }
     }
+    SanityCheck();
+}
+
+void MiniMiner::BuildMockTemplate(const CFeeRate& target_feerate)
+{
+    // Stop at the first package below the target feerate. Everything that didn't "make it into the
+    // block" has bumpfee.
+    SelectPackages([&](CAmount package_fee, int64_t package_vsize) {
+        return package_fee >= target_feerate.GetFee(package_vsize);
+    });
     Assume(m_in_block.empty() || m_total_fees >= target_feerate.GetFee(m_total_vsize));
     // Do not try to continue building the block template with a different feerate.
     m_ready_to_calculate = false;
 }
 
+std::vector<MiniMiner::MockBlock> MiniMiner::BuildMockBlocks(int64_t block_vsize, size_t num_blocks)
+{
+    std::vector<MockBlock> blocks;
+    if (!m_ready_to_calculate || num_blocks == 0) return blocks;
+    blocks.emplace_back();
+    SelectPackages([&](CAmount package_fee, int64_t package_vsize) {
+        if (blocks.back().vsize > 0 && blocks.back().vsize + package_vsize > block_vsize) {
+            // The package does not fit: the block is full and it starts the next one.
+            blocks.back().full = true;
+            if (blocks.size() == num_blocks) return false;
+            blocks.emplace_back();
+        }
+        MockBlock& block{blocks.back()};
+        const CFeeRate package_feerate{package_fee, static_cast<uint32_t>(package_vsize)};
+        if (block.vsize == 0 || package_feerate < block.min_feerate) block.min_feerate = package_feerate;
+        block.vsize += package_vsize;
+        block.fees += package_fee;
+        return true;
+    });
+    if (blocks.back().vsize == 0) blocks.pop_back();
+    m_ready_to_calculate = false;
+    return blocks;
+}
+
 std::map<COutPoint, CAmount> MiniMiner::CalculateBumpFees(const CFeeRate& target_feerate)
 {
     if (!m_ready_to_calculate) return {};
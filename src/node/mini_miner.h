@@ -7,9 +7,11 @@
 
 #include <txmempool.h>
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <stdint.h>
+#include <vector>
 
 namespace node {
 
@@ -86,9 +88,6 @@ class MiniMiner
     std::map<uint256, MiniMinerMempoolEntry> m_entries_by_txid;
     using MockEntryMap = decltype(m_entries_by_txid);
 
-    /** Vector of entries, can be sorted by ancestor feerate. */
-    std::vector<MockEntryMap::iterator> m_entries;
-
     /** Map of txid to its descendants. Should be inclusive. */
     std::map<uint256, std::vector<MockEntryMap::iterator>> m_descendant_set_by_txid;
 
@@ -98,6 +97,10 @@ class MiniMiner
     /** Perform some checks. */
     void SanityCheck() const;
 
+    /** Move ancestor packages into the block in the order the mining algorithm picks them, for as
+     * long as include, given each package's fee and vsize, accepts them. */
+    void SelectPackages(const std::function<bool(CAmount package_fee, int64_t package_vsize)>& include);
+
 public:
     /** Returns true if CalculateBumpFees may be called, false if not. */
     bool IsReadyToCalculate() const { return m_ready_to_calculate; }
@@ -110,6 +113,24 @@ public:
 
     MiniMiner(const CTxMemPool& mempool, const std::vector<COutPoint>& outpoints);
 
+    /** Load the entire mempool, to simulate the next blocks with BuildMockBlocks(). */
+    explicit MiniMiner(const CTxMemPool& mempool);
+
+    /** A simulated block. */
+    struct MockBlock {
+        /** Lowest feerate of the ancestor packages included. */
+        CFeeRate min_feerate;
+        int64_t vsize{0};
+        CAmount fees{0};
+        /** Whether the next package did not fit, so including a transaction takes at least min_feerate. */
+        bool full{false};
+    };
+
+    /** Fill up to num_blocks consecutive blocks of block_vsize each with ancestor packages, in the
+     * order the mining algorithm picks them. Fewer blocks are returned if the transactions run out,
+     * the last one of them not full. */
+    std::vector<MockBlock> BuildMockBlocks(int64_t block_vsize, size_t num_blocks);
+
     /** Construct a new block template and, for each outpoint corresponding to a transaction that
      * did not make it into the block, calculate the cost of bumping those transactions (and their
      * ancestors) to the minimum feerate. Returns a map from outpoint to bump fee, or an empty map
@@ -44,6 +44,7 @@ TransactionError BroadcastTransaction(NodeContext& node, const CTransactionRef t
     uint256 wtxid = tx->GetWitnessHash();
     bool callback_set = false;
 
+    bool in_mempool{false};
     {
         LOCK(cs_main);
 
@@ -66,48 +67,52 @@ TransactionError BroadcastTransaction(NodeContext& node, const CTransactionRef t
             // The mempool transaction may have the same or different witness (and
             // wtxid) as this transaction. Use the mempool's wtxid for reannouncement.
             wtxid = mempool_tx->GetWitnessHash();
-        } else {
-            // Transaction is not already in the mempool.
-            if (max_tx_fee > 0) {
-                // First, call ATMP with test_accept and check the fee. If ATMP
-                // fails here, return error immediately.
-                const MempoolAcceptResult result = node.chainman->ProcessTransaction(tx, /*test_accept=*/ true);
-                if (result.m_result_type != MempoolAcceptResult::ResultType::VALID) {
-                    return HandleATMPError(result.m_state, err_string);
-                } else if (result.m_base_fees.value() > max_tx_fee) {
-                    return TransactionError::MAX_FEE_EXCEEDED;
-                }
-            }
-            // Try to submit the transaction to the mempool.
-            const MempoolAcceptResult result = node.chainman->ProcessTransaction(tx, /*test_accept=*/ false);
+            in_mempool = true;
+        }
+    } // cs_main
+
+    if (!in_mempool) {
+        // Transaction is not already in the mempool. Submit it without holding cs_main, so that
+        // its scripts are verified while other RPC threads and peers make progress.
+        if (max_tx_fee > 0) {
+            // First, call ATMP with test_accept and check the fee. If ATMP
+            // fails here, return error immediately.
+            const MempoolAcceptResult result = node.chainman->ProcessTransactionConcurrent(tx, /*test_accept=*/ true);
             if (result.m_result_type != MempoolAcceptResult::ResultType::VALID) {
                 return HandleATMPError(result.m_state, err_string);
+            } else if (result.m_base_fees.value() > max_tx_fee) {
+                return TransactionError::MAX_FEE_EXCEEDED;
             }
+        }
+        // Try to submit the transaction to the mempool.
+        const MempoolAcceptResult result = node.chainman->ProcessTransactionConcurrent(tx, /*test_accept=*/ false);
+        if (result.m_result_type != MempoolAcceptResult::ResultType::VALID) {
+            return HandleATMPError(result.m_state, err_string);
+        }
 
-            // Transaction was accepted to the mempool.
+        // Transaction was accepted to the mempool.
 
-            if (relay) {
-                // the mempool tracks locally submitted transactions to make a
-                // best-effort of initial broadcast
-                node.mempool->AddUnbroadcastTx(txid);
-            }
+        if (relay) {
+            // the mempool tracks locally submitted transactions to make a
+            // best-effort of initial broadcast
+            node.mempool->AddUnbroadcastTx(txid);
+        }
 
-            if (wait_callback) {
-                // For transactions broadcast from outside the wallet, make sure
-                // that the wallet has been notified of the transaction before
-                // continuing.
-                //
-                // This prevents a race where a user might call sendrawtransaction
-                // with a transaction to/from their wallet, immediately call some
-                // wallet RPC, and get a stale result because callbacks have not
-                // yet been processed.
-                CallFunctionInValidationInterfaceQueue([&promise] {
-                    promise.set_value();
-                });
-                callback_set = true;
-            }
+        if (wait_callback) {
+            // For transactions broadcast from outside the wallet, make sure
+            // that the wallet has been notified of the transaction before
+            // continuing.
+            //
+            // This prevents a race where a user might call sendrawtransaction
+            // with a transaction to/from their wallet, immediately call some
+            // wallet RPC, and get a stale result because callbacks have not
+            // yet been processed.
+            CallFunctionInValidationInterfaceQueue([&promise] {
+                promise.set_value();
+            });
+            callback_set = true;
         }
-    } // cs_main
+    }
 
     if (callback_set) {
         // Wait until Validation Interface clients have been notified of the
@@ -122,6 +127,39 @@ TransactionError BroadcastTransaction(NodeContext& node, const CTransactionRef t
     return TransactionError::OK;
 }
 
+std::vector<MempoolAcceptResult> BroadcastTransactions(NodeContext& node, const std::vector<CTransactionRef>& txs, const CFeeRate& max_tx_feerate, bool relay)
+{
+    assert(node.chainman);
+    assert(node.mempool);
+    assert(node.peerman);
+
+    const std::optional<CFeeRate> client_maxfeerate{max_tx_feerate == CFeeRate(0) ? std::nullopt : std::optional{max_tx_feerate}};
+    const std::vector<MempoolAcceptResult> results{WITH_LOCK(cs_main, return node.chainman->ProcessTransactionBatch(txs, /*test_accept=*/false, client_maxfeerate))};
+
+    bool any_accepted{false};
+    for (size_t i = 0; i < txs.size(); ++i) {
+        if (results[i].m_result_type != MempoolAcceptResult::ResultType::VALID) continue;
+        any_accepted = true;
+        if (relay) node.mempool->AddUnbroadcastTx(txs[i]->GetHash());
+    }
+    if (any_accepted) {
+        // Like BroadcastTransaction() with wait_callback, so that wallets have seen the
+        // transactions before the caller continues.
+        std::promise<void> promise;
+        CallFunctionInValidationInterfaceQueue([&promise] {
+            promise.set_value();
+        });
+        promise.get_future().wait();
+    }
+    if (relay) {
+        for (size_t i = 0; i < txs.size(); ++i) {
+            if (results[i].m_result_type != MempoolAcceptResult::ResultType::VALID) continue;
+            node.peerman->RelayTransaction(txs[i]->GetHash(), txs[i]->GetWitnessHash());
+        }
+    }
+    return results;
+}
+
 CTransactionRef GetTransaction(const CBlockIndex* const block_index, const CTxMemPool* const mempool, const uint256& hash, uint256& hashBlock, const BlockManager& blockman)
 {
     if (mempool && !block_index) {
@@ -9,8 +9,11 @@
 #include <primitives/transaction.h>
 #include <util/error.h>
 
+#include <vector>
+
 class CBlockIndex;
 class CTxMemPool;
+struct MempoolAcceptResult;
 namespace Consensus {
 struct Params;
 }
@@ -45,6 +48,24 @@ static const CFeeRate DEFAULT_MAX_RAW_TX_FEE_RATE{COIN / 10};
  */
 [[nodiscard]] TransactionError BroadcastTransaction(NodeContext& node, CTransactionRef tx, std::string& err_string, const CAmount& max_tx_fee, bool relay, bool wait_callback);
 
+/** Maximum number of transactions submitted at once through the sendrawtransactions RPC and the
+ * corresponding REST endpoint. */
+static constexpr size_t MAX_BROADCAST_BATCH_SIZE{10000};
+
+/**
+ * Submit a batch of transactions to the mempool under a single cs_main hold and relay the accepted
+ * ones to all P2P peers. See ChainstateManager::ProcessTransactionBatch(). Waits until validation
+ * interface clients have been notified of the accepted transactions, so the same locking
+ * restrictions as for BroadcastTransaction() with wait_callback apply.
+ *
+ * @param[in]  node reference to node context
+ * @param[in]  txs the transactions to broadcast, parents before children
+ * @param[in]  max_tx_feerate reject txs with a feerate higher than this (if 0, accept any feerate)
+ * @param[in]  relay flag if p2p relay of the accepted transactions is requested
+ * @returns one result per transaction, in the order given
+ */
+[[nodiscard]] std::vector<MempoolAcceptResult> BroadcastTransactions(NodeContext& node, const std::vector<CTransactionRef>& txs, const CFeeRate& max_tx_feerate, bool relay);
+
 /**
  * Return transaction with a given hash.
  * If mempool is provided and block_index is not provided, check it first for the tx.
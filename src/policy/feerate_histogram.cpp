@@ -0,0 +1,45 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <policy/feerate_histogram.h>
+
+#include <policy/feerate.h>
+#include <util/check.h>
+
+#include <algorithm>
+#include <cmath>
+
+const std::vector<CAmount>& FeerateHistogram::BucketFeerates()
+{
+    static const std::vector<CAmount> bucket_feerates{[] {
+        std::vector<CAmount> feerates{0};
+        for (double feerate = MIN_BUCKET_FEERATE; feerate <= MAX_BUCKET_FEERATE; feerate *= BUCKET_SPACING) {
+            feerates.push_back(std::llround(feerate));
+        }
+        return feerates;
+    }()};
+    return bucket_feerates;
+}
+
+size_t FeerateHistogram::BucketIndex(CAmount fee, int32_t vsize)
+{
+    const std::vector<CAmount>& feerates{BucketFeerates()};
+    // Negative modified fees count as zero.
+    const CAmount feerate{std::max<CAmount>(0, CFeeRate(fee, vsize).GetFeePerK())};
+    return std::upper_bound(feerates.begin(), feerates.end(), feerate) - feerates.begin() - 1;
+}
+
+void FeerateHistogram::Add(CAmount fee, int32_t vsize)
+{
+    m_vsize[BucketIndex(fee, vsize)] += vsize;
+    m_total_vsize += vsize;
+}
+
+void FeerateHistogram::Remove(CAmount fee, int32_t vsize)
+{
+    uint64_t& bucket{m_vsize[BucketIndex(fee, vsize)]};
+    Assume(bucket >= uint64_t(vsize));
+    bucket -= vsize;
+    m_total_vsize -= vsize;
+}
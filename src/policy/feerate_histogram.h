@@ -0,0 +1,49 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_POLICY_FEERATE_HISTOGRAM_H
+#define BITCOIN_POLICY_FEERATE_HISTOGRAM_H
+
+#include <consensus/amount.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Virtual size of a set of transactions by feerate, kept up to date as transactions are added and
+ * removed. Buckets are spaced geometrically, each starting 10% above the previous one, from
+ * MIN_BUCKET_FEERATE up to MAX_BUCKET_FEERATE, with one more bucket for everything below.
+ */
+class FeerateHistogram
+{
+public:
+    /** Lower bound of the first non-zero bucket, in sat/kvB. */
+    static constexpr CAmount MIN_BUCKET_FEERATE{1000};
+    /** Higher feerates all go into the last bucket, in sat/kvB. */
+    static constexpr CAmount MAX_BUCKET_FEERATE{10'000'000};
+    static constexpr double BUCKET_SPACING{1.1};
+
+    /** Lower bounds of the buckets in sat/kvB, ascending, starting at 0. */
+    static const std::vector<CAmount>& BucketFeerates();
+
+    FeerateHistogram() : m_vsize(BucketFeerates().size(), 0) {}
+
+    void Add(CAmount fee, int32_t vsize);
+    void Remove(CAmount fee, int32_t vsize);
+
+    /** Virtual size in each bucket, indexed like BucketFeerates(). */
+    const std::vector<uint64_t>& GetBucketVsizes() const { return m_vsize; }
+    uint64_t GetTotalVsize() const { return m_total_vsize; }
+
+    bool operator==(const FeerateHistogram& other) const { return m_vsize == other.m_vsize; }
+
+private:
+    std::vector<uint64_t> m_vsize;
+    uint64_t m_total_vsize{0};
+
+    static size_t BucketIndex(CAmount fee, int32_t vsize);
+};
+
+#endif // BITCOIN_POLICY_FEERATE_HISTOGRAM_H
@@ -8,6 +8,7 @@
 #include <clientversion.h>
 #include <common/system.h>
 #include <consensus/amount.h>
+#include <consensus/params.h>
 #include <kernel/mempool_entry.h>
 #include <logging.h>
 #include <policy/feerate.h>
@@ -20,6 +21,7 @@
 #include <uint256.h>
 #include <util/fs.h>
 #include <util/serfloat.h>
+#include <util/thread.h>
 #include <util/time.h>
 
 #include <algorithm>
@@ -44,6 +46,11 @@ std::string StringForFeeEstimateHorizon(FeeEstimateHorizon horizon)
     assert(false);
 }
 
+std::chrono::seconds FeeEstimateTargetSpacing(const Consensus::Params& params)
+{
+    return std::chrono::seconds{params.btcbt_block_interval > 0 ? params.btcbt_block_interval : params.nPowTargetSpacing};
+}
+
 namespace {
 
 struct EncodedDoubleFormatter
@@ -167,8 +174,9 @@ public:
     /**
      * Read saved state of estimation data from a file and replace all internal data structures and
      * variables with this state.
+     * @param max_confirms the most confirms the file may track, the span of the long horizon
      */
-    void Read(AutoFile& filein, int nFileVersion, size_t numBuckets);
+    void Read(AutoFile& filein, int nFileVersion, size_t numBuckets, unsigned int max_confirms);
 };
 
 
@@ -401,7 +409,7 @@ void TxConfirmStats::Write(AutoFile& fileout) const
     fileout << Using<VectorFormatter<VectorFormatter<EncodedDoubleFormatter>>>(failAvg);
 }
 
-void TxConfirmStats::Read(AutoFile& filein, int nFileVersion, size_t numBuckets)
+void TxConfirmStats::Read(AutoFile& filein, int nFileVersion, size_t numBuckets, unsigned int max_confirms)
 {
     // Read data file and do some very basic sanity checking
     // buckets and bucketMap are not updated yet, so don't access them
@@ -430,8 +438,8 @@ void TxConfirmStats::Read(AutoFile& filein, int nFileVersion, size_t numBuckets)
     maxPeriods = confAvg.size();
     maxConfirms = scale * maxPeriods;
 
-    if (maxConfirms <= 0 || maxConfirms > 6 * 24 * 7) { // one week
-        throw std::runtime_error("Corrupt estimates file.  Must maintain estimates for between 1 and 1008 (one week) confirms");
+    if (maxConfirms <= 0 || maxConfirms > max_confirms) {
+        throw std::runtime_error(strprintf("Corrupt estimates file.  Must maintain estimates for between 1 and %u (one week) confirms", max_confirms));
     }
     for (unsigned int i = 0; i < maxPeriods; i++) {
         if (confAvg[i].size() != numBuckets) {
@@ -507,10 +515,60 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
 // tracked. Txs that were part of a block have already been removed in
 // processBlockTx to ensure they are never double tracked, but it is
 // of no harm to try to remove them again.
-bool CBlockPolicyEstimator::removeTx(uint256 hash, bool inBlock)
+void CBlockPolicyEstimator::removeTx(uint256 hash, bool inBlock)
 {
-    LOCK(m_cs_fee_estimator);
-    return _removeTx(hash, inBlock);
+    QueueEvent(new MempoolEvent{.hash = hash, .added = false, .in_block = inBlock, .valid_fee_estimate = false, .height = 0, .fee_per_k = 0});
+}
+
+void CBlockPolicyEstimator::QueueEvent(MempoolEvent* event)
+{
+    event->next = m_queued_events.load(std::memory_order_relaxed);
+    while (!m_queued_events.compare_exchange_weak(event->next, event, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+void CBlockPolicyEstimator::ProcessQueuedEvents()
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    MempoolEvent* event{m_queued_events.exchange(nullptr, std::memory_order_acquire)};
+    // The list is most recent first: reverse it to apply the events in order.
+    MempoolEvent* ordered{nullptr};
+    while (event) {
+        MempoolEvent* next{event->next};
+        event->next = ordered;
+        ordered = event;
+        event = next;
+    }
+    while (ordered) {
+        const std::unique_ptr<MempoolEvent> current{ordered};
+        ordered = current->next;
+        if (current->added) {
+            _processTransaction(*current);
+        } else {
+            _removeTx(current->hash, current->in_block);
+        }
+    }
+}
+
+void CBlockPolicyEstimator::ThreadProcessQueue()
+{
+    while (m_queue_interrupt.sleep_for(FEE_QUEUE_PROCESS_INTERVAL)) {
+        LOCK(m_cs_fee_estimator);
+        ProcessQueuedEvents();
+    }
+}
+
+void CBlockPolicyEstimator::StartBackgroundProcessing()
+{
+    assert(!m_queue_thread.joinable());
+    m_queue_interrupt.reset();
+    m_queue_thread = std::thread(&util::TraceThread, "feeest", [this] { ThreadProcessQueue(); });
+}
+
+void CBlockPolicyEstimator::StopBackgroundProcessing()
+{
+    if (!m_queue_thread.joinable()) return;
+    m_queue_interrupt();
+    m_queue_thread.join();
 }
 
 bool CBlockPolicyEstimator::_removeTx(const uint256& hash, bool inBlock)
@@ -528,23 +586,48 @@ bool CBlockPolicyEstimator::_removeTx(const uint256& hash, bool inBlock)
     }
 }
 
-CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath, const bool read_stale_estimates)
-    : m_estimation_filepath{estimation_filepath}
+/** Number of blocks at target_spacing spanning the time of count blocks at the reference spacing. */
+static unsigned int ScaleBlocks(unsigned int count, std::chrono::seconds reference_spacing, std::chrono::seconds target_spacing)
+{
+    return std::max<unsigned int>(1, std::ceil(double(count) * count_seconds(reference_spacing) / count_seconds(target_spacing)));
+}
+
+/** Per block decay at target_spacing with the same half-life in time as decay at the reference spacing. */
+static double ScaleDecay(double decay, std::chrono::seconds reference_spacing, std::chrono::seconds target_spacing)
+{
+    return std::pow(decay, double(count_seconds(target_spacing)) / count_seconds(reference_spacing));
+}
+
+CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath, const bool read_stale_estimates,
+                                             std::chrono::seconds target_spacing)
+    : m_estimation_filepath{estimation_filepath},
+      m_target_spacing{target_spacing},
+      m_short_horizon{ScaleBlocks(SHORT_BLOCK_PERIODS, REFERENCE_TARGET_SPACING, target_spacing),
+                      ScaleDecay(SHORT_DECAY, REFERENCE_TARGET_SPACING, target_spacing), SHORT_SCALE},
+      m_med_horizon{ScaleBlocks(MED_BLOCK_PERIODS, REFERENCE_TARGET_SPACING, target_spacing),
+                    ScaleDecay(MED_DECAY, REFERENCE_TARGET_SPACING, target_spacing), MED_SCALE},
+      m_long_horizon{ScaleBlocks(LONG_BLOCK_PERIODS, REFERENCE_TARGET_SPACING, target_spacing),
+                     ScaleDecay(LONG_DECAY, REFERENCE_TARGET_SPACING, target_spacing), LONG_SCALE},
+      m_oldest_estimate_history{ScaleBlocks(OLDEST_ESTIMATE_HISTORY, REFERENCE_TARGET_SPACING, target_spacing)}
 {
     static_assert(MIN_BUCKET_FEERATE > 0, "Min feerate must be nonzero");
-    size_t bucketIndex = 0;
+    assert(target_spacing > std::chrono::seconds::zero());
+    {
+        LOCK(m_cs_fee_estimator);
+        size_t bucketIndex = 0;
 
-    for (double bucketBoundary = MIN_BUCKET_FEERATE; bucketBoundary <= MAX_BUCKET_FEERATE; bucketBoundary *= FEE_SPACING, bucketIndex++) {
-        buckets.push_back(bucketBoundary);
-        bucketMap[bucketBoundary] = bucketIndex;
-    }
-    buckets.push_back(INF_FEERATE);
-    bucketMap[INF_FEERATE] = bucketIndex;
-    assert(bucketMap.size() == buckets.size());
+        for (double bucketBoundary = MIN_BUCKET_FEERATE; bucketBoundary <= MAX_BUCKET_FEERATE; bucketBoundary *= FEE_SPACING, bucketIndex++) {
+            buckets.push_back(bucketBoundary);
+            bucketMap[bucketBoundary] = bucketIndex;
+        }
+        buckets.push_back(INF_FEERATE);
+        bucketMap[INF_FEERATE] = bucketIndex;
+        assert(bucketMap.size() == buckets.size());
 
-    feeStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
-    shortStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
-    longStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
+        feeStats = MakeStats(m_med_horizon);
+        shortStats = MakeStats(m_short_horizon);
+        longStats = MakeStats(m_long_horizon);
+    }
 
     AutoFile est_file{fsbridge::fopen(m_estimation_filepath, "rb")};
 
@@ -564,13 +647,35 @@ CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath
     }
 }
 
-CBlockPolicyEstimator::~CBlockPolicyEstimator() = default;
+CBlockPolicyEstimator::~CBlockPolicyEstimator()
+{
+    StopBackgroundProcessing();
+    MempoolEvent* event{m_queued_events.exchange(nullptr)};
+    while (event) {
+        const std::unique_ptr<MempoolEvent> current{event};
+        event = current->next;
+    }
+}
+
+std::unique_ptr<TxConfirmStats> CBlockPolicyEstimator::MakeStats(const HorizonParams& horizon) const
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    return std::make_unique<TxConfirmStats>(buckets, bucketMap, horizon.periods, horizon.decay, horizon.scale);
+}
 
 void CBlockPolicyEstimator::processTransaction(const CTxMemPoolEntry& entry, bool validFeeEstimate)
 {
-    LOCK(m_cs_fee_estimator);
-    unsigned int txHeight = entry.GetHeight();
-    uint256 hash = entry.GetTx().GetHash();
+    // Feerates are stored and reported as BTC-per-kb:
+    const CFeeRate feeRate(entry.GetFee(), entry.GetTxSize());
+    QueueEvent(new MempoolEvent{.hash = entry.GetTx().GetHash(), .added = true, .in_block = false, .valid_fee_estimate = validFeeEstimate,
+                                .height = entry.GetHeight(), .fee_per_k = feeRate.GetFeePerK()});
+}
+
+void CBlockPolicyEstimator::_processTransaction(const MempoolEvent& event)
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    unsigned int txHeight = event.height;
+    const uint256& hash = event.hash;
     if (mapMemPoolTxs.count(hash)) {
         LogPrint(BCLog::ESTIMATEFEE, "Blockpolicy error mempool tx %s already being tracked\n",
                  hash.ToString());
@@ -587,21 +692,18 @@ void CBlockPolicyEstimator::processTransaction(const CTxMemPoolEntry& entry, boo
 
     // Only want to be updating estimates when our blockchain is synced,
     // otherwise we'll miscalculate how many blocks its taking to get included.
-    if (!validFeeEstimate) {
+    if (!event.valid_fee_estimate) {
         untrackedTxs++;
         return;
     }
     trackedTxs++;
 
-    // Feerates are stored and reported as BTC-per-kb:
-    CFeeRate feeRate(entry.GetFee(), entry.GetTxSize());
-
     mapMemPoolTxs[hash].blockHeight = txHeight;
-    unsigned int bucketIndex = feeStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
+    unsigned int bucketIndex = feeStats->NewTx(txHeight, (double)event.fee_per_k);
     mapMemPoolTxs[hash].bucketIndex = bucketIndex;
-    unsigned int bucketIndex2 = shortStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
+    unsigned int bucketIndex2 = shortStats->NewTx(txHeight, (double)event.fee_per_k);
     assert(bucketIndex == bucketIndex2);
-    unsigned int bucketIndex3 = longStats->NewTx(txHeight, (double)feeRate.GetFeePerK());
+    unsigned int bucketIndex3 = longStats->NewTx(txHeight, (double)event.fee_per_k);
     assert(bucketIndex == bucketIndex3);
 }
 
@@ -637,6 +739,8 @@ void CBlockPolicyEstimator::processBlock(unsigned int nBlockHeight,
                                          std::vector<const CTxMemPoolEntry*>& entries)
 {
     LOCK(m_cs_fee_estimator);
+    // Apply the mempool events that preceded this block at the height they were seen at.
+    ProcessQueuedEvents();
     if (nBlockHeight <= nBestSeenHeight) {
         // Ignore side chains and re-orgs; assuming they are random
         // they don't affect the estimate.
@@ -757,7 +861,7 @@ unsigned int CBlockPolicyEstimator::HistoricalBlockSpan() const
     if (historicalFirst == 0) return 0;
     assert(historicalBest >= historicalFirst);
 
-    if (nBestSeenHeight - historicalBest > OLDEST_ESTIMATE_HISTORY) return 0;
+    if (nBestSeenHeight - historicalBest > m_oldest_estimate_history) return 0;
 
     return historicalBest - historicalFirst;
 }
@@ -932,8 +1036,9 @@ bool CBlockPolicyEstimator::Write(AutoFile& fileout) const
 {
     try {
         LOCK(m_cs_fee_estimator);
-        fileout << 149900; // version required to read: 0.14.99 or later
+        fileout << CURRENT_FEES_FILE_VERSION; // version required to read
         fileout << CLIENT_VERSION; // version that wrote the file
+        fileout << int64_t{count_seconds(m_target_spacing)};
         fileout << nBestSeenHeight;
         if (BlockSpan() > HistoricalBlockSpan()/2) {
             fileout << firstRecordedHeight << nBestSeenHeight;
@@ -957,18 +1062,29 @@ bool CBlockPolicyEstimator::Read(AutoFile& filein)
 {
     try {
         LOCK(m_cs_fee_estimator);
+        ProcessQueuedEvents();
         int nVersionRequired, nVersionThatWrote;
         filein >> nVersionRequired >> nVersionThatWrote;
-        if (nVersionRequired > CLIENT_VERSION) {
+        if (nVersionRequired > CURRENT_FEES_FILE_VERSION) {
             throw std::runtime_error(strprintf("up-version (%d) fee estimate file", nVersionRequired));
         }
 
+        // Estimates collected at another block spacing track a different number of blocks per
+        // horizon and decay at a different rate per block, so cannot be used.
+        int64_t file_target_spacing{count_seconds(REFERENCE_TARGET_SPACING)};
+        if (nVersionRequired >= CURRENT_FEES_FILE_VERSION) {
+            filein >> file_target_spacing;
+        }
+        if (file_target_spacing != count_seconds(m_target_spacing)) {
+            throw std::runtime_error(strprintf("fee estimate file is for %d second blocks, not %d", file_target_spacing, count_seconds(m_target_spacing)));
+        }
+
         // Read fee estimates file into temporary variables so existing data
         // structures aren't corrupted if there is an exception.
         unsigned int nFileBestSeenHeight;
         filein >> nFileBestSeenHeight;
 
-        if (nVersionRequired < 149900) {
+        if (nVersionRequired < FEES_FILE_VERSION_NO_SPACING) {
             LogPrintf("%s: incompatible old fee estimation data (non-fatal). Version: %d\n", __func__, nVersionRequired);
         } else { // New format introduced in 149900
             unsigned int nFileHistoricalFirst, nFileHistoricalBest;
@@ -983,12 +1099,13 @@ bool CBlockPolicyEstimator::Read(AutoFile& filein)
                 throw std::runtime_error("Corrupt estimates file. Must have between 2 and 1000 feerate buckets");
             }
 
-            std::unique_ptr<TxConfirmStats> fileFeeStats(new TxConfirmStats(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
-            std::unique_ptr<TxConfirmStats> fileShortStats(new TxConfirmStats(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
-            std::unique_ptr<TxConfirmStats> fileLongStats(new TxConfirmStats(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
-            fileFeeStats->Read(filein, nVersionThatWrote, numBuckets);
-            fileShortStats->Read(filein, nVersionThatWrote, numBuckets);
-            fileLongStats->Read(filein, nVersionThatWrote, numBuckets);
+            std::unique_ptr<TxConfirmStats> fileFeeStats{MakeStats(m_med_horizon)};
+            std::unique_ptr<TxConfirmStats> fileShortStats{MakeStats(m_short_horizon)};
+            std::unique_ptr<TxConfirmStats> fileLongStats{MakeStats(m_long_horizon)};
+            const unsigned int max_confirms{m_long_horizon.periods * m_long_horizon.scale};
+            fileFeeStats->Read(filein, nVersionThatWrote, numBuckets, max_confirms);
+            fileShortStats->Read(filein, nVersionThatWrote, numBuckets, max_confirms);
+            fileLongStats->Read(filein, nVersionThatWrote, numBuckets, max_confirms);
 
             // Fee estimates file parsed correctly
             // Copy buckets from file and refresh our bucketmap
@@ -1019,6 +1136,7 @@ void CBlockPolicyEstimator::FlushUnconfirmed()
 {
     const auto startclear{SteadyClock::now()};
     LOCK(m_cs_fee_estimator);
+    ProcessQueuedEvents();
     size_t num_entries = mapMemPoolTxs.size();
     // Remove every entry in mapMemPoolTxs
     while (!mapMemPoolTxs.empty()) {
@@ -12,13 +12,16 @@
 #include <threadsafety.h>
 #include <uint256.h>
 #include <util/fs.h>
+#include <util/threadinterrupt.h>
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -34,9 +37,20 @@ static constexpr std::chrono::hours MAX_FILE_AGE{60};
 // Whether we allow importing a fee_estimates file older than MAX_FILE_AGE.
 static constexpr bool DEFAULT_ACCEPT_STALE_FEE_ESTIMATES{false};
 
+/** Format of fee_estimates.dat before the block spacing was recorded in it, implying 10 minute blocks. */
+static constexpr int FEES_FILE_VERSION_NO_SPACING{149900};
+/** Current format of fee_estimates.dat, which records the block spacing the estimates were collected at. */
+static constexpr int CURRENT_FEES_FILE_VERSION{300100};
+
+// How often mempool events queued for the fee estimator are applied in the background.
+static constexpr std::chrono::milliseconds FEE_QUEUE_PROCESS_INTERVAL{100};
+
 class AutoFile;
 class CTxMemPoolEntry;
 class TxConfirmStats;
+namespace Consensus {
+struct Params;
+} // namespace Consensus
 
 /* Identifier for each of the 3 different TxConfirmStats which will track
  * history over different time horizons. */
@@ -54,6 +68,9 @@ static constexpr auto ALL_FEE_ESTIMATE_HORIZONS = std::array{
 
 std::string StringForFeeEstimateHorizon(FeeEstimateHorizon horizon);
 
+/** Spacing of the blocks fee estimates are made for: the post-fork block interval, where the chain has one. */
+std::chrono::seconds FeeEstimateTargetSpacing(const Consensus::Params& params);
+
 /* Enumeration of reason for returned fee estimate */
 enum class FeeReason {
     NONE,
@@ -146,6 +163,10 @@ struct FeeCalculation
 class CBlockPolicyEstimator
 {
 private:
+    /** Block spacing the horizons and decays below are given for. Estimators for chains with
+     * another spacing track proportionally more or fewer blocks, covering the same time spans. */
+    static constexpr std::chrono::seconds REFERENCE_TARGET_SPACING{600};
+
     /** Track confirm delays up to 12 blocks for short horizon */
     static constexpr unsigned int SHORT_BLOCK_PERIODS = 12;
     static constexpr unsigned int SHORT_SCALE = 1;
@@ -195,23 +216,43 @@ private:
     static constexpr double FEE_SPACING = 1.05;
 
     const fs::path m_estimation_filepath;
+
+    /** Periods, decay and scale of one of the TxConfirmStats, adjusted to the block spacing. */
+    struct HorizonParams {
+        unsigned int periods;
+        double decay;
+        unsigned int scale;
+    };
+
+    const std::chrono::seconds m_target_spacing;
+    const HorizonParams m_short_horizon;
+    const HorizonParams m_med_horizon;
+    const HorizonParams m_long_horizon;
+    const unsigned int m_oldest_estimate_history;
+
 public:
-    /** Create new BlockPolicyEstimator and initialize stats tracking classes with default values */
-    CBlockPolicyEstimator(const fs::path& estimation_filepath, const bool read_stale_estimates);
+    /** Create new BlockPolicyEstimator and initialize stats tracking classes with default values
+     * for blocks mined every target_spacing */
+    CBlockPolicyEstimator(const fs::path& estimation_filepath, const bool read_stale_estimates,
+                          std::chrono::seconds target_spacing = REFERENCE_TARGET_SPACING);
     ~CBlockPolicyEstimator();
 
+    /** Start applying queued mempool events on a background thread. Without it, they are only
+     * applied when the next block is processed or the estimates are flushed. */
+    void StartBackgroundProcessing();
+    /** Stop the background thread, if running. Queued events remain queued. */
+    void StopBackgroundProcessing();
+
     /** Process all the transactions that have been included in a block */
     void processBlock(unsigned int nBlockHeight,
                       std::vector<const CTxMemPoolEntry*>& entries)
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
 
-    /** Process a transaction accepted to the mempool*/
-    void processTransaction(const CTxMemPoolEntry& entry, bool validFeeEstimate)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+    /** Queue a transaction accepted to the mempool for processing. Does not take m_cs_fee_estimator. */
+    void processTransaction(const CTxMemPoolEntry& entry, bool validFeeEstimate);
 
-    /** Remove a transaction from the mempool tracking stats*/
-    bool removeTx(uint256 hash, bool inBlock)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+    /** Queue the removal of a transaction from the mempool tracking stats. Does not take m_cs_fee_estimator. */
+    void removeTx(uint256 hash, bool inBlock);
 
     /** DEPRECATED. Return a feerate estimate */
     CFeeRate estimateFee(int confTarget) const
@@ -263,6 +304,29 @@ public:
 private:
     mutable Mutex m_cs_fee_estimator;
 
+    /** A mempool addition or removal, queued by the mempool without taking m_cs_fee_estimator. */
+    struct MempoolEvent {
+        uint256 hash;
+        bool added;
+        bool in_block;
+        bool valid_fee_estimate;
+        unsigned int height;
+        CAmount fee_per_k;
+        MempoolEvent* next{nullptr};
+    };
+
+    /** Events not yet applied, most recent first. Producers push with a compare-and-swap, and the
+     * consumer, holding m_cs_fee_estimator, takes the whole list at once. */
+    std::atomic<MempoolEvent*> m_queued_events{nullptr};
+
+    std::thread m_queue_thread;
+    CThreadInterrupt m_queue_interrupt;
+
+    void QueueEvent(MempoolEvent* event);
+    /** Apply the queued events in the order they were queued. */
+    void ProcessQueuedEvents() EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+    void ThreadProcessQueue() EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+
     unsigned int nBestSeenHeight GUARDED_BY(m_cs_fee_estimator){0};
     unsigned int firstRecordedHeight GUARDED_BY(m_cs_fee_estimator){0};
     unsigned int historicalFirst GUARDED_BY(m_cs_fee_estimator){0};
@@ -289,6 +353,12 @@ private:
     std::vector<double> buckets GUARDED_BY(m_cs_fee_estimator); // The upper-bound of the range for the bucket (inclusive)
     std::map<double, unsigned int> bucketMap GUARDED_BY(m_cs_fee_estimator); // Map of bucket upper-bound to index into all vectors by bucket
 
+    /** Build a TxConfirmStats for one of the horizons */
+    std::unique_ptr<TxConfirmStats> MakeStats(const HorizonParams& horizon) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+
+    /** Process a transaction accepted to the mempool*/
+    void _processTransaction(const MempoolEvent& event) EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+
     /** Process a transaction confirmed in a block*/
     bool processBlockTx(unsigned int nBlockHeight, const CTxMemPoolEntry* entry) EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 
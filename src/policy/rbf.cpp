@@ -154,6 +154,28 @@ std::optional<std::string> PaysMoreThanConflicts(const CTxMemPool::setEntries& i
     return std::nullopt;
 }
 
+std::optional<std::string> PaysMoreThanConflictChunks(const CTxMemPool& pool,
+                                                      const CTxMemPool::setEntries& iters_conflicting,
+                                                      CFeeRate replacement_feerate,
+                                                      const uint256& txid)
+{
+    AssertLockHeld(pool.cs);
+    // Conflicts often share a cluster, which is linearized once for all of them.
+    const auto chunk_feerates{pool.GetChunkFeerates(iters_conflicting)};
+    for (const auto& [mi, chunk_feerate] : chunk_feerates) {
+        // A conflict that is mined together with high feerate descendants is worth more to a
+        // miner than its own feerate says: don't replace it with something that would be mined
+        // later.
+        if (replacement_feerate <= chunk_feerate) {
+            return strprintf("rejecting replacement %s; new feerate %s <= old chunk feerate %s",
+                             txid.ToString(),
+                             replacement_feerate.ToString(),
+                             chunk_feerate.ToString());
+        }
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> PaysForRBF(CAmount original_fees,
                                       CAmount replacement_fees,
                                       size_t replacement_vsize,
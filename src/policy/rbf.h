@@ -91,6 +91,18 @@ std::optional<std::string> EntriesAndTxidsDisjoint(const CTxMemPool::setEntries&
 std::optional<std::string> PaysMoreThanConflicts(const CTxMemPool::setEntries& iters_conflicting,
                                                  CFeeRate replacement_feerate, const uint256& txid);
 
+/** Check that the feerate of the replacement transaction is higher than the chunk feerate of each
+ * of the transactions in iters_conflicting, i.e. the feerate they would be mined at, which counts
+ * the descendants paying for them.
+ * @param[in]   pool               The mempool iters_conflicting belong to.
+ * @param[in]   iters_conflicting  The set of mempool entries.
+ * @returns error message if fees insufficient, otherwise std::nullopt.
+ */
+std::optional<std::string> PaysMoreThanConflictChunks(const CTxMemPool& pool,
+                                                      const CTxMemPool::setEntries& iters_conflicting,
+                                                      CFeeRate replacement_feerate,
+                                                      const uint256& txid) EXCLUSIVE_LOCKS_REQUIRED(pool.cs);
+
 /** The replacement transaction must pay more fees than the original transactions. The additional
  * fees must pay for the replacement's bandwidth at or above the incremental relay feerate.
  * @param[in]   original_fees       Total modified fees of original transaction(s).
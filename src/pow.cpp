@@ -103,23 +103,23 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast,
 
     // ★ 포크 전(<= fork_h)은 무조건 레거시 DAA
     if (next_height <= fork_h) {
-        LogPrintf("POWDBG[REQ]: h=%d fork_h=%d path=LEGACY\n", next_height, fork_h);
+        LogPrint(BCLog::VALIDATION, "POWDBG[REQ]: h=%d fork_h=%d path=LEGACY\n", next_height, fork_h);
         unsigned int ret = GetNextWorkRequired_Legacy(pindexLast, pblock, params);
         if (ret == 0) {
             ret = UintToArith256(params.powLimit).GetCompact();
-            LogPrintf("POWDBG[CLAMP]: legacy returned 0 at h=%d -> powLimit=%08x\n", next_height, ret);
+            LogPrint(BCLog::VALIDATION, "POWDBG[CLAMP]: legacy returned 0 at h=%d -> powLimit=%08x\n", next_height, ret);
         }
         return ret;
     }
 
-    LogPrintf("POWDBG[REQ]: h=%d fork_h=%d path=POST_FORK\n", next_height, fork_h);
+    LogPrint(BCLog::VALIDATION, "POWDBG[REQ]: h=%d fork_h=%d path=POST_FORK\n", next_height, fork_h);
 
     // (필수) 포크+1 완화: 첫 블록은 powLimit 허용 (체인 부팅용)
     if (next_height == fork_h + 1) {
         unsigned int ret = UintToArith256(params.powLimit).GetCompact();
         if (ret == 0) {
             ret = 0x1d00ffff; // 절대 0이 되지 않는 안전 값
-            LogPrintf("POWDBG[CLAMP]: fork+1 powLimit compact=0 -> fallback=%08x\n", ret);
+            LogPrint(BCLog::VALIDATION, "POWDBG[CLAMP]: fork+1 powLimit compact=0 -> fallback=%08x\n", ret);
         }
         return ret;
     }
@@ -130,9 +130,9 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast,
         unsigned int ret = UintToArith256(params.powLimit).GetCompact();
         if (ret == 0) {
             ret = 0x1d00ffff;
-            LogPrintf("POWDBG[CLAMP]: post_fork warmup powLimit compact=0 -> fallback=%08x\n", ret);
+            LogPrint(BCLog::VALIDATION, "POWDBG[CLAMP]: post_fork warmup powLimit compact=0 -> fallback=%08x\n", ret);
         }
-        LogPrintf("POWDBG[WARMUP]: h=%d <= warmup_end=%d -> powLimit=%08x\n", next_height, warmup_end, ret);
+        LogPrint(BCLog::VALIDATION, "POWDBG[WARMUP]: h=%d <= warmup_end=%d -> powLimit=%08x\n", next_height, warmup_end, ret);
         return ret;
     }
 
@@ -142,11 +142,11 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast,
         (params.btcbt_asert_anchor_bits   != 0);
 
     if (!asert_ready) {
-        LogPrintf("POWDBG[REQ]: h=%d ASERT anchor_ready=0 -> LEGACY\n", next_height);
+        LogPrint(BCLog::VALIDATION, "POWDBG[REQ]: h=%d ASERT anchor_ready=0 -> LEGACY\n", next_height);
         unsigned int ret = GetNextWorkRequired_Legacy(pindexLast, pblock, params);
                 if (ret == 0) {
             ret = UintToArith256(params.powLimit).GetCompact();
-            LogPrintf("POWDBG[CLAMP]: legacy fallback returned 0 at h=%d -> powLimit=%08x\n", next_height, ret);
+            LogPrint(BCLog::VALIDATION, "POWDBG[CLAMP]: legacy fallback returned 0 at h=%d -> powLimit=%08x\n", next_height, ret);
         }
         return ret;
     }
@@ -157,7 +157,7 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast,
     if (anchor_bits == 0) anchor_bits = UintToArith256(params.powLimit).GetCompact();
 
     if (next_height == anchor_h + 1) {
-        LogPrintf("POWDBG[FIX]: h=%d == anchor_h+1=%d -> fixed_bits=%08x\n",
+        LogPrint(BCLog::VALIDATION, "POWDBG[FIX]: h=%d == anchor_h+1=%d -> fixed_bits=%08x\n",
                   next_height, anchor_h + 1, (unsigned)anchor_bits);
         return anchor_bits;
     }
@@ -167,7 +167,7 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast,
     if (ret == 0) {
         arith_uint256 min_target = arith_uint256(1);
         ret = min_target.GetCompact();
-        LogPrintf("POWDBG[CLAMP]: ASERT returned 0 at h=%d -> min_target=%08x\n", next_height, ret);
+        LogPrint(BCLog::VALIDATION, "POWDBG[CLAMP]: ASERT returned 0 at h=%d -> min_target=%08x\n", next_height, ret);
     }
     return ret;
 }
@@ -270,7 +270,7 @@ static unsigned int GetNextWorkRequired_ASERT(const CBlockIndex* pindexLast, con
     // ===== BTCBT 합의 고정: 첫 ASERT 계산(=anchor 다음 블록)에선 변화 0 =====
     // prev가 anchor 자체면(next block이 anchor+1) 무조건 anchor_bits 반환
     if (pindexLast->nHeight == anchor_h) {
-        LogPrintf("POWDBG[FIX]: ASERT first-after-anchor prev_h=%d anchor_h=%d -> fixed_bits=%08x\n",
+        LogPrint(BCLog::VALIDATION, "POWDBG[FIX]: ASERT first-after-anchor prev_h=%d anchor_h=%d -> fixed_bits=%08x\n",
                   (int)pindexLast->nHeight, (int)anchor_h, (unsigned)anchor_bits);
         return anchor_bits;
     }
@@ -301,7 +301,7 @@ if (anchor->nHeight == fork_h + 1) {
 const int64_t time_diff   = pindexLast->GetBlockTime() - anchor_parent_time;
 const int64_t height_diff = pindexLast->nHeight       - anchor->nHeight;
 
-LogPrintf("POWDBG[ASERT]: prev_h=%d anchor_h=%d anchor_parent_time=%lld prev_time=%lld time_diff=%lld height_diff=%lld T=%lld half_life=%lld anchor_bits=%08x\n",
+LogPrint(BCLog::VALIDATION, "POWDBG[ASERT]: prev_h=%d anchor_h=%d anchor_parent_time=%lld prev_time=%lld time_diff=%lld height_diff=%lld T=%lld half_life=%lld anchor_bits=%08x\n",
           (int)pindexLast->nHeight, (int)anchor->nHeight,
           (long long)anchor_parent_time, (long long)pindexLast->GetBlockTime(),
           (long long)time_diff, (long long)height_diff,
@@ -5,14 +5,36 @@
 
 #include <primitives/block.h>
 
+#include <crypto/sha256.h>
 #include <hash.h>
+#include <streams.h>
 #include <tinyformat.h>
 
+#include <cassert>
+
 uint256 CBlockHeader::GetHash() const
 {
     return (CHashWriter{PROTOCOL_VERSION} << *this).GetHash();
 }
 
+std::vector<uint256> GetBlockHeaderHashes(Span<const CBlockHeader> headers)
+{
+    if (headers.empty()) return {};
+    std::vector<unsigned char> serialized;
+    serialized.reserve(headers.size() * CBlockHeader::SERIALIZED_SIZE);
+    CVectorWriter writer{PROTOCOL_VERSION, serialized, 0};
+    for (const CBlockHeader& header : headers) {
+        writer << header;
+    }
+    assert(serialized.size() == headers.size() * CBlockHeader::SERIALIZED_SIZE);
+
+    // The hashes are written straight into the vector, which is a contiguous array of 32 byte blobs.
+    static_assert(sizeof(uint256) == CSHA256::OUTPUT_SIZE);
+    std::vector<uint256> hashes(headers.size());
+    SHA256D80(hashes[0].begin(), serialized.data(), headers.size());
+    return hashes;
+}
+
 std::string CBlock::ToString() const
 {
     std::stringstream s;
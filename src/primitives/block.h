@@ -8,9 +8,12 @@
 
 #include <primitives/transaction.h>
 #include <serialize.h>
+#include <span.h>
 #include <uint256.h>
 #include <util/time.h>
 
+#include <vector>
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -29,6 +32,9 @@ public:
     uint32_t nBits;
     uint32_t nNonce;
 
+    //! Size of a serialized header, the input of GetHash()
+    static constexpr size_t SERIALIZED_SIZE{80};
+
     CBlockHeader()
     {
         SetNull();
@@ -64,6 +70,10 @@ public:
     }
 };
 
+/** Compute the hashes of a batch of headers, equal to calling GetHash() on each of them but
+ *  faster, as several headers are hashed at once where the CPU supports it. */
+std::vector<uint256> GetBlockHeaderHashes(Span<const CBlockHeader> headers);
+
 
 class CBlock : public CBlockHeader
 {
@@ -225,6 +225,53 @@ bool XOnlyPubKey::VerifySchnorr(const uint256& msg, Span<const unsigned char> si
     return secp256k1_schnorrsig_verify(secp256k1_context_static, sigbytes.data(), msg.begin(), 32, &pubkey);
 }
 
+/** Scratch space of a batch, enough for the multi-multiplication of MAX_SIZE signatures. */
+static constexpr size_t SCHNORR_BATCH_SCRATCH_SIZE{1 << 20};
+
+SchnorrBatch::SchnorrBatch() : m_scratch{secp256k1_scratch_space_create(secp256k1_context_static, SCHNORR_BATCH_SCRATCH_SIZE)}
+{
+    assert(m_scratch);
+    m_entries.reserve(MAX_SIZE);
+}
+
+SchnorrBatch::~SchnorrBatch()
+{
+    secp256k1_scratch_space_destroy(secp256k1_context_static, m_scratch);
+}
+
+bool SchnorrBatch::Add(const uint256& msg, Span<const unsigned char> sigbytes, const XOnlyPubKey& pubkey)
+{
+    assert(sigbytes.size() == 64);
+    Entry& entry{m_entries.emplace_back()};
+    std::copy(sigbytes.begin(), sigbytes.end(), entry.sig.begin());
+    entry.msg = msg;
+    entry.pubkey = pubkey;
+    return m_entries.size() < MAX_SIZE || Verify();
+}
+
+bool SchnorrBatch::Verify()
+{
+    std::vector<secp256k1_xonly_pubkey> pubkeys(m_entries.size());
+    std::vector<const unsigned char*> sigs;
+    std::vector<const unsigned char*> msgs;
+    std::vector<const secp256k1_xonly_pubkey*> pubkey_ptrs;
+    sigs.reserve(m_entries.size());
+    msgs.reserve(m_entries.size());
+    pubkey_ptrs.reserve(m_entries.size());
+    bool ret{true};
+    for (size_t i = 0; i < m_entries.size() && ret; ++i) {
+        ret = secp256k1_xonly_pubkey_parse(secp256k1_context_static, &pubkeys[i], m_entries[i].pubkey.data());
+        sigs.push_back(m_entries[i].sig.data());
+        msgs.push_back(m_entries[i].msg.begin());
+        pubkey_ptrs.push_back(&pubkeys[i]);
+    }
+    if (ret) {
+        ret = secp256k1_schnorrsig_verify_batch(secp256k1_context_static, m_scratch, sigs.data(), msgs.data(), pubkey_ptrs.data(), m_entries.size());
+    }
+    m_entries.clear();
+    return ret;
+}
+
 static const HashWriter HASHER_TAPTWEAK{TaggedHash("TapTweak")};
 
 uint256 XOnlyPubKey::ComputeTapTweakHash(const uint256* merkle_root) const
@@ -402,7 +449,7 @@ bool CExtPubKey::Derive(CExtPubKey &out, unsigned int _nChild) const {
     return pubkey.Derive(out.pubkey, out.chaincode, _nChild, chaincode);
 }
 
-/* static */ bool CPubKey::CheckLowS(const std::vector<unsigned char>& vchSig) {
+/* static */ bool CPubKey::CheckLowS(Span<const unsigned char> vchSig) {
     secp256k1_ecdsa_signature sig;
     if (!ecdsa_signature_parse_der_lax(&sig, vchSig.data(), vchSig.size())) {
         return false;
@@ -12,6 +12,7 @@
 #include <span.h>
 #include <uint256.h>
 
+#include <array>
 #include <cstring>
 #include <optional>
 #include <vector>
@@ -215,7 +216,7 @@ public:
     /**
      * Check whether a signature is normalized (lower-S).
      */
-    static bool CheckLowS(const std::vector<unsigned char>& vchSig);
+    static bool CheckLowS(Span<const unsigned char> vchSig);
 
     //! Recover a public key from a compact signature.
     bool RecoverCompact(const uint256& hash, const std::vector<unsigned char>& vchSig);
@@ -299,6 +300,42 @@ public:
     SERIALIZE_METHODS(XOnlyPubKey, obj) { READWRITE(obj.m_keydata); }
 };
 
+struct secp256k1_scratch_space_struct;
+
+/** Schnorr signatures collected to be verified at once, which is substantially cheaper per
+ *  signature than verifying them one by one. A failed batch does not tell which signature is
+ *  invalid. */
+class SchnorrBatch
+{
+public:
+    //! Signatures verified at once at most. Adding more verifies the batch and starts a new one.
+    static constexpr size_t MAX_SIZE{1024};
+
+    SchnorrBatch();
+    ~SchnorrBatch();
+    SchnorrBatch(const SchnorrBatch&) = delete;
+    SchnorrBatch& operator=(const SchnorrBatch&) = delete;
+
+    /** Add a signature to verify against a public key. sigbytes must be exactly 64 bytes.
+     *  Returns false if the batch was full and failed to verify. */
+    bool Add(const uint256& msg, Span<const unsigned char> sigbytes, const XOnlyPubKey& pubkey);
+
+    /** Verify all signatures added since the last call, and empty the batch. */
+    bool Verify();
+
+    bool empty() const { return m_entries.empty(); }
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        std::array<unsigned char, 64> sig;
+        uint256 msg;
+        XOnlyPubKey pubkey;
+    };
+    std::vector<Entry> m_entries;
+    secp256k1_scratch_space_struct* m_scratch;
+};
+
 /** An ElligatorSwift-encoded public key. */
 struct EllSwiftPubKey
 {
@@ -12,8 +12,10 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
+#include <node/blockservecache.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <node/transaction.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
@@ -109,6 +111,17 @@ static CTxMemPool* GetMemPool(const std::any& context, HTTPRequest* req)
     return node_context->mempool.get();
 }
 
+/**
+ * Get the node context block serve cache.
+ *
+ * @returns        Pointer to the cache or nullptr if it is disabled.
+ */
+static node::BlockServeCache* GetBlockServeCache(const std::any& context)
+{
+    auto node_context = util::AnyPtr<NodeContext>(context);
+    return node_context ? node_context->block_serve_cache.get() : nullptr;
+}
+
 /**
  * Get the node context chainstatemanager.
  *
@@ -310,24 +323,43 @@ static bool rest_block(const std::any& context,
 
     }
 
-    if (!chainman.m_blockman.ReadBlockFromDisk(block, *pblockindex)) {
+    // The serialized formats can be served from the block serve cache, shared with the P2P code.
+    std::shared_ptr<const SharedNetMsgPayload> block_data;
+    node::BlockServeCache* block_serve_cache{GetBlockServeCache(context)};
+    if (block_serve_cache && (rf == RESTResponseFormat::BINARY || rf == RESTResponseFormat::HEX)) {
+        const bool witness{(RPCSerializationFlags() & SERIALIZE_TRANSACTION_NO_WITNESS) == 0};
+        block_data = block_serve_cache->GetOrRead(chainman.m_blockman, *pblockindex, witness);
+        if (!block_data) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
+    } else if (!chainman.m_blockman.ReadBlockFromDisk(block, *pblockindex)) {
         return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
     }
 
     switch (rf) {
     case RESTResponseFormat::BINARY: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string binaryBlock = ssBlock.str();
+        std::string binaryBlock;
+        if (block_data) {
+            binaryBlock.assign(block_data->data.begin(), block_data->data.end());
+        } else {
+            CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+            ssBlock << block;
+            binaryBlock = ssBlock.str();
+        }
         req->WriteHeader("Content-Type", "application/octet-stream");
         req->WriteReply(HTTP_OK, binaryBlock);
         return true;
     }
 
     case RESTResponseFormat::HEX: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock) + "\n";
+        std::string strHex;
+        if (block_data) {
+            strHex = HexStr(block_data->data) + "\n";
+        } else {
+            CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+            ssBlock << block;
+            strHex = HexStr(ssBlock) + "\n";
+        }
         req->WriteHeader("Content-Type", "text/plain");
         req->WriteReply(HTTP_OK, strHex);
         return true;
@@ -697,6 +729,67 @@ static bool rest_mempool(const std::any& context, HTTPRequest* req, const std::s
     }
 }
 
+static bool rest_sendrawtransactions(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, str_uri_part);
+    if (!param.empty()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/sendrawtransactions.json");
+    }
+    if (rf != RESTResponseFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    if (req->GetRequestMethod() != HTTPRequest::POST) {
+        return RESTERR(req, HTTP_BAD_METHOD, "Transactions must be submitted with POST");
+    }
+
+    CFeeRate max_tx_feerate{node::DEFAULT_MAX_RAW_TX_FEE_RATE};
+    try {
+        if (const auto raw_maxfeerate{req->GetQueryParameter("maxfeerate")}) {
+            CAmount maxfeerate;
+            if (!ParseFixedPoint(*raw_maxfeerate, 8, &maxfeerate) || maxfeerate < 0) {
+                return RESTERR(req, HTTP_BAD_REQUEST, "The \"maxfeerate\" query parameter must be a non-negative amount in " + CURRENCY_UNIT + "/kvB.");
+            }
+            max_tx_feerate = CFeeRate{maxfeerate};
+        }
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+
+    // The body is a JSON array of hex-encoded transactions, as for the sendrawtransactions RPC.
+    UniValue raw_transactions;
+    if (!raw_transactions.read(req->ReadBody()) || !raw_transactions.isArray()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Expected a JSON array of hex-encoded transactions");
+    }
+    if (raw_transactions.size() < 1 || raw_transactions.size() > node::MAX_BROADCAST_BATCH_SIZE) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Array must contain between 1 and %u transactions", node::MAX_BROADCAST_BATCH_SIZE));
+    }
+    std::vector<CTransactionRef> txs;
+    txs.reserve(raw_transactions.size());
+    for (const UniValue& rawtx : raw_transactions.getValues()) {
+        CMutableTransaction mtx;
+        if (!rawtx.isStr() || !DecodeHexTx(mtx, rawtx.get_str())) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "TX decode failed");
+        }
+        txs.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    NodeContext* node = GetNodeContext(context, req);
+    if (!node) return false;
+    if (!node->mempool || !node->peerman) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Mempool disabled or instance not found");
+    }
+    const std::vector<MempoolAcceptResult> results{node::BroadcastTransactions(*node, txs, max_tx_feerate, /*relay=*/true)};
+
+    std::string str_json = MempoolAcceptResultsToJSON(txs, results).write() + "\n";
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, str_json);
+    return true;
+}
+
 static bool rest_tx(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req))
@@ -1016,6 +1109,7 @@ static const struct {
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/sendrawtransactions", rest_sendrawtransactions},
 };
 
 void StartREST(const std::any& context)
@@ -4,6 +4,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <core_io.h>
+#include <node/context.h>
+#include <node/mempool_fee_estimator.h>
 #include <policy/feerate.h>
 #include <policy/fees.h>
 #include <rpc/protocol.h>
@@ -14,18 +16,19 @@
 #include <txmempool.h>
 #include <univalue.h>
 #include <util/fees.h>
+#include <util/strencodings.h>
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <string>
 
-namespace node {
-struct NodeContext;
-}
-
+using node::MempoolFeeEstimator;
 using node::NodeContext;
 
+/** estimate_mode for estimates from the current mempool contents rather than from history. */
+static const std::string MEMPOOL_ESTIMATE_MODE{"mempool"};
+
 static RPCHelpMan estimatesmartfee()
 {
     return RPCHelpMan{"estimatesmartfee",
@@ -40,8 +43,10 @@ static RPCHelpMan estimatesmartfee()
             "a longer history. A conservative estimate potentially returns a\n"
             "higher feerate and is more likely to be sufficient for the desired\n"
             "target, but is not as responsive to short term drops in the\n"
-            "prevailing fee market. Must be one of (case insensitive):\n"
-             "\"" + FeeModes("\"\n\"") + "\""},
+            "prevailing fee market. \"" + MEMPOOL_ESTIMATE_MODE + "\" instead simulates the next blocks\n"
+            "from the current mempool contents and returns the feerate needed to make it into\n"
+            "block conf_target. Must be one of (case insensitive):\n"
+             "\"" + FeeModes("\"\n\"") + "\"\n\"" + MEMPOOL_ESTIMATE_MODE + "\""},
         },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
@@ -63,9 +68,22 @@ static RPCHelpMan estimatesmartfee()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
         {
-            CBlockPolicyEstimator& fee_estimator = EnsureAnyFeeEstimator(request.context);
             const NodeContext& node = EnsureAnyNodeContext(request.context);
             const CTxMemPool& mempool = EnsureMemPool(node);
+            CFeeRate min_mempool_feerate{mempool.GetMinFee()};
+            CFeeRate min_relay_feerate{mempool.m_min_relay_feerate};
+
+            if (!request.params[1].isNull() && ToUpper(request.params[1].get_str()) == ToUpper(MEMPOOL_ESTIMATE_MODE)) {
+                MempoolFeeEstimator& mempool_fee_estimator = EnsureMempoolFeeEstimator(node);
+                unsigned int conf_target = ParseConfirmTarget(request.params[0], MempoolFeeEstimator::MAX_TARGET);
+                CFeeRate feeRate{mempool_fee_estimator.EstimateFee(mempool, EnsureChainman(node), conf_target)};
+                UniValue result(UniValue::VOBJ);
+                result.pushKV("feerate", ValueFromAmount(std::max({feeRate, min_mempool_feerate, min_relay_feerate}).GetFeePerK()));
+                result.pushKV("blocks", int(conf_target));
+                return result;
+            }
+
+            CBlockPolicyEstimator& fee_estimator = EnsureFeeEstimator(node);
 
             unsigned int max_target = fee_estimator.HighestTargetTracked(FeeEstimateHorizon::LONG_HALFLIFE);
             unsigned int conf_target = ParseConfirmTarget(request.params[0], max_target);
@@ -73,7 +91,7 @@ static RPCHelpMan estimatesmartfee()
             if (!request.params[1].isNull()) {
                 FeeEstimateMode fee_mode;
                 if (!FeeModeFromString(request.params[1].get_str(), fee_mode)) {
-                    throw JSONRPCError(RPC_INVALID_PARAMETER, InvalidEstimateModeErrorMessage());
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, InvalidEstimateModeErrorMessage() + " or \"" + MEMPOOL_ESTIMATE_MODE + "\"");
                 }
                 if (fee_mode == FeeEstimateMode::ECONOMICAL) conservative = false;
             }
@@ -83,8 +101,6 @@ static RPCHelpMan estimatesmartfee()
             FeeCalculation feeCalc;
             CFeeRate feeRate{fee_estimator.estimateSmartFee(conf_target, &feeCalc, conservative)};
             if (feeRate != CFeeRate(0)) {
-                CFeeRate min_mempool_feerate{mempool.GetMinFee()};
-                CFeeRate min_relay_feerate{mempool.m_min_relay_feerate};
                 feeRate = std::max({feeRate, min_mempool_feerate, min_relay_feerate});
                 result.pushKV("feerate", ValueFromAmount(feeRate.GetFeePerK()));
             } else {
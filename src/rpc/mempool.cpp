@@ -10,10 +10,13 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <kernel/mempool_entry.h>
+#include <node/mempool_fee_estimator.h>
 #include <node/mempool_persist_args.h>
+#include <node/transaction.h>
 #include <policy/rbf.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <rpc/mempool.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -28,6 +31,7 @@
 using kernel::DumpMempool;
 
 using node::DEFAULT_MAX_RAW_TX_FEE_RATE;
+using node::MempoolFeeEstimator;
 using node::MempoolPath;
 using node::NodeContext;
 
@@ -100,6 +104,112 @@ static RPCHelpMan sendrawtransaction()
     };
 }
 
+UniValue MempoolAcceptResultsToJSON(const std::vector<CTransactionRef>& txs, const std::vector<MempoolAcceptResult>& results)
+{
+    CHECK_NONFATAL(txs.size() == results.size());
+    UniValue json(UniValue::VARR);
+    for (size_t i = 0; i < txs.size(); ++i) {
+        const MempoolAcceptResult& tx_result{results[i]};
+        UniValue result_inner(UniValue::VOBJ);
+        result_inner.pushKV("txid", txs[i]->GetHash().GetHex());
+        result_inner.pushKV("wtxid", txs[i]->GetWitnessHash().GetHex());
+        if (tx_result.m_result_type == MempoolAcceptResult::ResultType::VALID) {
+            result_inner.pushKV("allowed", true);
+            result_inner.pushKV("vsize", tx_result.m_vsize.value());
+            UniValue fees(UniValue::VOBJ);
+            fees.pushKV("base", ValueFromAmount(tx_result.m_base_fees.value()));
+            fees.pushKV("effective-feerate", ValueFromAmount(tx_result.m_effective_feerate.value().GetFeePerK()));
+            result_inner.pushKV("fees", fees);
+        } else {
+            result_inner.pushKV("allowed", false);
+            const TxValidationState& state{tx_result.m_state};
+            if (state.GetResult() == TxValidationResult::TX_MISSING_INPUTS) {
+                result_inner.pushKV("reject-reason", "missing-inputs");
+            } else {
+                result_inner.pushKV("reject-reason", state.GetRejectReason());
+            }
+        }
+        json.push_back(result_inner);
+    }
+    return json;
+}
+
+static RPCHelpMan sendrawtransactions()
+{
+    return RPCHelpMan{"sendrawtransactions",
+        "\nSubmit raw transactions (serialized, hex-encoded) to local node and network in one batch.\n"
+        "\nThe transactions may be unrelated or spend each other, in which case parents must come before children.\n"
+        "Each transaction is accepted or rejected on its own, as by sendrawtransaction, except that transactions\n"
+        "cannot replace mempool transactions or spend the same coins as another transaction of the batch, and that\n"
+        "transactions already in the mempool are reported as rejected rather than rebroadcast.\n"
+        "Their inputs are looked up and their scripts verified together, which is faster than one call per transaction.\n"
+        "\nThe maximum number of transactions allowed is " + ToString(node::MAX_BROADCAST_BATCH_SIZE) + ".\n"
+        "\nRelated RPCs: sendrawtransaction, testmempoolaccept\n",
+        {
+            {"rawtxs", RPCArg::Type::ARR, RPCArg::Optional::NO, "An array of hex strings of raw transactions.",
+                {
+                    {"rawtx", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, ""},
+                },
+            },
+            {"maxfeerate", RPCArg::Type::AMOUNT, RPCArg::Default{FormatMoney(DEFAULT_MAX_RAW_TX_FEE_RATE.GetFeePerK())},
+             "Reject transactions whose fee rate is higher than the specified value, expressed in " + CURRENCY_UNIT +
+                 "/kvB.\nSet to 0 to accept any fee rate."},
+        },
+        RPCResult{
+            RPCResult::Type::ARR, "", "The result of the submission of each raw transaction in the input array, in the same order.",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::STR_HEX, "txid", "The transaction hash in hex"},
+                    {RPCResult::Type::STR_HEX, "wtxid", "The transaction witness hash in hex"},
+                    {RPCResult::Type::BOOL, "allowed", "Whether this tx was accepted to the mempool"},
+                    {RPCResult::Type::NUM, "vsize", /*optional=*/true, "Virtual transaction size as defined in BIP 141 (only present when 'allowed' is true)"},
+                    {RPCResult::Type::OBJ, "fees", /*optional=*/true, "Transaction fees (only present if 'allowed' is true)",
+                    {
+                        {RPCResult::Type::STR_AMOUNT, "base", "transaction fee in " + CURRENCY_UNIT},
+                        {RPCResult::Type::STR_AMOUNT, "effective-feerate", "the effective feerate in " + CURRENCY_UNIT + " per KvB, including modified fees from prioritisetransaction"},
+                    }},
+                    {RPCResult::Type::STR, "reject-reason", /*optional=*/true, "Rejection string (only present when 'allowed' is false)"},
+                }},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("sendrawtransactions", R"('["signedhex1", "signedhex2"]')") +
+            HelpExampleRpc("sendrawtransactions", "[\"signedhex1\", \"signedhex2\"]")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            const UniValue raw_transactions = request.params[0].get_array();
+            if (raw_transactions.size() < 1 || raw_transactions.size() > node::MAX_BROADCAST_BATCH_SIZE) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER,
+                                   "Array must contain between 1 and " + ToString(node::MAX_BROADCAST_BATCH_SIZE) + " transactions.");
+            }
+
+            const CFeeRate max_raw_tx_fee_rate = request.params[1].isNull() ?
+                                                     DEFAULT_MAX_RAW_TX_FEE_RATE :
+                                                     CFeeRate(AmountFromValue(request.params[1]));
+
+            std::vector<CTransactionRef> txns;
+            txns.reserve(raw_transactions.size());
+            for (const auto& rawtx : raw_transactions.getValues()) {
+                CMutableTransaction mtx;
+                if (!DecodeHexTx(mtx, rawtx.get_str())) {
+                    throw JSONRPCError(RPC_DESERIALIZATION_ERROR,
+                                       "TX decode failed: " + rawtx.get_str() + " Make sure the tx has at least one input.");
+                }
+                txns.emplace_back(MakeTransactionRef(std::move(mtx)));
+            }
+
+            AssertLockNotHeld(cs_main);
+            NodeContext& node = EnsureAnyNodeContext(request.context);
+            EnsureMemPool(node);
+            EnsurePeerman(node);
+            const std::vector<MempoolAcceptResult> results{node::BroadcastTransactions(node, txns, max_raw_tx_fee_rate, /*relay=*/true)};
+            return MempoolAcceptResultsToJSON(txns, results);
+        },
+    };
+}
+
 static RPCHelpMan testmempoolaccept()
 {
     return RPCHelpMan{"testmempoolaccept",
@@ -684,6 +794,18 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool)
     ret.pushKV("incrementalrelayfee", ValueFromAmount(pool.m_incremental_relay_feerate.GetFeePerK()));
     ret.pushKV("unbroadcastcount", uint64_t{pool.GetUnbroadcastTxs().size()});
     ret.pushKV("fullrbf", pool.m_full_rbf);
+    UniValue histogram(UniValue::VARR);
+    const FeerateHistogram& feerate_histogram{pool.GetFeerateHistogram()};
+    const std::vector<CAmount>& bucket_feerates{FeerateHistogram::BucketFeerates()};
+    for (size_t i = 0; i < bucket_feerates.size(); ++i) {
+        const uint64_t vsize{feerate_histogram.GetBucketVsizes()[i]};
+        if (vsize == 0) continue;
+        UniValue bucket(UniValue::VOBJ);
+        bucket.pushKV("feerate", ValueFromAmount(bucket_feerates[i]));
+        bucket.pushKV("vsize", vsize);
+        histogram.push_back(bucket);
+    }
+    ret.pushKV("feerate_histogram", histogram);
     return ret;
 }
 
@@ -691,7 +813,9 @@ static RPCHelpMan getmempoolinfo()
 {
     return RPCHelpMan{"getmempoolinfo",
         "Returns details on the active state of the TX memory pool.",
-        {},
+        {
+            {"blocks", RPCArg::Type::NUM, RPCArg::Default{0}, "Also simulate this many next blocks from the mempool contents, up to " + ToString(MempoolFeeEstimator::MAX_TARGET)},
+        },
         RPCResult{
             RPCResult::Type::OBJ, "", "",
             {
@@ -706,6 +830,24 @@ static RPCHelpMan getmempoolinfo()
                 {RPCResult::Type::NUM, "incrementalrelayfee", "minimum fee rate increment for mempool limiting or replacement in " + CURRENCY_UNIT + "/kvB"},
                 {RPCResult::Type::NUM, "unbroadcastcount", "Current number of transactions that haven't passed initial broadcast yet"},
                 {RPCResult::Type::BOOL, "fullrbf", "True if the mempool accepts RBF without replaceability signaling inspection"},
+                {RPCResult::Type::ARR, "feerate_histogram", "Virtual size of the transactions by modified feerate, for feerate ranges holding any, in ascending order",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::STR_AMOUNT, "feerate", "Lower bound of the feerate range in " + CURRENCY_UNIT + "/kvB, each 10% above the previous one"},
+                            {RPCResult::Type::NUM, "vsize", "Sum of the virtual sizes of the transactions in the range"},
+                        }},
+                    }},
+                {RPCResult::Type::ARR, "blocks", /*optional=*/true, "The next blocks as mined from the mempool, if requested. Fewer if the mempool runs out",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::STR_AMOUNT, "minfeerate", "Lowest feerate of the transaction packages in the block, in " + CURRENCY_UNIT + "/kvB"},
+                            {RPCResult::Type::NUM, "vsize", "Sum of the virtual sizes of the transactions in the block"},
+                            {RPCResult::Type::STR_AMOUNT, "fees", "Sum of the modified fees of the transactions in the block"},
+                            {RPCResult::Type::BOOL, "full", "Whether the next transaction package did not fit in the block"},
+                        }},
+                    }},
             }},
         RPCExamples{
             HelpExampleCli("getmempoolinfo", "")
@@ -713,7 +855,26 @@ static RPCHelpMan getmempoolinfo()
         },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    return MempoolInfoToJSON(EnsureAnyMemPool(request.context));
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    const CTxMemPool& mempool = EnsureMemPool(node);
+    UniValue ret{MempoolInfoToJSON(mempool)};
+    const int num_blocks{self.Arg<int>(0)};
+    if (num_blocks < 0 || num_blocks > int(MempoolFeeEstimator::MAX_TARGET)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid blocks, must be between 0 and %u", MempoolFeeEstimator::MAX_TARGET));
+    }
+    if (num_blocks > 0) {
+        UniValue blocks(UniValue::VARR);
+        for (const auto& block : EnsureMempoolFeeEstimator(node).GetBlocks(mempool, EnsureChainman(node), num_blocks)) {
+            UniValue o(UniValue::VOBJ);
+            o.pushKV("minfeerate", ValueFromAmount(block.min_feerate.GetFeePerK()));
+            o.pushKV("vsize", block.vsize);
+            o.pushKV("fees", ValueFromAmount(block.fees));
+            o.pushKV("full", block.full);
+            blocks.push_back(o);
+        }
+        ret.pushKV("blocks", blocks);
+    }
+    return ret;
 },
     };
 }
@@ -797,6 +958,7 @@ static RPCHelpMan savemempool()
 {
     const ArgsManager& args{EnsureAnyArgsman(request.context)};
     const CTxMemPool& mempool = EnsureAnyMemPool(request.context);
+    const ChainstateManager& chainman = EnsureAnyChainman(request.context);
 
     if (!mempool.GetLoadTried()) {
         throw JSONRPCError(RPC_MISC_ERROR, "The mempool was not loaded yet");
@@ -804,7 +966,7 @@ static RPCHelpMan savemempool()
 
     const fs::path& dump_path = MempoolPath(args);
 
-    if (!DumpMempool(mempool, dump_path)) {
+    if (!DumpMempool(mempool, dump_path, chainman.ActiveChainstate())) {
         throw JSONRPCError(RPC_MISC_ERROR, "Unable to dump mempool to disk");
     }
 
@@ -974,6 +1136,7 @@ void RegisterMempoolRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"rawtransactions", &sendrawtransaction},
+        {"rawtransactions", &sendrawtransactions},
         {"rawtransactions", &testmempoolaccept},
         {"blockchain", &getmempoolancestors},
         {"blockchain", &getmempooldescendants},
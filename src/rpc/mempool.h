@@ -5,8 +5,13 @@
 #ifndef BITCOIN_RPC_MEMPOOL_H
 #define BITCOIN_RPC_MEMPOOL_H
 
+#include <primitives/transaction.h>
+
+#include <vector>
+
 class CTxMemPool;
 class UniValue;
+struct MempoolAcceptResult;
 
 /** Mempool information to JSON */
 UniValue MempoolInfoToJSON(const CTxMemPool& pool);
@@ -14,4 +19,7 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool);
 /** Mempool to JSON */
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose = false, bool include_mempool_sequence = false);
 
+/** Per-transaction results of sendrawtransactions to JSON, in the order of txs */
+UniValue MempoolAcceptResultsToJSON(const std::vector<CTransactionRef>& txs, const std::vector<MempoolAcceptResult>& results);
+
 #endif // BITCOIN_RPC_MEMPOOL_H
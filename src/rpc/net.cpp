@@ -14,6 +14,7 @@
 #include <net_processing.h>
 #include <net_types.h> // For banmap_t
 #include <netbase.h>
+#include <node/blockservecache.h>
 #include <node/context.h>
 #include <policy/settings.h>
 #include <rpc/blockchain.h>
@@ -147,6 +148,7 @@ static RPCHelpMan getpeerinfo()
                     {
                         {RPCResult::Type::NUM, "n", "The heights of blocks we're currently asking from this peer"},
                     }},
+                    {RPCResult::Type::NUM, "block_download_rate", "Estimated rate at which this peer delivers the blocks we request, in bytes per second, or 0 if unknown"},
                     {RPCResult::Type::BOOL, "addr_relay_enabled", "Whether we participate in address relay with this peer"},
                     {RPCResult::Type::NUM, "addr_processed", "The total number of addresses processed, excluding those dropped due to rate limiting"},
                     {RPCResult::Type::NUM, "addr_rate_limited", "The total number of addresses dropped due to rate limiting"},
@@ -253,6 +255,7 @@ static RPCHelpMan getpeerinfo()
             heights.push_back(height);
         }
         obj.pushKV("inflight", heights);
+        obj.pushKV("block_download_rate", statestats.m_block_download_rate);
         obj.pushKV("addr_relay_enabled", statestats.m_addr_relay_enabled);
         obj.pushKV("addr_processed", statestats.m_addr_processed);
         obj.pushKV("addr_rate_limited", statestats.m_addr_rate_limited);
@@ -638,6 +641,15 @@ static RPCHelpMan getnetworkinfo()
                                 {RPCResult::Type::NUM, "score", "relative score"},
                             }},
                         }},
+                        {RPCResult::Type::OBJ, "blockservecache", /*optional=*/true, "the cache of serialized blocks served to peers (only present if -blockservecache is not 0)",
+                        {
+                            {RPCResult::Type::NUM, "entries", "number of serialized blocks in the cache"},
+                            {RPCResult::Type::NUM, "usage", "size of the cached serialized blocks in bytes"},
+                            {RPCResult::Type::NUM, "max_usage", "maximum size of the cache in bytes"},
+                            {RPCResult::Type::NUM, "hits", "number of block requests answered from the cache"},
+                            {RPCResult::Type::NUM, "misses", "number of block requests that had to be read from disk"},
+                            {RPCResult::Type::NUM, "evictions", "number of blocks evicted from the cache to make space"},
+                        }},
                         {RPCResult::Type::STR, "warnings", "any network and blockchain warnings"},
                     }
                 },
@@ -687,6 +699,17 @@ static RPCHelpMan getnetworkinfo()
         }
     }
     obj.pushKV("localaddresses", localAddresses);
+    if (node.block_serve_cache) {
+        const auto stats{node.block_serve_cache->GetStats()};
+        UniValue cache(UniValue::VOBJ);
+        cache.pushKV("entries", uint64_t(stats.entries));
+        cache.pushKV("usage", uint64_t(stats.usage));
+        cache.pushKV("max_usage", uint64_t(stats.max_usage));
+        cache.pushKV("hits", stats.hits);
+        cache.pushKV("misses", stats.misses);
+        cache.pushKV("evictions", stats.evictions);
+        obj.pushKV("blockservecache", cache);
+    }
     obj.pushKV("warnings",       GetWarnings(false).original);
     return obj;
 },
@@ -7,6 +7,7 @@
 #include <common/args.h>
 #include <net_processing.h>
 #include <node/context.h>
+#include <node/mempool_fee_estimator.h>
 #include <policy/fees.h>
 #include <rpc/protocol.h>
 #include <rpc/request.h>
@@ -93,6 +94,14 @@ CBlockPolicyEstimator& EnsureAnyFeeEstimator(const std::any& context)
     return EnsureFeeEstimator(EnsureAnyNodeContext(context));
 }
 
+node::MempoolFeeEstimator& EnsureMempoolFeeEstimator(const NodeContext& node)
+{
+    if (!node.mempool_fee_estimator) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Mempool fee estimation disabled");
+    }
+    return *node.mempool_fee_estimator;
+}
+
 CConnman& EnsureConnman(const NodeContext& node)
 {
     if (!node.connman) {
@@ -16,6 +16,7 @@ class ChainstateManager;
 class PeerManager;
 class BanMan;
 namespace node {
+class MempoolFeeEstimator;
 struct NodeContext;
 } // namespace node
 
@@ -30,6 +31,7 @@ ChainstateManager& EnsureChainman(const node::NodeContext& node);
 ChainstateManager& EnsureAnyChainman(const std::any& context);
 CBlockPolicyEstimator& EnsureFeeEstimator(const node::NodeContext& node);
 CBlockPolicyEstimator& EnsureAnyFeeEstimator(const std::any& context);
+node::MempoolFeeEstimator& EnsureMempoolFeeEstimator(const node::NodeContext& node);
 CConnman& EnsureConnman(const node::NodeContext& node);
 PeerManager& EnsurePeerman(const node::NodeContext& node);
 AddrMan& EnsureAddrman(const node::NodeContext& node);
@@ -11,12 +11,80 @@
 #include <crypto/sha256.h>
 #include <pubkey.h>
 #include <script/script.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
 
+#include <cstddef>
+#include <optional>
+#include <scoped_allocator>
+
 typedef std::vector<unsigned char> valtype;
 
 namespace {
 
+//! Largest block served by a script arena: any stack element, and stacks of up to a hundred elements.
+constexpr size_t SCRIPT_ARENA_MAX_BLOCK_BYTES{4096};
+//! Size of the chunks a script arena carves blocks from. A thread holds one between verifications.
+constexpr size_t SCRIPT_ARENA_CHUNK_BYTES{1 << 16};
+
+using ScriptArena = PoolResource<SCRIPT_ARENA_MAX_BLOCK_BYTES, alignof(std::max_align_t)>;
+template <typename T>
+using ScriptArenaAllocator = PoolAllocator<T, SCRIPT_ARENA_MAX_BLOCK_BYTES, alignof(std::max_align_t)>;
+
+/** An element of the stack of the interpreter, allocated from the arena of the stack. */
+using StackElement = std::vector<unsigned char, ScriptArenaAllocator<unsigned char>>;
+/** The stack of the interpreter, which allocates its elements from the same arena as itself. */
+using ScriptStack = std::vector<StackElement, std::scoped_allocator_adaptor<ScriptArenaAllocator<StackElement>>>;
+
+/**
+ * Stacks are allocated from an arena of the thread running the script, so that pushing,
+ * duplicating and dropping elements reuses memory instead of going through the heap. Every
+ * function creating a stack holds a scope on the arena. When the outermost one ends, between two
+ * script verifications (e.g. two CScriptChecks), the arena is rebuilt if a script grew it past its
+ * first chunk, so that a thread does not hold on to more than that.
+ */
+class ScriptArenaScope
+{
+    struct ThreadArena {
+        std::optional<ScriptArena> arena;
+        int scopes{0};
+    };
+
+    static ThreadArena& Get()
+    {
+        thread_local ThreadArena thread_arena;
+        return thread_arena;
+    }
+
+    ThreadArena& m_thread_arena{Get()};
+
+public:
+    ScriptArenaScope()
+    {
+        if (m_thread_arena.scopes++ == 0 && !m_thread_arena.arena) m_thread_arena.arena.emplace(SCRIPT_ARENA_CHUNK_BYTES);
+    }
+
+    ~ScriptArenaScope()
+    {
+        if (--m_thread_arena.scopes == 0 && m_thread_arena.arena->NumAllocatedChunks() > 1) {
+            m_thread_arena.arena.emplace(SCRIPT_ARENA_CHUNK_BYTES);
+        }
+    }
+
+    ScriptArenaScope(const ScriptArenaScope&) = delete;
+    ScriptArenaScope& operator=(const ScriptArenaScope&) = delete;
+
+    //! An empty stack, which must not outlive the scope.
+    ScriptStack MakeStack() const
+    {
+        return ScriptStack{ScriptArenaAllocator<StackElement>{&*m_thread_arena.arena}};
+    }
+};
+
+/** The signature checker interface takes vectors: copy stack elements into one. */
+const valtype& ToValtype(const valtype& vch) { return vch; }
+valtype ToValtype(const StackElement& vch) { return {vch.begin(), vch.end()}; }
+
 inline bool set_success(ScriptError* ret)
 {
     if (ret)
@@ -33,7 +101,7 @@ inline bool set_error(ScriptError* ret, const ScriptError serror)
 
 } // namespace
 
-bool CastToBool(const valtype& vch)
+bool CastToBool(Span<const unsigned char> vch)
 {
     for (unsigned int i = 0; i < vch.size(); i++)
     {
@@ -54,14 +122,30 @@ bool CastToBool(const valtype& vch)
  */
 #define stacktop(i)  (stack.at(stack.size()+(i)))
 #define altstacktop(i)  (altstack.at(altstack.size()+(i)))
-static inline void popstack(std::vector<valtype>& stack)
+static inline void popstack(ScriptStack& stack)
 {
     if (stack.empty())
         throw std::runtime_error("popstack(): stack empty");
     stack.pop_back();
 }
 
-bool static IsCompressedOrUncompressedPubKey(const valtype &vchPubKey) {
+static inline void pushbool(ScriptStack& stack, bool value)
+{
+    if (value) {
+        stack.emplace_back(1, 1);
+    } else {
+        stack.emplace_back();
+    }
+}
+
+static inline void pushnum(ScriptStack& stack, const CScriptNum& num)
+{
+    StackElement& vch{stack.emplace_back()};
+    vch.reserve(sizeof(int64_t) + 1);
+    num.getvch(vch);
+}
+
+bool static IsCompressedOrUncompressedPubKey(Span<const unsigned char> vchPubKey) {
     if (vchPubKey.size() < CPubKey::COMPRESSED_SIZE) {
         //  Non-canonical public key: too short
         return false;
@@ -83,7 +167,7 @@ bool static IsCompressedOrUncompressedPubKey(const valtype &vchPubKey) {
     return true;
 }
 
-bool static IsCompressedPubKey(const valtype &vchPubKey) {
+bool static IsCompressedPubKey(Span<const unsigned char> vchPubKey) {
     if (vchPubKey.size() != CPubKey::COMPRESSED_SIZE) {
         //  Non-canonical public key: invalid length for compressed key
         return false;
@@ -105,7 +189,7 @@ bool static IsCompressedPubKey(const valtype &vchPubKey) {
  *
  * This function is consensus-critical since BIP66.
  */
-bool static IsValidSignatureEncoding(const std::vector<unsigned char> &sig) {
+bool static IsValidSignatureEncoding(Span<const unsigned char> sig) {
     // Format: 0x30 [total-length] 0x02 [R-length] [R] 0x02 [S-length] [S] [sighash]
     // * total-length: 1-byte length descriptor of everything that follows,
     //   excluding the sighash byte.
@@ -170,24 +254,23 @@ bool static IsValidSignatureEncoding(const std::vector<unsigned char> &sig) {
     return true;
 }
 
-bool static IsLowDERSignature(const valtype &vchSig, ScriptError* serror) {
+bool static IsLowDERSignature(Span<const unsigned char> vchSig, ScriptError* serror) {
     if (!IsValidSignatureEncoding(vchSig)) {
         return set_error(serror, SCRIPT_ERR_SIG_DER);
     }
     // https://bitcoin.stackexchange.com/a/12556:
     //     Also note that inside transaction signatures, an extra hashtype byte
     //     follows the actual signature data.
-    std::vector<unsigned char> vchSigCopy(vchSig.begin(), vchSig.begin() + vchSig.size() - 1);
     // If the S value is above the order of the curve divided by two, its
     // complement modulo the order could have been used instead, which is
     // one byte shorter when encoded correctly.
-    if (!CPubKey::CheckLowS(vchSigCopy)) {
+    if (!CPubKey::CheckLowS(vchSig.first(vchSig.size() - 1))) {
         return set_error(serror, SCRIPT_ERR_SIG_HIGH_S);
     }
     return true;
 }
 
-bool static IsDefinedHashtypeSignature(const valtype &vchSig) {
+bool static IsDefinedHashtypeSignature(Span<const unsigned char> vchSig) {
     if (vchSig.size() == 0) {
         return false;
     }
@@ -198,7 +281,7 @@ bool static IsDefinedHashtypeSignature(const valtype &vchSig) {
     return true;
 }
 
-bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned int flags, ScriptError* serror) {
+bool CheckSignatureEncoding(Span<const unsigned char> vchSig, unsigned int flags, ScriptError* serror) {
     // Empty signature. Not strictly DER encoded, but allowed to provide a
     // compact way to provide an invalid signature for use with CHECK(MULTI)SIG
     if (vchSig.size() == 0) {
@@ -215,7 +298,7 @@ bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned i
     return true;
 }
 
-bool static CheckPubKeyEncoding(const valtype &vchPubKey, unsigned int flags, const SigVersion &sigversion, ScriptError* serror) {
+bool static CheckPubKeyEncoding(Span<const unsigned char> vchPubKey, unsigned int flags, const SigVersion &sigversion, ScriptError* serror) {
     if ((flags & SCRIPT_VERIFY_STRICTENC) != 0 && !IsCompressedOrUncompressedPubKey(vchPubKey)) {
         return set_error(serror, SCRIPT_ERR_PUBKEYTYPE);
     }
@@ -318,7 +401,24 @@ public:
 };
 }
 
-static bool EvalChecksigPreTapscript(const valtype& vchSig, const valtype& vchPubKey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& fSuccess)
+/** The part of OP_CHECKSIG before Tapscript that follows the FindAndDelete of the signature from
+ *  the scriptCode. */
+template <typename Element>
+static bool CheckECDSASignaturePreTapscript(const Element& vchSig, const Element& vchPubKey, const CScript& scriptCode, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& fSuccess)
+{
+    if (!CheckSignatureEncoding(vchSig, flags, serror) || !CheckPubKeyEncoding(vchPubKey, flags, sigversion, serror)) {
+        //serror is set
+        return false;
+    }
+    fSuccess = checker.CheckECDSASignature(ToValtype(vchSig), ToValtype(vchPubKey), scriptCode, sigversion);
+
+    if (!fSuccess && (flags & SCRIPT_VERIFY_NULLFAIL) && vchSig.size())
+        return set_error(serror, SCRIPT_ERR_SIG_NULLFAIL);
+
+    return true;
+}
+
+static bool EvalChecksigPreTapscript(const StackElement& vchSig, const StackElement& vchPubKey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& fSuccess)
 {
     assert(sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0);
 
@@ -327,24 +427,15 @@ static bool EvalChecksigPreTapscript(const valtype& vchSig, const valtype& vchPu
 
     // Drop the signature in pre-segwit scripts but not segwit scripts
     if (sigversion == SigVersion::BASE) {
-        int found = FindAndDelete(scriptCode, CScript() << vchSig);
+        int found = FindAndDelete(scriptCode, CScript() << ToValtype(vchSig));
         if (found > 0 && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
             return set_error(serror, SCRIPT_ERR_SIG_FINDANDDELETE);
     }
 
-    if (!CheckSignatureEncoding(vchSig, flags, serror) || !CheckPubKeyEncoding(vchPubKey, flags, sigversion, serror)) {
-        //serror is set
-        return false;
-    }
-    fSuccess = checker.CheckECDSASignature(vchSig, vchPubKey, scriptCode, sigversion);
-
-    if (!fSuccess && (flags & SCRIPT_VERIFY_NULLFAIL) && vchSig.size())
-        return set_error(serror, SCRIPT_ERR_SIG_NULLFAIL);
-
-    return true;
+    return CheckECDSASignaturePreTapscript(vchSig, vchPubKey, scriptCode, flags, checker, sigversion, serror, fSuccess);
 }
 
-static bool EvalChecksigTapscript(const valtype& sig, const valtype& pubkey, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
+static bool EvalChecksigTapscript(Span<const unsigned char> sig, Span<const unsigned char> pubkey, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
 {
     assert(sigversion == SigVersion::TAPSCRIPT);
 
@@ -389,7 +480,7 @@ static bool EvalChecksigTapscript(const valtype& sig, const valtype& pubkey, Scr
  * A return value of false means the script fails entirely. When true is returned, the
  * success variable indicates whether the signature check itself succeeded.
  */
-static bool EvalChecksig(const valtype& sig, const valtype& pubkey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
+static bool EvalChecksig(const StackElement& sig, const StackElement& pubkey, CScript::const_iterator pbegincodehash, CScript::const_iterator pend, ScriptExecutionData& execdata, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror, bool& success)
 {
     switch (sigversion) {
     case SigVersion::BASE:
@@ -404,15 +495,12 @@ static bool EvalChecksig(const valtype& sig, const valtype& pubkey, CScript::con
     assert(false);
 }
 
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+static bool EvalScript(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
 {
     static const CScriptNum bnZero(0);
     static const CScriptNum bnOne(1);
     // static const CScriptNum bnFalse(0);
     // static const CScriptNum bnTrue(1);
-    static const valtype vchFalse(0);
-    // static const valtype vchZero(0);
-    static const valtype vchTrue(1, 1);
 
     // sigversion cannot be TAPROOT here, as it admits no script execution.
     assert(sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0 || sigversion == SigVersion::TAPSCRIPT);
@@ -423,7 +511,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     opcodetype opcode;
     valtype vchPushValue;
     ConditionStack vfExec;
-    std::vector<valtype> altstack;
+    ScriptStack altstack{stack.get_allocator()};
     set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
     if ((sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) && script.size() > MAX_SCRIPT_SIZE) {
         return set_error(serror, SCRIPT_ERR_SCRIPT_SIZE);
@@ -479,7 +567,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 if (fRequireMinimal && !CheckMinimalPush(vchPushValue, opcode)) {
                     return set_error(serror, SCRIPT_ERR_MINIMALDATA);
                 }
-                stack.push_back(vchPushValue);
+                stack.emplace_back(vchPushValue.begin(), vchPushValue.end());
             } else if (fExec || (OP_IF <= opcode && opcode <= OP_ENDIF))
             switch (opcode)
             {
@@ -506,7 +594,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 {
                     // ( -- value)
                     CScriptNum bn((int)opcode - (int)(OP_1 - 1));
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                     // The result of these opcodes should always be the minimal way to push the data
                     // they push, so no need for a CheckMinimalPush here.
                 }
@@ -609,7 +697,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     {
                         if (stack.size() < 1)
                             return set_error(serror, SCRIPT_ERR_UNBALANCED_CONDITIONAL);
-                        valtype& vch = stacktop(-1);
+                        StackElement& vch = stacktop(-1);
                         // Tapscript requires minimal IF/NOTIF inputs as a consensus rule.
                         if (sigversion == SigVersion::TAPSCRIPT) {
                             // The input argument to the OP_IF and OP_NOTIF opcodes must be either
@@ -707,8 +795,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x1 x2 x1 x2)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-2);
-                    valtype vch2 = stacktop(-1);
+                    StackElement vch1 = stacktop(-2);
+                    StackElement vch2 = stacktop(-1);
                     stack.push_back(vch1);
                     stack.push_back(vch2);
                 }
@@ -719,9 +807,9 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 -- x1 x2 x3 x1 x2 x3)
                     if (stack.size() < 3)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-3);
-                    valtype vch2 = stacktop(-2);
-                    valtype vch3 = stacktop(-1);
+                    StackElement vch1 = stacktop(-3);
+                    StackElement vch2 = stacktop(-2);
+                    StackElement vch3 = stacktop(-1);
                     stack.push_back(vch1);
                     stack.push_back(vch2);
                     stack.push_back(vch3);
@@ -733,8 +821,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 x4 -- x1 x2 x3 x4 x1 x2)
                     if (stack.size() < 4)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-4);
-                    valtype vch2 = stacktop(-3);
+                    StackElement vch1 = stacktop(-4);
+                    StackElement vch2 = stacktop(-3);
                     stack.push_back(vch1);
                     stack.push_back(vch2);
                 }
@@ -745,8 +833,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 x4 x5 x6 -- x3 x4 x5 x6 x1 x2)
                     if (stack.size() < 6)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-6);
-                    valtype vch2 = stacktop(-5);
+                    StackElement vch1 = stacktop(-6);
+                    StackElement vch2 = stacktop(-5);
                     stack.erase(stack.end()-6, stack.end()-4);
                     stack.push_back(vch1);
                     stack.push_back(vch2);
@@ -768,7 +856,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x - 0 | x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
+                    StackElement vch = stacktop(-1);
                     if (CastToBool(vch))
                         stack.push_back(vch);
                 }
@@ -778,7 +866,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                 {
                     // -- stacksize
                     CScriptNum bn(stack.size());
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                 }
                 break;
 
@@ -796,7 +884,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x -- x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
+                    StackElement vch = stacktop(-1);
                     stack.push_back(vch);
                 }
                 break;
@@ -815,7 +903,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x1 x2 x1)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-2);
+                    StackElement vch = stacktop(-2);
                     stack.push_back(vch);
                 }
                 break;
@@ -831,7 +919,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     popstack(stack);
                     if (n < 0 || n >= (int)stack.size())
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-n-1);
+                    StackElement vch = stacktop(-n-1);
                     if (opcode == OP_ROLL)
                         stack.erase(stack.end()-n-1);
                     stack.push_back(vch);
@@ -864,7 +952,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x2 x1 x2)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
+                    StackElement vch = stacktop(-1);
                     stack.insert(stack.end()-2, vch);
                 }
                 break;
@@ -876,7 +964,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
                     CScriptNum bn(stacktop(-1).size());
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                 }
                 break;
 
@@ -891,8 +979,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 - bool)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype& vch1 = stacktop(-2);
-                    valtype& vch2 = stacktop(-1);
+                    StackElement& vch1 = stacktop(-2);
+                    StackElement& vch2 = stacktop(-1);
                     bool fEqual = (vch1 == vch2);
                     // OP_NOTEQUAL is disabled because it would be too easy to say
                     // something like n != 1 and have some wiseguy pass in 1 with extra
@@ -901,7 +989,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     //    fEqual = !fEqual;
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back(fEqual ? vchTrue : vchFalse);
+                    pushbool(stack, fEqual);
                     if (opcode == OP_EQUALVERIFY)
                     {
                         if (fEqual)
@@ -938,7 +1026,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     default:            assert(!"invalid opcode"); break;
                     }
                     popstack(stack);
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
                 }
                 break;
 
@@ -987,7 +1075,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     }
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back(bn.getvch());
+                    pushnum(stack, bn);
 
                     if (opcode == OP_NUMEQUALVERIFY)
                     {
@@ -1011,7 +1099,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     popstack(stack);
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back(fValue ? vchTrue : vchFalse);
+                    pushbool(stack, fValue);
                 }
                 break;
 
@@ -1028,20 +1116,21 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (in -- hash)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype& vch = stacktop(-1);
-                    valtype vchHash((opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32);
+                    StackElement& vch = stacktop(-1);
+                    unsigned char vchHash[CSHA256::OUTPUT_SIZE];
+                    const size_t nHashSize = (opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32;
                     if (opcode == OP_RIPEMD160)
-                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(vchHash);
                     else if (opcode == OP_SHA1)
-                        CSHA1().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CSHA1().Write(vch.data(), vch.size()).Finalize(vchHash);
                     else if (opcode == OP_SHA256)
-                        CSHA256().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CSHA256().Write(vch.data(), vch.size()).Finalize(vchHash);
                     else if (opcode == OP_HASH160)
-                        CHash160().Write(vch).Finalize(vchHash);
+                        CHash160().Write(vch).Finalize({vchHash, nHashSize});
                     else if (opcode == OP_HASH256)
                         CHash256().Write(vch).Finalize(vchHash);
-                    popstack(stack);
-                    stack.push_back(vchHash);
+                    // Replace the input by its hash, in the storage of the input.
+                    vch.assign(vchHash, vchHash + nHashSize);
                 }
                 break;
 
@@ -1063,14 +1152,14 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
 
-                    valtype& vchSig    = stacktop(-2);
-                    valtype& vchPubKey = stacktop(-1);
+                    StackElement& vchSig    = stacktop(-2);
+                    StackElement& vchPubKey = stacktop(-1);
 
                     bool fSuccess = true;
                     if (!EvalChecksig(vchSig, vchPubKey, pbegincodehash, pend, execdata, flags, checker, sigversion, serror, fSuccess)) return false;
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back(fSuccess ? vchTrue : vchFalse);
+                    pushbool(stack, fSuccess);
                     if (opcode == OP_CHECKSIGVERIFY)
                     {
                         if (fSuccess)
@@ -1094,8 +1183,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
 
-                    valtype& vchSig    = stacktop(-2);
-                    valtype& vchPubKey = stacktop(-1);
+                    StackElement& vchSig    = stacktop(-2);
+                    StackElement& vchPubKey = stacktop(-1);
 
                     bool fSuccess = checker.CheckMuSig2Signature(vchSig, vchPubKey, sigversion, execdata, serror);
                     if (!fSuccess && (flags & SCRIPT_VERIFY_NULLFAIL) && vchSig.size())
@@ -1103,7 +1192,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
 
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back(fSuccess ? vchTrue : vchFalse);
+                    pushbool(stack, fSuccess);
                 }
                 break;
 
@@ -1139,16 +1228,16 @@ case OP_CHECKSIGADD:
                     // (sig num pubkey -- num)
                     if (stack.size() < 3) return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
 
-                    const valtype& sig = stacktop(-3);
+                    const StackElement& sig = stacktop(-3);
                     const CScriptNum num(stacktop(-2), fRequireMinimal);
-                    const valtype& pubkey = stacktop(-1);
+                    const StackElement& pubkey = stacktop(-1);
 
                     bool success = true;
                     if (!EvalChecksig(sig, pubkey, pbegincodehash, pend, execdata, flags, checker, sigversion, serror, success)) return false;
                     popstack(stack);
                     popstack(stack);
                     popstack(stack);
-                    stack.push_back((num + (success ? 1 : 0)).getvch());
+                    pushnum(stack, num + (success ? 1 : 0));
                 }
                 break;
 
@@ -1191,9 +1280,9 @@ case OP_CHECKSIGADD:
                     // Drop the signature in pre-segwit scripts but not segwit scripts
                     for (int k = 0; k < nSigsCount; k++)
                     {
-                        valtype& vchSig = stacktop(-isig-k);
+                        StackElement& vchSig = stacktop(-isig-k);
                         if (sigversion == SigVersion::BASE) {
-                            int found = FindAndDelete(scriptCode, CScript() << vchSig);
+                            int found = FindAndDelete(scriptCode, CScript() << ToValtype(vchSig));
                             if (found > 0 && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
                                 return set_error(serror, SCRIPT_ERR_SIG_FINDANDDELETE);
                         }
@@ -1202,8 +1291,8 @@ case OP_CHECKSIGADD:
                     bool fSuccess = true;
                     while (fSuccess && nSigsCount > 0)
                     {
-                        valtype& vchSig    = stacktop(-isig);
-                        valtype& vchPubKey = stacktop(-ikey);
+                        StackElement& vchSig    = stacktop(-isig);
+                        StackElement& vchPubKey = stacktop(-ikey);
 
                         // Note how this makes the exact order of pubkey/signature evaluation
                         // distinguishable by CHECKMULTISIG NOT if the STRICTENC flag is set.
@@ -1214,7 +1303,7 @@ case OP_CHECKSIGADD:
                         }
 
                         // Check signature
-                        bool fOk = checker.CheckECDSASignature(vchSig, vchPubKey, scriptCode, sigversion);
+                        bool fOk = checker.CheckECDSASignature(ToValtype(vchSig), ToValtype(vchPubKey), scriptCode, sigversion);
 
                         if (fOk) {
                             isig++;
@@ -1252,7 +1341,7 @@ case OP_CHECKSIGADD:
                         return set_error(serror, SCRIPT_ERR_SIG_NULLDUMMY);
                     popstack(stack);
 
-                    stack.push_back(fSuccess ? vchTrue : vchFalse);
+                    pushbool(stack, fSuccess);
 
                     if (opcode == OP_CHECKMULTISIGVERIFY)
                     {
@@ -1284,6 +1373,23 @@ case OP_CHECKSIGADD:
     return set_success(serror);
 }
 
+static bool EvalScript(ScriptStack& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
+{
+    ScriptExecutionData execdata;
+    return EvalScript(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
+bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+{
+    const ScriptArenaScope arena_scope;
+    ScriptStack script_stack{arena_scope.MakeStack()};
+    for (const valtype& vch : stack) script_stack.emplace_back(vch.begin(), vch.end());
+    const bool ret{EvalScript(script_stack, script, flags, checker, sigversion, execdata, serror)};
+    stack.clear();
+    for (const StackElement& vch : script_stack) stack.emplace_back(vch.begin(), vch.end());
+    return ret;
+}
+
 bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
 {
     ScriptExecutionData execdata;
@@ -1778,7 +1884,7 @@ bool GenericTransactionSignatureChecker<T>::CheckMuSig2Signature(
     }
 
     // MuSig2는 일반 Schnorr과 동일한 검증 방식 (현재 구현에서는 비구분 처리 가능)
-    if (!pubkey.VerifySchnorr(sighash, sig)) {
+    if (!VerifySchnorrSignature(sig, pubkey, sighash)) {
         return set_error(serror, SCRIPT_ERR_SCHNORR_SIG);
     }
 
@@ -1875,7 +1981,10 @@ template class GenericTransactionSignatureChecker<CMutableTransaction>;
 
 static bool ExecuteWitnessScript(const Span<const valtype>& stack_span, const CScript& exec_script, unsigned int flags, SigVersion sigversion, const BaseSignatureChecker& checker, ScriptExecutionData& execdata, ScriptError* serror)
 {
-    std::vector<valtype> stack{stack_span.begin(), stack_span.end()};
+    const ScriptArenaScope arena_scope;
+    ScriptStack stack{arena_scope.MakeStack()};
+    stack.reserve(stack_span.size());
+    for (const valtype& elem : stack_span) stack.emplace_back(elem.begin(), elem.end());
 
     if (sigversion == SigVersion::TAPSCRIPT) {
         // OP_SUCCESSx processing overrides everything, including stack element size limits
@@ -1900,7 +2009,7 @@ static bool ExecuteWitnessScript(const Span<const valtype>& stack_span, const CS
     }
 
     // Disallow stack item size > MAX_SCRIPT_ELEMENT_SIZE in witness stack
-    for (const valtype& elem : stack) {
+    for (const StackElement& elem : stack) {
         if (elem.size() > MAX_SCRIPT_ELEMENT_SIZE) return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
     }
 
@@ -2041,7 +2150,100 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
     // There is intentionally no return statement here, to be able to use "control reaches end of non-void function" warnings to detect gaps in the logic above.
 }
 
+/**
+ * Verify a spend of a P2TR output by its key path, or of a P2WPKH or P2PKH output, going straight to
+ * its signature check instead of running the scripts through EvalScript. Except for the copies of
+ * the two scriptSig pushes of a P2PKH spend, nothing is allocated on the heap.
+ *
+ * Returns std::nullopt for any other spend, and for those whose outcome depends on parts of the
+ * interpreter skipped here (a malleated scriptSig, a mismatching key hash, ...), which are left to
+ * VerifyScriptWithInterpreter. Otherwise, the result and serror are the ones it would produce.
+ */
+static std::optional<bool> VerifyStandardSpend(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness& witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    if (scriptPubKey.size() == 2 + WITNESS_V1_TAPROOT_SIZE && scriptPubKey[0] == OP_1 && scriptPubKey[1] == WITNESS_V1_TAPROOT_SIZE) {
+        // P2TR key path: OP_1 <32-byte output key>, with only a signature and no annex in the witness.
+        const Span<const unsigned char> program{scriptPubKey.data() + 2, WITNESS_V1_TAPROOT_SIZE};
+        if (!(flags & SCRIPT_VERIFY_WITNESS) || !(flags & SCRIPT_VERIFY_TAPROOT)) return std::nullopt;
+        if (!scriptSig.empty() || witness.stack.size() != 1 || !CastToBool(program)) return std::nullopt;
+        ScriptExecutionData execdata;
+        execdata.m_annex_init = true;
+        execdata.m_annex_present = false;
+        if (!checker.CheckSchnorrSignature(witness.stack[0], program, SigVersion::TAPROOT, execdata, serror)) {
+            return false; // serror is set
+        }
+        return set_success(serror);
+    }
+
+    if (scriptPubKey.size() == 2 + WITNESS_V0_KEYHASH_SIZE && scriptPubKey[0] == OP_0 && scriptPubKey[1] == WITNESS_V0_KEYHASH_SIZE) {
+        // P2WPKH: OP_0 <20-byte key hash>, with a signature and the hashed public key in the witness.
+        const Span<const unsigned char> program{scriptPubKey.data() + 2, WITNESS_V0_KEYHASH_SIZE};
+        if (!(flags & SCRIPT_VERIFY_WITNESS)) return std::nullopt;
+        if (!scriptSig.empty() || witness.stack.size() != 2 || !CastToBool(program)) return std::nullopt;
+        const valtype& sig{witness.stack[0]};
+        const valtype& pubkey{witness.stack[1]};
+        if (sig.size() > MAX_SCRIPT_ELEMENT_SIZE || pubkey.size() > MAX_SCRIPT_ELEMENT_SIZE) return std::nullopt;
+        if (Hash160(pubkey) != uint160{program}) return std::nullopt;
+        // The implied P2PKH script, which fits a CScript without allocating.
+        CScript script_code;
+        script_code << OP_DUP << OP_HASH160;
+        script_code.push_back(WITNESS_V0_KEYHASH_SIZE);
+        script_code.insert(script_code.end(), program.begin(), program.end());
+        script_code << OP_EQUALVERIFY << OP_CHECKSIG;
+        bool success{false};
+        if (!CheckECDSASignaturePreTapscript(sig, pubkey, script_code, flags, checker, SigVersion::WITNESS_V0, serror, success)) {
+            return false; // serror is set
+        }
+        if (!success) return set_error(serror, SCRIPT_ERR_EVAL_FALSE);
+        return set_success(serror);
+    }
+
+    if (scriptPubKey.size() == 25 && scriptPubKey[0] == OP_DUP && scriptPubKey[1] == OP_HASH160 && scriptPubKey[2] == 20 &&
+        scriptPubKey[23] == OP_EQUALVERIFY && scriptPubKey[24] == OP_CHECKSIG) {
+        // P2PKH: OP_DUP OP_HASH160 <20-byte key hash> OP_EQUALVERIFY OP_CHECKSIG, with a signature and
+        // the hashed public key pushed by the scriptSig. Only direct pushes of at least 2 bytes are
+        // taken, which are minimal encodings whatever the flags.
+        if ((flags & SCRIPT_VERIFY_WITNESS) && !witness.IsNull()) return std::nullopt;
+        valtype sig, pubkey;
+        CScript::const_iterator pc{scriptSig.begin()};
+        opcodetype opcode;
+        if (!scriptSig.GetOp(pc, opcode, sig) || opcode < 2 || opcode > 75) return std::nullopt;
+        if (!scriptSig.GetOp(pc, opcode, pubkey) || opcode < 2 || opcode > 75 || pc != scriptSig.end()) return std::nullopt;
+        if (Hash160(pubkey) != uint160{Span<const unsigned char>{scriptPubKey.data() + 3, 20}}) return std::nullopt;
+        // FindAndDelete() only matches the push of the signature at an opcode boundary of the
+        // scriptPubKey. The only one it could be found at is the push of the 20-byte key hash.
+        if (sig.size() == 20) return std::nullopt;
+        bool success{false};
+        if (!CheckECDSASignaturePreTapscript(sig, pubkey, scriptPubKey, flags, checker, SigVersion::BASE, serror, success)) {
+            return false; // serror is set
+        }
+        if (!success) return set_error(serror, SCRIPT_ERR_EVAL_FALSE);
+        return set_success(serror);
+    }
+
+    return std::nullopt;
+}
+
 bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    static const CScriptWitness emptyWitness;
+    if (witness == nullptr) {
+        witness = &emptyWitness;
+    }
+
+    set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
+
+    if ((flags & SCRIPT_VERIFY_SIGPUSHONLY) != 0 && !scriptSig.IsPushOnly()) {
+        return set_error(serror, SCRIPT_ERR_SIG_PUSHONLY);
+    }
+
+    if (const auto result{VerifyStandardSpend(scriptSig, scriptPubKey, *witness, flags, checker, serror)}) {
+        return *result;
+    }
+    return VerifyScriptWithInterpreter(scriptSig, scriptPubKey, witness, flags, checker, serror);
+}
+
+bool VerifyScriptWithInterpreter(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
 {
     static const CScriptWitness emptyWitness;
     if (witness == nullptr) {
@@ -2057,7 +2259,8 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
 
     // scriptSig and scriptPubKey must be evaluated sequentially on the same stack
     // rather than being simply concatenated (see CVE-2010-5141)
-    std::vector<std::vector<unsigned char> > stack, stackCopy;
+    const ScriptArenaScope arena_scope;
+    ScriptStack stack{arena_scope.MakeStack()}, stackCopy{arena_scope.MakeStack()};
     if (!EvalScript(stack, scriptSig, flags, checker, SigVersion::BASE, serror))
         // serror is set
         return false;
@@ -2105,8 +2308,8 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
         // an empty stack and the EvalScript above would return false.
         assert(!stack.empty());
 
-        const valtype& pubKeySerialized = stack.back();
-        CScript pubKey2(pubKeySerialized.begin(), pubKeySerialized.end());
+        const StackElement& pubKeySerialized = stack.back();
+        CScript pubKey2(pubKeySerialized.data(), pubKeySerialized.data() + pubKeySerialized.size());
         popstack(stack);
 
         if (!EvalScript(stack, pubKey2, flags, checker, SigVersion::BASE, serror))
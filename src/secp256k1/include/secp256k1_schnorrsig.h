@@ -183,6 +183,34 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify(
     const secp256k1_xonly_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
 
+/** Verify a batch of Schnorr signatures on 32-byte messages.
+ *
+ *  The signatures are checked at once with a single multi-multiplication over
+ *  randomized linear combinations of their verification equations, which is
+ *  considerably cheaper than verifying them one by one. The randomizers are
+ *  derived from a hash of all inputs. A failing batch does not tell which
+ *  signature is invalid: use secp256k1_schnorrsig_verify for that.
+ *
+ *  Returns: 1: all signatures are correct (or n is 0)
+ *           0: at least one signature is incorrect
+ *  Args:    ctx: a secp256k1 context object.
+ *       scratch: scratch space for the multi-multiplication. Can be NULL, in
+ *                which case the points are multiplied one by one, which is
+ *                no faster than individual verification.
+ *  In:    sig64: array of n pointers to 64-byte signatures.
+ *         msg32: array of n pointers to 32-byte messages.
+ *       pubkeys: array of n pointers to x-only public keys.
+ *             n: number of signatures.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_batch(
+    const secp256k1_context *ctx,
+    secp256k1_scratch_space *scratch,
+    const unsigned char * const *sig64,
+    const unsigned char * const *msg32,
+    const secp256k1_xonly_pubkey * const *pubkeys,
+    size_t n
+) SECP256K1_ARG_NONNULL(1);
+
 #ifdef __cplusplus
 }
 #endif
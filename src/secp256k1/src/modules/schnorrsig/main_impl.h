@@ -264,4 +264,122 @@ int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned cha
            secp256k1_fe_equal(&rx, &r.x);
 }
 
+typedef struct {
+    const secp256k1_context *ctx;
+    const unsigned char * const *sig64;
+    const unsigned char * const *msg32;
+    const secp256k1_xonly_pubkey * const *pubkeys;
+    /* Hash of all signatures, messages and public keys of the batch. */
+    unsigned char seed[32];
+} secp256k1_schnorrsig_batch_data;
+
+/* The randomizer of the i'th verification equation: 1 for the first one, and
+ * SHA256(seed || i) for the others. */
+static void secp256k1_schnorrsig_batch_randomizer(secp256k1_scalar *a, const unsigned char *seed, size_t i) {
+    secp256k1_sha256 sha;
+    unsigned char buf[32];
+    unsigned char idx[8];
+    int j;
+
+    if (i == 0) {
+        secp256k1_scalar_set_int(a, 1);
+        return;
+    }
+    for (j = 0; j < 8; j++) {
+        idx[j] = (unsigned char)((uint64_t)i >> (56 - 8 * j));
+    }
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, seed, 32);
+    secp256k1_sha256_write(&sha, idx, sizeof(idx));
+    secp256k1_sha256_finalize(&sha, buf);
+    secp256k1_scalar_set_b32(a, buf, NULL);
+}
+
+/* Point 2i of the multi-multiplication is R_i with scalar a_i, point 2i+1 is
+ * P_i with scalar a_i*e_i. */
+static int secp256k1_schnorrsig_batch_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_schnorrsig_batch_data *batch = (const secp256k1_schnorrsig_batch_data *)data;
+    size_t i = idx / 2;
+    secp256k1_scalar a;
+
+    secp256k1_schnorrsig_batch_randomizer(&a, batch->seed, i);
+    if (idx % 2 == 0) {
+        secp256k1_fe rx;
+        if (!secp256k1_fe_set_b32_limit(&rx, &batch->sig64[i][0])) {
+            return 0;
+        }
+        if (!secp256k1_ge_set_xo_var(pt, &rx, 0)) {
+            return 0;
+        }
+        *sc = a;
+    } else {
+        secp256k1_scalar e;
+        unsigned char buf[32];
+        if (!secp256k1_xonly_pubkey_load(batch->ctx, pt, batch->pubkeys[i])) {
+            return 0;
+        }
+        secp256k1_fe_get_b32(buf, &pt->x);
+        secp256k1_schnorrsig_challenge(&e, &batch->sig64[i][0], batch->msg32[i], 32, buf);
+        secp256k1_scalar_mul(sc, &a, &e);
+    }
+    return 1;
+}
+
+int secp256k1_schnorrsig_verify_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, const unsigned char * const *sig64, const unsigned char * const *msg32, const secp256k1_xonly_pubkey * const *pubkeys, size_t n) {
+    secp256k1_schnorrsig_batch_data batch;
+    secp256k1_sha256 sha;
+    secp256k1_scalar s_sum;
+    secp256k1_gej rj;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n == 0 || sig64 != NULL);
+    ARG_CHECK(n == 0 || msg32 != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+    /* Two points per signature are passed to the multi-multiplication. */
+    ARG_CHECK(n <= SIZE_MAX / 2);
+
+    if (n == 0) {
+        return 1;
+    }
+
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(sig64[i] != NULL);
+        ARG_CHECK(msg32[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+        secp256k1_sha256_write(&sha, sig64[i], 64);
+        secp256k1_sha256_write(&sha, msg32[i], 32);
+        secp256k1_sha256_write(&sha, pubkeys[i]->data, sizeof(pubkeys[i]->data));
+    }
+    secp256k1_sha256_finalize(&sha, batch.seed);
+    batch.ctx = ctx;
+    batch.sig64 = sig64;
+    batch.msg32 = msg32;
+    batch.pubkeys = pubkeys;
+
+    /* Compute -sum(a_i*s_i), the scalar of the generator. */
+    secp256k1_scalar_clear(&s_sum);
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar s;
+        secp256k1_scalar a;
+        int overflow;
+        secp256k1_scalar_set_b32(&s, &sig64[i][32], &overflow);
+        if (overflow) {
+            return 0;
+        }
+        secp256k1_schnorrsig_batch_randomizer(&a, batch.seed, i);
+        secp256k1_scalar_mul(&s, &s, &a);
+        secp256k1_scalar_add(&s_sum, &s_sum, &s);
+    }
+    secp256k1_scalar_negate(&s_sum, &s_sum);
+
+    /* sum(a_i*R_i) + sum(a_i*e_i*P_i) - sum(a_i*s_i)*G is infinity if all
+     * signatures are valid, and otherwise only with negligible probability. */
+    if (!secp256k1_ecmult_multi_var(&ctx->error_callback, scratch, &rj, &s_sum, secp256k1_schnorrsig_batch_callback, &batch, 2 * n)) {
+        return 0;
+    }
+    return secp256k1_gej_is_infinity(&rj);
+}
+
 #endif
@@ -891,10 +891,14 @@ static void test_schnorrsig_sign_verify(void) {
     unsigned char sk[32];
     unsigned char msg[N_SIGS][32];
     unsigned char sig[N_SIGS][64];
+    const unsigned char *sig_ptr[N_SIGS];
+    const unsigned char *msg_ptr[N_SIGS];
+    const secp256k1_xonly_pubkey *pk_ptr[N_SIGS];
     size_t i;
     secp256k1_keypair keypair;
     secp256k1_xonly_pubkey pk;
     secp256k1_scalar s;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(CTX, 1 << 16);
 
     secp256k1_testrand256(sk);
     CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
@@ -904,31 +908,43 @@ static void test_schnorrsig_sign_verify(void) {
         secp256k1_testrand256(msg[i]);
         CHECK(secp256k1_schnorrsig_sign32(CTX, sig[i], msg[i], &keypair, NULL));
         CHECK(secp256k1_schnorrsig_verify(CTX, sig[i], msg[i], sizeof(msg[i]), &pk));
+        sig_ptr[i] = sig[i];
+        msg_ptr[i] = msg[i];
+        pk_ptr[i] = &pk;
     }
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, scratch, NULL, NULL, NULL, 0));
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, scratch, sig_ptr, msg_ptr, pk_ptr, N_SIGS));
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, NULL, sig_ptr, msg_ptr, pk_ptr, N_SIGS));
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, scratch, sig_ptr, msg_ptr, pk_ptr, 1));
 
     {
         /* Flip a few bits in the signature and in the message and check that
-         * verify and verify_batch (TODO) fail */
+         * verify and verify_batch fail */
         size_t sig_idx = secp256k1_testrand_int(N_SIGS);
         size_t byte_idx = secp256k1_testrand_bits(5);
         unsigned char xorbyte = secp256k1_testrand_int(254)+1;
         sig[sig_idx][byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, scratch, sig_ptr, msg_ptr, pk_ptr, N_SIGS));
         sig[sig_idx][byte_idx] ^= xorbyte;
 
         byte_idx = secp256k1_testrand_bits(5);
         sig[sig_idx][32+byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, scratch, sig_ptr, msg_ptr, pk_ptr, N_SIGS));
         sig[sig_idx][32+byte_idx] ^= xorbyte;
 
         byte_idx = secp256k1_testrand_bits(5);
         msg[sig_idx][byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, scratch, sig_ptr, msg_ptr, pk_ptr, N_SIGS));
         msg[sig_idx][byte_idx] ^= xorbyte;
 
         /* Check that above bitflips have been reversed correctly */
         CHECK(secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(secp256k1_schnorrsig_verify_batch(CTX, scratch, sig_ptr, msg_ptr, pk_ptr, N_SIGS));
     }
+    secp256k1_scratch_space_destroy(CTX, scratch);
 
     /* Test overflowing s */
     CHECK(secp256k1_schnorrsig_sign32(CTX, sig[0], msg[0], &keypair, NULL));
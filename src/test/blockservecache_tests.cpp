@@ -0,0 +1,71 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockservecache.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+using node::BlockServeCache;
+
+namespace {
+std::shared_ptr<const SharedNetMsgPayload> MakePayload(size_t size)
+{
+    return std::make_shared<const SharedNetMsgPayload>(g_insecure_rand_ctx.randbytes<uint8_t>(size));
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(blockservecache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(lru_eviction)
+{
+    BlockServeCache cache{1000};
+    const uint256 hash_a{InsecureRand256()}, hash_b{InsecureRand256()}, hash_c{InsecureRand256()};
+
+    // With and without witness are separate entries.
+    cache.Insert(hash_a, /*witness=*/true, MakePayload(400));
+    BOOST_CHECK(!cache.Get(hash_a, /*witness=*/false));
+    cache.Insert(hash_a, /*witness=*/false, MakePayload(300));
+    BOOST_CHECK(cache.Get(hash_a, /*witness=*/true));
+    BOOST_CHECK(cache.Get(hash_a, /*witness=*/false));
+
+    // Touch the witness entry, so that the non-witness one is least recently used.
+    BOOST_CHECK(cache.Get(hash_a, /*witness=*/true));
+    cache.Insert(hash_b, /*witness=*/true, MakePayload(500));
+    BOOST_CHECK(cache.Get(hash_a, /*witness=*/true));
+    BOOST_CHECK(!cache.Get(hash_a, /*witness=*/false));
+    BOOST_CHECK(cache.Get(hash_b, /*witness=*/true));
+
+    // Entries larger than the whole budget are not cached and don't evict anything.
+    cache.Insert(hash_c, /*witness=*/true, MakePayload(1001));
+    BOOST_CHECK(!cache.Get(hash_c, /*witness=*/true));
+
+    const auto stats{cache.GetStats()};
+    BOOST_CHECK_EQUAL(stats.entries, 2U);
+    BOOST_CHECK_EQUAL(stats.usage, 900U);
+    BOOST_CHECK_EQUAL(stats.max_usage, 1000U);
+    BOOST_CHECK_EQUAL(stats.hits, 5U);
+    BOOST_CHECK_EQUAL(stats.misses, 3U);
+    BOOST_CHECK_EQUAL(stats.evictions, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(shared_payload)
+{
+    BlockServeCache cache{1 << 20};
+    const uint256 hash{InsecureRand256()};
+    auto payload{MakePayload(1000)};
+    cache.Insert(hash, /*witness=*/true, payload);
+    // A hit hands out the very same bytes, not a copy.
+    BOOST_CHECK(cache.Get(hash, /*witness=*/true) == payload);
+    // Inserting again keeps the existing entry.
+    cache.Insert(hash, /*witness=*/true, MakePayload(1000));
+    BOOST_CHECK(cache.Get(hash, /*witness=*/true) == payload);
+    BOOST_CHECK_EQUAL(cache.GetStats().usage, 1000U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
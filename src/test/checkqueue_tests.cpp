@@ -135,6 +135,37 @@ struct FrozenCleanupCheck {
     }
 };
 
+/** Batch of BatchedChecks, failing to verify if any of them was meant to fail. */
+struct FakeBatch {
+    static std::atomic<size_t> n_verified;
+    size_t n_added{0};
+    bool fails{false};
+    bool empty() const { return n_added == 0; }
+    bool Verify()
+    {
+        n_verified.fetch_add(n_added, std::memory_order_relaxed);
+        const bool ok{!fails};
+        n_added = 0;
+        fails = false;
+        return ok;
+    }
+};
+
+struct BatchedCheck {
+    bool fails;
+    BatchedCheck(bool fails_in) : fails(fails_in){};
+    bool operator()() const
+    {
+        return !fails;
+    }
+    bool operator()(FakeBatch& batch) const
+    {
+        ++batch.n_added;
+        batch.fails |= fails;
+        return true;
+    }
+};
+
 // Static Allocations
 std::mutex FrozenCleanupCheck::m{};
 std::atomic<uint64_t> FrozenCleanupCheck::nFrozen{0};
@@ -143,6 +174,7 @@ Mutex UniqueCheck::m;
 std::unordered_multiset<size_t> UniqueCheck::results;
 std::atomic<size_t> FakeCheckCheckCompletion::n_calls{0};
 std::atomic<size_t> MemoryCheck::fake_allocated_memory{0};
+std::atomic<size_t> FakeBatch::n_verified{0};
 
 // Queue Typedefs
 typedef CCheckQueue<FakeCheckCheckCompletion> Correct_Queue;
@@ -151,6 +183,7 @@ typedef CCheckQueue<FailingCheck> Failing_Queue;
 typedef CCheckQueue<UniqueCheck> Unique_Queue;
 typedef CCheckQueue<MemoryCheck> Memory_Queue;
 typedef CCheckQueue<FrozenCleanupCheck> FrozenCleanup_Queue;
+typedef CCheckQueue<BatchedCheck, FakeBatch> Batched_Queue;
 
 
 /** This test case checks that the CCheckQueue works properly
@@ -429,4 +462,33 @@ BOOST_AUTO_TEST_CASE(test_CheckQueueControl_Locks)
         }
     }
 }
+/** Test that the checks deferred to the workers' batches are all verified before Wait returns,
+ * and that a failing batch fails the whole queue.
+ */
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Batches)
+{
+    for (const int threads : {0, SCRIPT_CHECK_THREADS}) {
+        auto queue = std::make_unique<Batched_Queue>(QUEUE_BATCH_SIZE);
+        queue->StartWorkerThreads(threads);
+        for (const size_t total : {1, 100, 1000, 10000}) {
+            for (const bool fails : {false, true}) {
+                FakeBatch::n_verified = 0;
+                const size_t failing{(size_t)InsecureRandRange(total)};
+                CCheckQueueControl<BatchedCheck, FakeBatch> control(queue.get());
+                for (size_t i = 0; i < total;) {
+                    std::vector<BatchedCheck> checks;
+                    for (size_t r = InsecureRandRange(10) + 1; r > 0 && i < total; --r, ++i) {
+                        checks.emplace_back(fails && i == failing);
+                    }
+                    control.Add(std::move(checks));
+                }
+                BOOST_CHECK_EQUAL(control.Wait(), !fails);
+                // Workers may skip checks once a failure is known.
+                if (!fails) BOOST_CHECK_EQUAL(FakeBatch::n_verified, total);
+            }
+        }
+        queue->StopWorkerThreads();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <cluster_linearize.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using namespace cluster_linearize;
+
+BOOST_FIXTURE_TEST_SUITE(cluster_linearize_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(linearize_and_chunk)
+{
+    // A low fee parent with a high fee child, and an unrelated medium fee transaction.
+    const std::vector<ClusterTx> cpfp{
+        {/*fee=*/100, /*size=*/100, {}},
+        {/*fee=*/10000, /*size=*/100, {0}},
+        {/*fee=*/3000, /*size=*/100, {}},
+    };
+    const auto cpfp_lin{Linearize(cpfp)};
+    BOOST_CHECK((cpfp_lin == std::vector<uint32_t>{0, 1, 2}));
+    const auto cpfp_chunks{ChunkLinearization(cpfp, cpfp_lin)};
+    BOOST_REQUIRE_EQUAL(cpfp_chunks.size(), 2U);
+    BOOST_CHECK_EQUAL(cpfp_chunks[0].fee, 10100);
+    BOOST_CHECK_EQUAL(cpfp_chunks[0].size, 200);
+    BOOST_CHECK_EQUAL(cpfp_chunks[0].end, 2U);
+    BOOST_CHECK_EQUAL(cpfp_chunks[1].begin, 2U);
+
+    // Without the child's fee, the medium fee transaction goes first.
+    const std::vector<ClusterTx> no_cpfp{
+        {/*fee=*/100, /*size=*/100, {}},
+        {/*fee=*/200, /*size=*/100, {0}},
+        {/*fee=*/3000, /*size=*/100, {}},
+    };
+    const auto no_cpfp_lin{Linearize(no_cpfp)};
+    BOOST_CHECK((no_cpfp_lin == std::vector<uint32_t>{2, 0, 1}));
+    const auto no_cpfp_chunks{ChunkLinearization(no_cpfp, no_cpfp_lin)};
+    // The child pays for its parent, so they are one chunk.
+    BOOST_REQUIRE_EQUAL(no_cpfp_chunks.size(), 2U);
+    BOOST_CHECK_EQUAL(no_cpfp_chunks[1].fee, 300);
+
+    // Too large clusters keep their order.
+    std::vector<ClusterTx> chain(MAX_LINEARIZATION_SEARCH + 1);
+    for (uint32_t i = 0; i < chain.size(); ++i) {
+        chain[i] = {/*fee=*/i, /*size=*/100, {}};
+        if (i > 0) chain[i].parents.push_back(i - 1);
+    }
+    const auto chain_lin{Linearize(chain)};
+    for (uint32_t i = 0; i < chain_lin.size(); ++i) BOOST_CHECK_EQUAL(chain_lin[i], i);
+    // With ever increasing feerates, the whole chain is a single chunk.
+    BOOST_CHECK_EQUAL(ChunkLinearization(chain, chain_lin).size(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_chunk_feerate)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    CMutableTransaction parent;
+    parent.vin.resize(1);
+    parent.vin[0].scriptSig = CScript() << OP_11;
+    parent.vout.resize(2);
+    for (auto& out : parent.vout) {
+        out.scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        out.nValue = 10 * COIN;
+    }
+    pool.addUnchecked(entry.Fee(100).FromTx(parent));
+    const auto parent_it{*pool.GetIter(parent.GetHash())};
+    BOOST_CHECK(pool.GetChunkFeerate(parent_it) == CFeeRate(100, parent_it->GetTxSize()));
+
+    CMutableTransaction child;
+    child.vin.resize(1);
+    child.vin[0].prevout = COutPoint(parent.GetHash(), 0);
+    child.vin[0].scriptSig = CScript() << OP_11;
+    child.vout.resize(1);
+    child.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    child.vout[0].nValue = 10 * COIN;
+    pool.addUnchecked(entry.Fee(100000).FromTx(child));
+    const auto child_it{*pool.GetIter(child.GetHash())};
+
+    // The child pays for its parent: both are mined at their combined feerate.
+    const CFeeRate combined(100 + 100000, parent_it->GetTxSize() + child_it->GetTxSize());
+    BOOST_CHECK(pool.GetChunkFeerate(parent_it) == combined);
+    BOOST_CHECK(pool.GetChunkFeerate(child_it) == combined);
+    const auto cluster{pool.GetCluster(child_it)};
+    BOOST_REQUIRE_EQUAL(cluster.txs.size(), 2U);
+    BOOST_CHECK(cluster.txs[0] == parent_it);
+    BOOST_CHECK_EQUAL(pool.GetAllClusters().size(), 1U);
+
+    // Prioritisation counts.
+    pool.PrioritiseTransaction(child.GetHash(), -100000);
+    BOOST_CHECK(pool.GetChunkFeerate(parent_it) == CFeeRate(100, parent_it->GetTxSize()));
+    BOOST_CHECK(pool.GetChunkFeerate(child_it) == CFeeRate(0, child_it->GetTxSize()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1098,6 +1098,28 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256d80)
+{
+    // Exercise every multi-way implementation this CPU supports, not only the preferred one.
+    for (const auto impl : {sha256_implementation::STANDARD, sha256_implementation::USE_SSE4,
+                            sha256_implementation::USE_SSE4_AND_AVX2, sha256_implementation::USE_SSE4_AND_SHANI}) {
+        SHA256AutoDetect(impl);
+        for (int i = 0; i <= 20; ++i) {
+            unsigned char in[80 * 20];
+            unsigned char out1[32 * 20], out2[32 * 20];
+            for (int j = 0; j < 80 * i; ++j) {
+                in[j] = InsecureRandBits(8);
+            }
+            for (int j = 0; j < i; ++j) {
+                CHash256().Write({in + 80 * j, 80}).Finalize({out1 + 32 * j, 32});
+            }
+            SHA256D80(out2, in, i);
+            BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+        }
+    }
+    SHA256AutoDetect();
+}
+
 static void TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
@@ -164,6 +164,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "scantxoutset",
     "sendmsgtopeer", // when no peers are connected, no p2p message is sent
     "sendrawtransaction",
+    "sendrawtransactions",
     "setmocktime",
     "setnetworkactive",
     "signmessagewithprivkey",
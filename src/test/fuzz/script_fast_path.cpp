@@ -0,0 +1,113 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <hash.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <script/script_error.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+#include <test/util/script.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace {
+/** A signature checker whose answers only depend on what it is asked, so that both ways of verifying
+ *  a script get the same ones, and on everything it is asked, so that they must ask the same. */
+class DeterministicSignatureChecker : public BaseSignatureChecker
+{
+    static bool Answer(HashWriter& hasher)
+    {
+        return hasher.GetSHA256().GetUint64(0) & 1;
+    }
+
+public:
+    bool CheckECDSASignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const CScript& script_code, SigVersion sigversion) const override
+    {
+        if (sig.empty()) return false;
+        HashWriter hasher{};
+        hasher << sig << pubkey << script_code << static_cast<int>(sigversion);
+        return Answer(hasher);
+    }
+
+    bool CheckSchnorrSignature(Span<const unsigned char> sig, Span<const unsigned char> pubkey, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror) const override
+    {
+        assert(execdata.m_annex_init);
+        if (sig.size() != 64 && sig.size() != 65) {
+            if (serror) *serror = SCRIPT_ERR_SCHNORR_SIG_SIZE;
+            return false;
+        }
+        if (sig.size() == 65 && sig.back() == 0) {
+            if (serror) *serror = SCRIPT_ERR_SCHNORR_SIG_HASHTYPE;
+            return false;
+        }
+        HashWriter hasher{};
+        hasher << sig << pubkey << static_cast<int>(sigversion) << execdata.m_annex_present;
+        if (!Answer(hasher)) {
+            if (serror) *serror = SCRIPT_ERR_SCHNORR_SIG;
+            return false;
+        }
+        return true;
+    }
+
+    bool CheckLockTime(const CScriptNum& lock_time) const override { return lock_time.getint() & 1; }
+    bool CheckSequence(const CScriptNum& sequence) const override { return sequence.getint() & 1; }
+};
+
+std::vector<unsigned char> ConsumeElement(FuzzedDataProvider& provider)
+{
+    // Mostly sizes of signatures and public keys, but also some of the sizes they cannot have.
+    const size_t size{provider.PickValueInArray<size_t>({0, 1, 20, 32, 33, 64, 65, 71, 72, 73, 520, 521})};
+    return provider.ConsumeBool() ? provider.ConsumeBytes<unsigned char>(size) : ConsumeRandomLengthByteVector(provider, 600);
+}
+} // namespace
+
+FUZZ_TARGET(script_fast_path)
+{
+    FuzzedDataProvider provider(buffer.data(), buffer.size());
+    const unsigned int flags{provider.ConsumeIntegral<unsigned int>()};
+    if (!IsValidFlagCombination(flags)) return;
+
+    CScript script_sig;
+    CScript script_pubkey;
+    CScriptWitness witness;
+    std::vector<unsigned char> sig{ConsumeElement(provider)};
+    std::vector<unsigned char> pubkey{ConsumeElement(provider)};
+    // A key hash matching the public key, unless the fuzzer prefers otherwise.
+    std::vector<unsigned char> key_hash{ToByteVector(Hash160(pubkey))};
+    if (provider.ConsumeBool()) key_hash = provider.ConsumeBytes<unsigned char>(20);
+    switch (provider.ConsumeIntegralInRange(0, 3)) {
+    case 0:
+        script_pubkey << OP_0 << key_hash;
+        witness.stack = {sig, pubkey};
+        break;
+    case 1:
+        script_pubkey << OP_DUP << OP_HASH160 << key_hash << OP_EQUALVERIFY << OP_CHECKSIG;
+        script_sig << sig << pubkey;
+        break;
+    case 2:
+        script_pubkey << OP_1 << provider.ConsumeBytes<unsigned char>(32);
+        witness.stack = {sig};
+        break;
+    case 3:
+        script_pubkey = ConsumeScript(provider);
+        break;
+    }
+    // Scripts and witnesses slightly off the templates.
+    if (provider.ConsumeBool()) script_sig = ConsumeScript(provider);
+    while (provider.ConsumeBool()) witness.stack.push_back(ConsumeElement(provider));
+    if (provider.ConsumeBool() && !witness.stack.empty()) witness.stack.pop_back();
+
+    const DeterministicSignatureChecker checker;
+    ScriptError error;
+    ScriptError reference_error;
+    const bool result{VerifyScript(script_sig, script_pubkey, &witness, flags, checker, &error)};
+    const bool reference_result{VerifyScriptWithInterpreter(script_sig, script_pubkey, &witness, flags, checker, &reference_error)};
+    assert(result == reference_result);
+    assert(error == reference_error);
+}
@@ -13,7 +13,7 @@
 #include <string>
 #include <vector>
 
-bool CastToBool(const std::vector<unsigned char>& vch);
+bool CastToBool(Span<const unsigned char> vch);
 
 FUZZ_TARGET(script_interpreter)
 {
@@ -96,6 +96,14 @@ FUZZ_TARGET(txorphan, .init = initialize_orphanage)
                         }
                     }
                 },
+                [&] {
+                    const size_t max_txs{fuzzed_data_provider.ConsumeIntegralInRange<size_t>(1, 100)};
+                    const auto txs{orphanage.GetTxsToReconsider(peer_id, max_txs)};
+                    Assert(txs.size() <= max_txs);
+                    for (const CTransactionRef& ref : txs) {
+                        Assert(orphanage.HaveTx(GenTxid::Txid(ref->GetHash())));
+                    }
+                },
                 [&] {
                     bool have_tx = orphanage.HaveTx(GenTxid::Txid(tx->GetHash())) || orphanage.HaveTx(GenTxid::Wtxid(tx->GetHash()));
                     // AddTx should return false if tx is too big or already have it
@@ -132,8 +140,10 @@ FUZZ_TARGET(txorphan, .init = initialize_orphanage)
                     // test mocktime and expiry
                     SetMockTime(ConsumeTime(fuzzed_data_provider));
                     auto limit = fuzzed_data_provider.ConsumeIntegral<unsigned int>();
-                    orphanage.LimitOrphans(limit);
+                    auto usage_limit = fuzzed_data_provider.ConsumeIntegral<size_t>();
+                    orphanage.LimitOrphans(limit, usage_limit);
                     Assert(orphanage.Size() <= limit);
+                    Assert(orphanage.TotalUsage() <= usage_limit);
                 });
         }
     }
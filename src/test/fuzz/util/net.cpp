@@ -134,6 +134,13 @@ ssize_t FuzzedSock::Send(const void* data, size_t len, int flags) const
     return r;
 }
 
+ssize_t FuzzedSock::SendV(Span<const Span<const uint8_t>> bufs, int flags) const
+{
+    size_t len{0};
+    for (const auto& buf : bufs) len += buf.size();
+    return Send(bufs.empty() ? nullptr : bufs[0].data(), len, flags);
+}
+
 ssize_t FuzzedSock::Recv(void* buf, size_t len, int flags) const
 {
     // Have a permanent error at recv_errnos[0] because when the fuzzed data is exhausted
@@ -13,6 +13,7 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -344,6 +345,51 @@ BOOST_AUTO_TEST_CASE(bip340_test_vectors)
     }
 }
 
+BOOST_AUTO_TEST_CASE(bip340_batch_verification)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    const XOnlyPubKey pubkey{key.GetPubKey()};
+    std::vector<std::pair<uint256, std::array<unsigned char, 64>>> sigs(10);
+    for (auto& [msg, sig] : sigs) {
+        msg = InsecureRand256();
+        BOOST_REQUIRE(key.SignSchnorr(msg, sig, nullptr, InsecureRand256()));
+    }
+
+    SchnorrBatch batch;
+    BOOST_CHECK(batch.empty());
+    BOOST_CHECK(batch.Verify());
+    for (const auto& [msg, sig] : sigs) BOOST_CHECK(batch.Add(msg, sig, pubkey));
+    BOOST_CHECK_EQUAL(batch.size(), sigs.size());
+    BOOST_CHECK(batch.Verify());
+    BOOST_CHECK(batch.empty());
+
+    // A single invalid signature, message or public key fails the batch.
+    for (size_t i = 0; i < sigs.size(); ++i) {
+        for (int corrupt = 0; corrupt < 3; ++corrupt) {
+            for (size_t j = 0; j < sigs.size(); ++j) {
+                auto [msg, sig] = sigs[j];
+                XOnlyPubKey signer{pubkey};
+                if (i == j && corrupt == 0) sig[InsecureRandRange(64)] ^= 1 + InsecureRandRange(255);
+                if (i == j && corrupt == 1) *(msg.begin() + InsecureRandRange(32)) ^= 1;
+                if (i == j && corrupt == 2) signer = XOnlyPubKey{InsecureRand256()};
+                batch.Add(msg, sig, signer);
+            }
+            BOOST_CHECK(!batch.Verify());
+            BOOST_CHECK(batch.empty());
+        }
+    }
+
+    // A full batch is verified when adding to it.
+    bool added{true};
+    for (size_t i = 0; i < SchnorrBatch::MAX_SIZE; ++i) {
+        const auto& [msg, sig] = sigs[i % sigs.size()];
+        added = batch.Add(i == 0 ? InsecureRand256() : msg, sig, pubkey);
+    }
+    BOOST_CHECK(!added);
+    BOOST_CHECK(batch.empty());
+}
+
 BOOST_AUTO_TEST_CASE(key_ellswift)
 {
     for (const auto& secret : {strSecret1, strSecret2, strSecret1C, strSecret2C}) {
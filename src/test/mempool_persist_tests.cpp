@@ -0,0 +1,111 @@
+// Copyright (c) 2024 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <coins.h>
+#include <consensus/consensus.h>
+#include <kernel/mempool_persist.h>
+#include <kernel/mempool_removal_reason.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/mining.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using kernel::DumpMempool;
+using kernel::LoadMempool;
+
+BOOST_FIXTURE_TEST_SUITE(mempool_persist_tests, RegTestingSetup)
+
+BOOST_AUTO_TEST_CASE(load_skips_verified_scripts_at_same_tip)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    Chainstate& chainstate = m_node.chainman->ActiveChainstate();
+    const fs::path dump_path{m_path_root / "mempool.dat"};
+
+    // Coins locked by a witness script that only accepts 1, so that a transaction pushing 2 fails
+    // its script checks but nothing else.
+    const CScript witness_script{CScript() << OP_1 << OP_EQUAL};
+    const CScript p2wsh{GetScriptForDestination(WitnessV0ScriptHash(witness_script))};
+    std::vector<COutPoint> coinbases;
+    for (int i = 0; i < COINBASE_MATURITY + 2; ++i) coinbases.push_back(MineBlock(m_node, p2wsh));
+    // PrepareBlock() dates blocks before the BIP16 switch time, which would leave P2SH, and with it
+    // witness verification, disabled for the mempool.
+    int64_t block_time{GetTime()};
+    const auto mine_current_block = [&] {
+        auto block{PrepareBlock(m_node, CScript() << OP_TRUE)};
+        block->nTime = ++block_time;
+        BOOST_REQUIRE(!MineBlock(m_node, block).IsNull());
+    };
+    mine_current_block();
+
+    const auto make_spend = [&](const COutPoint& prevout, unsigned char witness_value) {
+        const Coin coin{WITH_LOCK(::cs_main, return chainstate.CoinsTip().AccessCoin(prevout))};
+        BOOST_REQUIRE(!coin.IsSpent());
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(prevout);
+        mtx.vin[0].scriptWitness.stack = {{witness_value}, {witness_script.begin(), witness_script.end()}};
+        mtx.vout.emplace_back(coin.out.nValue - 10000, p2wsh);
+        return MakeTransactionRef(std::move(mtx));
+    };
+    const CTransactionRef valid_tx{make_spend(coinbases[0], 1)};
+    const CTransactionRef invalid_tx{make_spend(coinbases[1], 2)};
+
+    const int64_t first_seen{GetTime()};
+    SetMockTime(first_seen);
+    {
+        LOCK(::cs_main);
+        BOOST_REQUIRE(m_node.chainman->ProcessTransaction(valid_tx).m_result_type == MempoolAcceptResult::ResultType::VALID);
+        BOOST_CHECK(m_node.chainman->ProcessTransaction(invalid_tx).m_result_type == MempoolAcceptResult::ResultType::INVALID);
+        // Pretend it was accepted anyway, as if its scripts had been verified.
+        LOCK(pool.cs);
+        TestMemPoolEntryHelper entry;
+        pool.addUnchecked(entry.Fee(10000).Time(NodeSeconds{std::chrono::seconds{first_seen}}).SpendsCoinbase(true).FromTx(invalid_tx));
+    }
+    pool.PrioritiseTransaction(valid_tx->GetHash(), 1000);
+    BOOST_REQUIRE(DumpMempool(pool, dump_path, chainstate, fsbridge::fopen, /*skip_file_commit=*/true));
+
+    const auto clear_mempool = [&] {
+        LOCK2(::cs_main, pool.cs);
+        for (const auto& tx : {valid_tx, invalid_tx}) {
+            pool.removeRecursive(*tx, MemPoolRemovalReason::REPLACED);
+            pool.ClearPrioritisation(tx->GetHash());
+        }
+        BOOST_REQUIRE_EQUAL(pool.size(), 0U);
+    };
+
+    // Another file than our own mempool.dat: all scripts are verified.
+    clear_mempool();
+    SetMockTime(first_seen + 60);
+    BOOST_CHECK(LoadMempool(pool, dump_path, chainstate, {}));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(valid_tx->GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(invalid_tx->GetHash())));
+    // The entry time and the prioritisation are kept.
+    const TxMempoolInfo info{pool.info(GenTxid::Txid(valid_tx->GetHash()))};
+    BOOST_CHECK_EQUAL(count_seconds(info.m_time), first_seen);
+    BOOST_CHECK_EQUAL(info.nFeeDelta, 1000);
+
+    // Our own mempool.dat, dumped at the current tip: the scripts are not verified again.
+    clear_mempool();
+    BOOST_CHECK(LoadMempool(pool, dump_path, chainstate, {.trust_verified_scripts = true}));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(valid_tx->GetHash())));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(invalid_tx->GetHash())));
+
+    // Once the tip moved, they are.
+    clear_mempool();
+    mine_current_block();
+    BOOST_CHECK(LoadMempool(pool, dump_path, chainstate, {.trust_verified_scripts = true}));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(valid_tx->GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(invalid_tx->GetHash())));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 
 #include <common/system.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <util/time.h>
@@ -11,6 +12,8 @@
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
+
+#include <algorithm>
 #include <vector>
 
 BOOST_FIXTURE_TEST_SUITE(mempool_tests, TestingSetup)
@@ -115,6 +118,104 @@ BOOST_AUTO_TEST_CASE(MempoolRemoveTest)
     BOOST_CHECK_EQUAL(testPool.size(), 0U);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolEntryLinksTest)
+{
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction parent;
+    parent.vin.resize(1);
+    parent.vin[0].scriptSig = CScript() << OP_11;
+    parent.vout.resize(5);
+    for (auto& out : parent.vout) {
+        out.scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        out.nValue = 10000LL;
+    }
+    std::vector<CMutableTransaction> children(5);
+    for (uint32_t i = 0; i < children.size(); ++i) {
+        children[i].vin.resize(1);
+        children[i].vin[0].scriptSig = CScript() << OP_11;
+        children[i].vin[0].prevout = COutPoint(parent.GetHash(), i);
+        children[i].vout.resize(1);
+        children[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        children[i].vout[0].nValue = 9000LL;
+    }
+
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    pool.addUnchecked(entry.FromTx(parent));
+    const auto parent_it{*pool.GetIter(parent.GetHash())};
+    BOOST_CHECK_EQUAL(parent_it->GetMemPoolChildrenConst().DynamicMemoryUsage(), 0U);
+
+    for (const auto& child : children) pool.addUnchecked(entry.FromTx(child));
+    const auto& links{parent_it->GetMemPoolChildrenConst()};
+    BOOST_CHECK_EQUAL(links.size(), children.size());
+    // Links iterate by txid, like a std::set, and can be looked up.
+    BOOST_CHECK(std::is_sorted(links.begin(), links.end(), CompareIteratorByHash{}));
+    for (const auto& child : children) {
+        const auto child_it{*pool.GetIter(child.GetHash())};
+        BOOST_CHECK_EQUAL(links.count(*child_it), 1U);
+        BOOST_CHECK_EQUAL(child_it->GetMemPoolParentsConst().size(), 1U);
+        BOOST_CHECK(&child_it->GetMemPoolParentsConst().begin()->get() == &*parent_it);
+    }
+    BOOST_CHECK_EQUAL(links.count(*parent_it), 0U);
+
+    // Once the children are gone, so is the memory used to link to them.
+    for (const auto& child : children) pool.removeRecursive(CTransaction(child), REMOVAL_REASON_DUMMY);
+    BOOST_CHECK(links.empty());
+    BOOST_CHECK_EQUAL(links.DynamicMemoryUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolFeerateHistogramTest)
+{
+    const std::vector<CAmount>& bucket_feerates{FeerateHistogram::BucketFeerates()};
+    BOOST_CHECK_EQUAL(bucket_feerates.front(), 0);
+    BOOST_CHECK_EQUAL(bucket_feerates[1], FeerateHistogram::MIN_BUCKET_FEERATE);
+    BOOST_CHECK_EQUAL(bucket_feerates[2], 1100);
+    BOOST_CHECK(std::is_sorted(bucket_feerates.begin(), bucket_feerates.end()));
+    BOOST_CHECK(bucket_feerates.back() <= FeerateHistogram::MAX_BUCKET_FEERATE);
+
+    const auto bucket_of = [&](CAmount feerate) {
+        return size_t(std::upper_bound(bucket_feerates.begin(), bucket_feerates.end(), feerate) - bucket_feerates.begin() - 1);
+    };
+
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_11;
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx.vout[0].nValue = 10000LL;
+    CMutableTransaction tx2{tx};
+    tx2.vin[0].scriptSig = CScript() << OP_12;
+
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    BOOST_CHECK_EQUAL(pool.GetFeerateHistogram().GetTotalVsize(), 0U);
+
+    pool.addUnchecked(entry.Fee(0).FromTx(tx));
+    pool.addUnchecked(entry.Fee(20000).FromTx(tx2));
+    const auto it{*pool.GetIter(tx.GetHash())};
+    const auto it2{*pool.GetIter(tx2.GetHash())};
+    const FeerateHistogram& histogram{pool.GetFeerateHistogram()};
+    BOOST_CHECK_EQUAL(histogram.GetTotalVsize(), pool.GetTotalTxSize());
+    BOOST_CHECK_EQUAL(histogram.GetBucketVsizes()[0], uint64_t(it->GetTxSize()));
+    const size_t high_bucket{bucket_of(CFeeRate(20000, it2->GetTxSize()).GetFeePerK())};
+    BOOST_CHECK_EQUAL(histogram.GetBucketVsizes()[high_bucket], uint64_t(it2->GetTxSize()));
+
+    // Prioritisation moves a transaction into the bucket of its modified feerate, and negative
+    // modified fees count as zero.
+    pool.PrioritiseTransaction(tx.GetHash(), 5000);
+    BOOST_CHECK_EQUAL(histogram.GetBucketVsizes()[0], 0U);
+    BOOST_CHECK_EQUAL(histogram.GetBucketVsizes()[bucket_of(CFeeRate(5000, it->GetTxSize()).GetFeePerK())], uint64_t(it->GetTxSize()));
+    pool.PrioritiseTransaction(tx2.GetHash(), -30000);
+    BOOST_CHECK_EQUAL(histogram.GetBucketVsizes()[high_bucket], 0U);
+    BOOST_CHECK_EQUAL(histogram.GetBucketVsizes()[0], uint64_t(it2->GetTxSize()));
+
+    pool.removeRecursive(CTransaction(tx), REMOVAL_REASON_DUMMY);
+    pool.removeRecursive(CTransaction(tx2), REMOVAL_REASON_DUMMY);
+    BOOST_CHECK_EQUAL(histogram.GetTotalVsize(), 0U);
+    BOOST_CHECK(histogram == FeerateHistogram{});
+}
+
 template <typename name>
 static void CheckSort(CTxMemPool& pool, std::vector<std::string>& sortedOrder) EXCLUSIVE_LOCKS_REQUIRED(pool.cs)
 {
@@ -533,14 +634,16 @@ BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
     pool.addUnchecked(entry.Fee(1100LL).FromTx(tx6));
     pool.addUnchecked(entry.Fee(9000LL).FromTx(tx7));
 
-    // we only require this to remove, at max, 2 txn, because it's not clear what we're really optimizing for aside from that
+    // tx7 pays for both tx5 and tx6, which are mined with it as one chunk, and evicted as one
     pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
     BOOST_CHECK(pool.exists(GenTxid::Txid(tx4.GetHash())));
-    BOOST_CHECK(pool.exists(GenTxid::Txid(tx6.GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(tx5.GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(tx6.GetHash())));
     BOOST_CHECK(!pool.exists(GenTxid::Txid(tx7.GetHash())));
 
-    if (!pool.exists(GenTxid::Txid(tx5.GetHash())))
-        pool.addUnchecked(entry.Fee(1000LL).FromTx(tx5));
+    // With a high fee tx6 is mined together with tx4 instead, before the tx5/tx7 chunk
+    pool.addUnchecked(entry.Fee(1000LL).FromTx(tx5));
+    pool.addUnchecked(entry.Fee(9000LL).FromTx(tx6));
     pool.addUnchecked(entry.Fee(9000LL).FromTx(tx7));
 
     pool.TrimToSize(pool.DynamicMemoryUsage() / 2); // should maximize mempool size by only removing 5/7
@@ -579,6 +682,57 @@ BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
     // ... unless it has gone all the way to 0 (after getting past 1000/2)
 }
 
+BOOST_AUTO_TEST_CASE(MempoolLimitSizeTest)
+{
+    CTxMemPool::Options opts{MemPoolOptionsForTest(m_node)};
+    opts.max_size_bytes = 1'000'000;
+    CTxMemPool pool{opts};
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    // Pairs of a low fee parent and a child paying for it, each pair paying more than the last.
+    std::vector<std::pair<CTransactionRef, CTransactionRef>> pairs;
+    const auto add_pair = [&] {
+        CMutableTransaction parent;
+        parent.vin.emplace_back(COutPoint{rng.rand256(), 0});
+        parent.vout.emplace_back(COIN, CScript() << OP_11 << OP_EQUAL);
+        CMutableTransaction child;
+        child.vin.emplace_back(COutPoint{parent.GetHash(), 0});
+        child.vout.emplace_back(COIN, CScript() << OP_11 << OP_EQUAL);
+        pairs.emplace_back(MakeTransactionRef(std::move(parent)), MakeTransactionRef(std::move(child)));
+        pool.addUnchecked(entry.Fee(100).FromTx(pairs.back().first));
+        pool.addUnchecked(entry.Fee(1000 + 10 * pairs.size()).FromTx(pairs.back().second));
+    };
+
+    // Nothing happens below the limit.
+    add_pair();
+    pool.LimitSize();
+    BOOST_CHECK_EQUAL(pool.size(), 2U);
+    BOOST_CHECK_EQUAL(pool.GetMinFee().GetFeePerK(), 0);
+
+    // Once over the limit, the mempool is trimmed below it, to leave room for more transactions.
+    while (pool.DynamicMemoryUsage() <= 1'000'000) add_pair();
+    pool.LimitSize();
+    BOOST_CHECK(pool.DynamicMemoryUsage() <= 1'000'000 / 100 * CTxMemPool::TRIM_TARGET_PERCENT);
+    BOOST_CHECK(pool.size() < pairs.size() * 2);
+
+    // The lowest paying pairs are evicted, parents together with the children paying for them.
+    size_t evicted{0};
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const bool parent_in{pool.exists(GenTxid::Txid(pairs[i].first->GetHash()))};
+        BOOST_CHECK_EQUAL(parent_in, pool.exists(GenTxid::Txid(pairs[i].second->GetHash())));
+        BOOST_CHECK_EQUAL(parent_in, i >= pairs.size() - pool.size() / 2);
+        if (!parent_in) ++evicted;
+    }
+    BOOST_REQUIRE(evicted > 1);
+
+    // The minimum fee is bumped once, to the feerate of the best pair evicted.
+    const int64_t pair_size{GetVirtualTransactionSize(*pairs[0].first) + GetVirtualTransactionSize(*pairs[0].second)};
+    const CFeeRate best_evicted{100 + 1000 + 10 * CAmount(evicted), static_cast<uint32_t>(pair_size)};
+    BOOST_CHECK_EQUAL(pool.GetMinFee().GetFeePerK(), best_evicted.GetFeePerK() + pool.m_incremental_relay_feerate.GetFeePerK());
+}
+
 inline CTransactionRef make_tx(std::vector<CAmount>&& output_values, std::vector<CTransactionRef>&& inputs=std::vector<CTransactionRef>(), std::vector<uint32_t>&& input_indices=std::vector<uint32_t>())
 {
     CMutableTransaction tx = CMutableTransaction();
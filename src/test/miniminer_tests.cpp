@@ -1,6 +1,7 @@
 // Copyright (c) 2021 The Bitcoin Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
+#include <node/mempool_fee_estimator.h>
 #include <node/mini_miner.h>
 #include <random.h>
 #include <txmempool.h>
@@ -507,4 +508,98 @@ BOOST_FIXTURE_TEST_CASE(calculate_cluster, TestChain100Setup)
     }
 }
 
+BOOST_AUTO_TEST_CASE(miniminer_mock_blocks)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    TestMemPoolEntryHelper entry;
+    int64_t tx_vsize{0};
+    {
+        LOCK2(::cs_main, pool.cs);
+        // Six unrelated transactions of decreasing feerates.
+        for (CAmount fee = 6000; fee > 0; fee -= 1000) {
+            const auto tx{make_tx({COutPoint{GetRandHash(), 0}}, /*num_outputs=*/1)};
+            pool.addUnchecked(entry.Fee(fee).FromTx(tx));
+            tx_vsize = pool.GetIter(tx->GetHash()).value()->GetTxSize();
+        }
+        // A parent paying nothing, whose child pays for both at a higher feerate than all of the above.
+        const auto parent{make_tx({COutPoint{GetRandHash(), 0}}, /*num_outputs=*/1)};
+        pool.addUnchecked(entry.Fee(0).FromTx(parent));
+        const auto child{make_tx({COutPoint{parent->GetHash(), 0}}, /*num_outputs=*/1)};
+        pool.addUnchecked(entry.Fee(13000).FromTx(child));
+    }
+
+    // Two transactions per block: the parent and child, then the others two by two.
+    node::MiniMiner miner{pool};
+    BOOST_CHECK(miner.IsReadyToCalculate());
+    const auto blocks{miner.BuildMockBlocks(/*block_vsize=*/2 * tx_vsize, /*num_blocks=*/3)};
+    BOOST_CHECK(!miner.IsReadyToCalculate());
+    BOOST_REQUIRE_EQUAL(blocks.size(), 3U);
+    BOOST_CHECK(blocks[0].min_feerate == CFeeRate(13000, 2 * tx_vsize));
+    BOOST_CHECK_EQUAL(blocks[0].fees, 13000);
+    BOOST_CHECK(blocks[1].min_feerate == CFeeRate(5000, tx_vsize));
+    BOOST_CHECK_EQUAL(blocks[1].fees, 11000);
+    BOOST_CHECK(blocks[2].min_feerate == CFeeRate(3000, tx_vsize));
+    for (const auto& block : blocks) {
+        BOOST_CHECK(block.full);
+        BOOST_CHECK_EQUAL(block.vsize, 2 * tx_vsize);
+    }
+
+    // With room to spare, everything goes into the last block, which is not full.
+    const auto all_blocks{node::MiniMiner{pool}.BuildMockBlocks(/*block_vsize=*/2 * tx_vsize, /*num_blocks=*/10)};
+    BOOST_REQUIRE_EQUAL(all_blocks.size(), 4U);
+    BOOST_CHECK(!all_blocks.back().full);
+    BOOST_CHECK_EQUAL(all_blocks.back().fees, 3000);
+    BOOST_CHECK_EQUAL(node::MiniMiner{pool}.BuildMockBlocks(/*block_vsize=*/100 * tx_vsize, /*num_blocks=*/10).size(), 1U);
+}
+
+BOOST_FIXTURE_TEST_CASE(mempool_fee_estimator, RegTestingSetup)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    const ChainstateManager& chainman = *Assert(m_node.chainman);
+    node::MempoolFeeEstimator estimator;
+    TestMemPoolEntryHelper entry;
+
+    // An empty mempool fills no block.
+    BOOST_CHECK(estimator.EstimateFee(pool, chainman, 1) == CFeeRate(0));
+    BOOST_CHECK(estimator.GetBlocks(pool, chainman, 5).empty());
+
+    // Transactions of 100kvB, so that ten of them do not fit in a regtest block.
+    const int64_t block_vsize{node::MempoolFeeEstimator::GetBlockVsize(pool, chainman)};
+    BOOST_REQUIRE(block_vsize > 0);
+    const size_t txs_per_block{size_t(block_vsize / 100'000)};
+    const auto make_large_tx = [] {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(COutPoint{GetRandHash(), 0});
+        tx.vout.emplace_back(COIN, CScript() << std::vector<unsigned char>(100'000 - 100, 0));
+        return MakeTransactionRef(tx);
+    };
+    std::vector<CTransactionRef> txs;
+    {
+        LOCK2(::cs_main, pool.cs);
+        for (size_t i = 0; i < txs_per_block + 1; ++i) {
+            txs.push_back(make_large_tx());
+            pool.addUnchecked(entry.Fee(100'000 * (i + 1)).FromTx(txs.back()));
+        }
+    }
+    // The lowest paying transaction does not make it into the first block.
+    const int32_t tx_vsize{WITH_LOCK(pool.cs, return pool.GetIter(txs[1]->GetHash()).value()->GetTxSize())};
+    BOOST_CHECK(estimator.EstimateFee(pool, chainman, 1) == CFeeRate(200'000, tx_vsize));
+    BOOST_CHECK(estimator.EstimateFee(pool, chainman, 2) == CFeeRate(0));
+    const auto blocks{estimator.GetBlocks(pool, chainman, 5)};
+    BOOST_REQUIRE_EQUAL(blocks.size(), 2U);
+    BOOST_CHECK(blocks[0].full);
+    BOOST_CHECK(!blocks[1].full);
+    BOOST_CHECK_EQUAL(blocks[1].fees, 100'000);
+
+    // Mempool changes are picked up: a higher paying transaction pushes out the next lowest one.
+    {
+        LOCK2(::cs_main, pool.cs);
+        txs.push_back(make_large_tx());
+        pool.addUnchecked(entry.Fee(100'000'000).FromTx(txs.back()));
+    }
+    BOOST_CHECK(estimator.EstimateFee(pool, chainman, 1) == CFeeRate(300'000, tx_vsize));
+    pool.PrioritiseTransaction(txs[0]->GetHash(), 100'000'000);
+    BOOST_CHECK(estimator.EstimateFee(pool, chainman, 1) == CFeeRate(400'000, tx_vsize));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
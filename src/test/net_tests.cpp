@@ -1161,11 +1161,12 @@ public:
     }
 
     /** Schedule a message to be sent to us by the transport. */
-    void AddMessage(std::string m_type, std::vector<uint8_t> payload)
+    void AddMessage(std::string m_type, std::vector<uint8_t> payload, bool share = false)
     {
         CSerializedNetMsg msg;
         msg.m_type = std::move(m_type);
         msg.data = std::move(payload);
+        if (share) msg.Share();
         m_msg_to_send.push_back(std::move(msg));
     }
 
@@ -1540,7 +1541,7 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
         auto msg_data_2 = g_insecure_rand_ctx.randbytes<uint8_t>(4000000); // test that sending 4M payload works
         tester.SendMessage(uint8_t(InsecureRandRange(223) + 33), {}); // unknown short id
         tester.SendMessage(uint8_t(2), msg_data_1); // "block" short id
-        tester.AddMessage("blocktxn", msg_data_2); // schedule blocktxn to be sent to us
+        tester.AddMessage("blocktxn", msg_data_2, /*share=*/InsecureRandBool()); // schedule blocktxn to be sent to us
         ret = tester.Interact();
         BOOST_REQUIRE(ret && ret->size() == 2);
         BOOST_CHECK(!(*ret)[0]);
@@ -1565,4 +1566,55 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(v1transport_shared_payload_test)
+{
+    const auto payload = g_insecure_rand_ctx.randbytes<uint8_t>(100000);
+    CSerializedNetMsg orig;
+    orig.m_type = NetMsgType::BLOCK;
+    orig.data = payload;
+    orig.Share();
+    BOOST_CHECK(orig.data.empty());
+    BOOST_CHECK(orig.Payload() == Span{payload});
+    BOOST_CHECK(orig.GetMemoryUsage() > payload.size());
+
+    for (int i = 0; i < 2; ++i) {
+        // Every copy references the same payload bytes.
+        CSerializedNetMsg msg = orig.Copy();
+        BOOST_CHECK(msg.Payload().data() == orig.Payload().data());
+
+        V1Transport sender{0, SER_NETWORK, INIT_PROTO_VERSION};
+        V1Transport receiver{1, SER_NETWORK, INIT_PROTO_VERSION};
+        BOOST_REQUIRE(sender.SetMessageToSend(msg));
+
+        // Header and payload are returned together, and may be marked as sent in chunks that
+        // straddle the boundary between them.
+        while (true) {
+            const auto& [to_send, more, msg_type] = sender.GetBytesToSendV(/*have_next_message=*/false);
+            BOOST_CHECK(!more);
+            size_t total{0};
+            for (const auto& segment : to_send) total += segment.size();
+            if (total == 0) break;
+            BOOST_CHECK_EQUAL(msg_type, NetMsgType::BLOCK);
+            size_t chunk = 1 + InsecureRandRange(std::min<size_t>(total, 30000));
+            size_t marked{0};
+            for (const auto& segment : to_send) {
+                Span<const uint8_t> bytes{segment.first(std::min(segment.size(), chunk - marked))};
+                if (bytes.empty()) continue;
+                marked += bytes.size();
+                BOOST_REQUIRE(receiver.ReceivedBytes(bytes));
+                BOOST_CHECK(bytes.empty());
+            }
+            sender.MarkBytesSent(chunk);
+        }
+        BOOST_REQUIRE(receiver.ReceivedMessageComplete());
+        bool reject{false};
+        CNetMessage received = receiver.GetReceivedMessage({}, reject);
+        BOOST_CHECK(!reject);
+        BOOST_CHECK_EQUAL(received.m_type, NetMsgType::BLOCK);
+        BOOST_CHECK(Span{received.m_recv} == MakeByteSpan(payload));
+    }
+    // The original is unaffected by its copies being sent.
+    BOOST_CHECK(orig.Payload() == Span{payload});
+}
+
 BOOST_AUTO_TEST_SUITE_END()
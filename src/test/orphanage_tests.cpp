@@ -10,8 +10,10 @@
 #include <test/util/setup_common.h>
 #include <txorphanage.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -136,4 +138,89 @@ BOOST_AUTO_TEST_CASE(DoS_mapOrphans)
     BOOST_CHECK(orphanage.CountOrphans() == 0);
 }
 
+static CTransactionRef MakeOrphan(const COutPoint& prevout, size_t script_size)
+{
+    CMutableTransaction tx;
+    tx.vin.emplace_back(prevout);
+    const std::vector<unsigned char> script(script_size, OP_1);
+    tx.vin[0].scriptSig = CScript(script.begin(), script.end());
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 1 * CENT;
+    tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+    return MakeTransactionRef(tx);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_usage_limit)
+{
+    TxOrphanageTest orphanage;
+    const NodeId flooding_peer{0};
+    const NodeId honest_peer{1};
+
+    for (int i = 0; i < 20; ++i) {
+        BOOST_CHECK(orphanage.AddTx(MakeOrphan(COutPoint{InsecureRand256(), 0}, 10'000), flooding_peer));
+    }
+    for (int i = 0; i < 5; ++i) {
+        BOOST_CHECK(orphanage.AddTx(MakeOrphan(COutPoint{InsecureRand256(), 0}, 100), honest_peer));
+    }
+    const size_t flooding_usage{orphanage.UsageByPeer(flooding_peer)};
+    const size_t honest_usage{orphanage.UsageByPeer(honest_peer)};
+    BOOST_CHECK_GT(flooding_usage, 10 * honest_usage);
+    BOOST_CHECK_EQUAL(orphanage.TotalUsage(), flooding_usage + honest_usage);
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(2), 0U);
+
+    // Nothing to evict within the limits.
+    orphanage.LimitOrphans(25, orphanage.TotalUsage());
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 25U);
+
+    // Going over the memory limit evicts the orphans of the peer using the most memory.
+    const size_t usage_limit{honest_usage + flooding_usage / 2};
+    orphanage.LimitOrphans(25, usage_limit);
+    BOOST_CHECK_LE(orphanage.TotalUsage(), usage_limit);
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(honest_peer), honest_usage);
+    BOOST_CHECK_LT(orphanage.CountOrphans(), 25U);
+
+    // So does going over the count limit.
+    orphanage.LimitOrphans(10);
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 10U);
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(honest_peer), honest_usage);
+
+    orphanage.EraseForPeer(flooding_peer);
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(flooding_peer), 0U);
+    BOOST_CHECK_EQUAL(orphanage.TotalUsage(), honest_usage);
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 5U);
+
+    orphanage.LimitOrphans(0);
+    BOOST_CHECK_EQUAL(orphanage.TotalUsage(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(reconsider_in_batches)
+{
+    TxOrphanageTest orphanage;
+    const NodeId peer{0};
+
+    CMutableTransaction parent;
+    parent.vin.emplace_back(COutPoint{InsecureRand256(), 0});
+    parent.vout.resize(5);
+    std::vector<CTransactionRef> children;
+    for (uint32_t n = 0; n < parent.vout.size(); ++n) {
+        children.push_back(MakeOrphan(COutPoint{parent.GetHash(), n}, 10));
+        BOOST_CHECK(orphanage.AddTx(children.back(), peer));
+    }
+    BOOST_CHECK(orphanage.GetTxsToReconsider(peer, 10).empty());
+
+    orphanage.AddChildrenToWorkSet(CTransaction{parent});
+    BOOST_CHECK(orphanage.HaveTxToReconsider(peer));
+    const auto first{orphanage.GetTxsToReconsider(peer, 3)};
+    BOOST_CHECK_EQUAL(first.size(), 3U);
+    // Orphans erased in the meantime are skipped.
+    for (const CTransactionRef& child : children) {
+        if (std::find(first.begin(), first.end(), child) != first.end()) continue;
+        BOOST_CHECK_EQUAL(orphanage.EraseTx(child->GetHash()), 1);
+        break;
+    }
+    BOOST_CHECK_EQUAL(orphanage.GetTxsToReconsider(peer, 3).size(), 1U);
+    BOOST_CHECK(!orphanage.HaveTxToReconsider(peer));
+    BOOST_CHECK(orphanage.GetTxsToReconsider(peer, 3).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
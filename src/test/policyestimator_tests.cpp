@@ -4,6 +4,7 @@
 
 #include <policy/fees.h>
 #include <policy/policy.h>
+#include <streams.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <uint256.h>
@@ -182,4 +183,39 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     }
 }
 
+BOOST_AUTO_TEST_CASE(TargetSpacing)
+{
+    const fs::path no_file{m_path_root / "no_fee_estimates.dat"};
+    CBlockPolicyEstimator ten_minutes{no_file, /*read_stale_estimates=*/false, std::chrono::minutes{10}};
+    CBlockPolicyEstimator five_minutes{no_file, /*read_stale_estimates=*/false, std::chrono::minutes{5}};
+
+    // Horizons cover the same time, in twice as many blocks.
+    BOOST_CHECK_EQUAL(ten_minutes.HighestTargetTracked(FeeEstimateHorizon::SHORT_HALFLIFE), 12U);
+    BOOST_CHECK_EQUAL(ten_minutes.HighestTargetTracked(FeeEstimateHorizon::MED_HALFLIFE), 48U);
+    BOOST_CHECK_EQUAL(ten_minutes.HighestTargetTracked(FeeEstimateHorizon::LONG_HALFLIFE), 1008U);
+    for (const auto horizon : ALL_FEE_ESTIMATE_HORIZONS) {
+        BOOST_CHECK_EQUAL(five_minutes.HighestTargetTracked(horizon), 2 * ten_minutes.HighestTargetTracked(horizon));
+    }
+    EstimationResult ten_minutes_result, five_minutes_result;
+    ten_minutes.estimateRawFee(2, 0.95, FeeEstimateHorizon::MED_HALFLIFE, &ten_minutes_result);
+    five_minutes.estimateRawFee(2, 0.95, FeeEstimateHorizon::MED_HALFLIFE, &five_minutes_result);
+    BOOST_CHECK_EQUAL(ten_minutes_result.decay, .9952);
+    BOOST_CHECK_CLOSE(five_minutes_result.decay * five_minutes_result.decay, .9952, 1e-9);
+
+    // Estimates are read back only at the spacing they were collected at.
+    const fs::path est_path{m_path_root / "fee_estimates_5min.dat"};
+    {
+        AutoFile est_file{fsbridge::fopen(est_path, "wb")};
+        BOOST_REQUIRE(five_minutes.Write(est_file));
+    }
+    {
+        AutoFile est_file{fsbridge::fopen(est_path, "rb")};
+        BOOST_CHECK(CBlockPolicyEstimator(no_file, false, std::chrono::minutes{5}).Read(est_file));
+    }
+    {
+        AutoFile est_file{fsbridge::fopen(est_path, "rb")};
+        BOOST_CHECK(!ten_minutes.Read(est_file));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <optional>
 #include <vector>
 
@@ -228,4 +229,54 @@ BOOST_FIXTURE_TEST_CASE(rbf_helper_functions, TestChain100Setup)
     BOOST_CHECK(HasNoNewUnconfirmed(*spends_conflicting_confirmed.get(), pool, {entry1, entry3}) == std::nullopt);
 }
 
+BOOST_AUTO_TEST_CASE(rbf_shared_cluster)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // A grandparent, a low fee parent and ten children of increasing fees, all in one cluster.
+    CMutableTransaction grandparent;
+    grandparent.vin.emplace_back(COutPoint{GetRandHash(), 0});
+    grandparent.vout.emplace_back(10 * COIN, CScript() << OP_TRUE);
+    pool.addUnchecked(entry.Fee(10000).FromTx(grandparent));
+    CMutableTransaction parent;
+    parent.vin.emplace_back(COutPoint{grandparent.GetHash(), 0});
+    parent.vout.assign(10, CTxOut{COIN / 2, CScript() << OP_TRUE});
+    pool.addUnchecked(entry.Fee(100).FromTx(parent));
+    CTxMemPool::setEntries children;
+    for (uint32_t n = 0; n < parent.vout.size(); ++n) {
+        CMutableTransaction child;
+        child.vin.emplace_back(COutPoint{parent.GetHash(), n});
+        child.vout.emplace_back(COIN / 4, CScript() << OP_TRUE);
+        pool.addUnchecked(entry.Fee(1000 * (n + 1)).FromTx(child));
+        children.insert(pool.GetIter(child.GetHash()).value());
+    }
+
+    // The chunk feerates of all children come out of one linearization, the same as one by one.
+    const auto chunk_feerates{pool.GetChunkFeerates(children)};
+    BOOST_CHECK_EQUAL(chunk_feerates.size(), children.size());
+    CFeeRate highest_chunk_feerate;
+    for (const auto& child : children) {
+        BOOST_CHECK(chunk_feerates.at(child) == pool.GetChunkFeerate(child));
+        highest_chunk_feerate = std::max(highest_chunk_feerate, chunk_feerates.at(child));
+    }
+    const auto unused_txid{GetRandHash()};
+    BOOST_CHECK(PaysMoreThanConflictChunks(pool, children, highest_chunk_feerate, unused_txid).has_value());
+    BOOST_CHECK(PaysMoreThanConflictChunks(pool, children, CFeeRate(highest_chunk_feerate.GetFeePerK() + 1), unused_txid) == std::nullopt);
+
+    // Replacing the parent evicts it with all its children. Only the grandparent stays behind,
+    // with its statistics and links updated as if it had never had descendants.
+    const auto grandparent_it{pool.GetIter(grandparent.GetHash()).value()};
+    CTxMemPool::setEntries all_conflicts;
+    BOOST_CHECK(GetEntriesForConflicts(CTransaction{parent}, pool, {pool.GetIter(parent.GetHash()).value()}, all_conflicts) == std::nullopt);
+    BOOST_CHECK_EQUAL(all_conflicts.size(), 11U);
+    pool.RemoveStaged(all_conflicts, false, MemPoolRemovalReason::REPLACED);
+    BOOST_CHECK_EQUAL(pool.size(), 1U);
+    BOOST_CHECK_EQUAL(grandparent_it->GetCountWithDescendants(), 1U);
+    BOOST_CHECK_EQUAL(grandparent_it->GetSizeWithDescendants(), grandparent_it->GetTxSize());
+    BOOST_CHECK_EQUAL(grandparent_it->GetModFeesWithDescendants(), grandparent_it->GetModifiedFee());
+    BOOST_CHECK(grandparent_it->GetMemPoolChildrenConst().empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
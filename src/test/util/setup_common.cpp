@@ -27,6 +27,7 @@
 #include <node/context.h>
 #include <node/kernel_notifications.h>
 #include <node/mempool_args.h>
+#include <node/mempool_fee_estimator.h>
 #include <node/miner.h>
 #include <node/peerman_args.h>
 #include <node/validation_cache_args.h>
@@ -72,6 +73,7 @@ using node::BlockManager;
 using node::CalculateCacheSizes;
 using node::KernelNotifications;
 using node::LoadChainstate;
+using node::MempoolFeeEstimator;
 using node::RegenerateCommitments;
 using node::VerifyLoadedChainstate;
 
@@ -163,8 +165,10 @@ ChainTestingSetup::ChainTestingSetup(const ChainType chainType, const std::vecto
     m_node.scheduler->m_service_thread = std::thread(util::TraceThread, "scheduler", [&] { m_node.scheduler->serviceQueue(); });
     GetMainSignals().RegisterBackgroundSignalScheduler(*m_node.scheduler);
 
-    m_node.fee_estimator = std::make_unique<CBlockPolicyEstimator>(FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES);
+    m_node.fee_estimator = std::make_unique<CBlockPolicyEstimator>(FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES,
+                                                                   FeeEstimateTargetSpacing(chainparams.GetConsensus()));
     m_node.mempool = std::make_unique<CTxMemPool>(MemPoolOptionsForTest(m_node));
+    m_node.mempool_fee_estimator = std::make_unique<MempoolFeeEstimator>();
 
     m_cache_sizes = CalculateCacheSizes(m_args);
 
@@ -204,6 +208,7 @@ ChainTestingSetup::~ChainTestingSetup()
     m_node.netgroupman.reset();
     m_node.args = nullptr;
     m_node.mempool.reset();
+    m_node.mempool_fee_estimator.reset();
     m_node.scheduler.reset();
     m_node.chainman.reset();
 }
@@ -25,10 +25,12 @@
 #include <util/translation.h>
 #include <validationinterface.h>
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <optional>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 
 bool TestLockPointValidity(CChain& active_chain, const LockPoints& lp)
@@ -51,8 +53,8 @@ bool TestLockPointValidity(CChain& active_chain, const LockPoints& lp)
 void CTxMemPool::UpdateForDescendants(txiter updateIt, cacheMap& cachedDescendants,
                                       const std::set<uint256>& setExclude, std::set<uint256>& descendants_to_remove)
 {
-    CTxMemPoolEntry::Children stageEntries, descendants;
-    stageEntries = updateIt->GetMemPoolChildrenConst();
+    const CTxMemPoolEntry::Children& update_children = updateIt->GetMemPoolChildrenConst();
+    CTxMemPoolEntry::EntryRefSet stageEntries(update_children.begin(), update_children.end()), descendants;
 
     while (!stageEntries.empty()) {
         const CTxMemPoolEntry& descendant = *stageEntries.begin();
@@ -157,7 +159,7 @@ void CTxMemPool::UpdateTransactionsFromBlock(const std::vector<uint256>& vHashes
 util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateAncestorsAndCheckLimits(
     int64_t entry_size,
     size_t entry_count,
-    CTxMemPoolEntry::Parents& staged_ancestors,
+    CTxMemPoolEntry::EntryRefSet& staged_ancestors,
     const Limits& limits) const
 {
     int64_t totalSizeWithAncestors = entry_size;
@@ -217,7 +219,7 @@ bool CTxMemPool::CheckPackageLimits(const Package& package,
         return false;
     }
 
-    CTxMemPoolEntry::Parents staged_ancestors;
+    CTxMemPoolEntry::EntryRefSet staged_ancestors;
     for (const auto& tx : package) {
         for (const auto& input : tx->vin) {
             std::optional<txiter> piter = GetIter(input.prevout.hash);
@@ -245,7 +247,7 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateMemPoolAncestors(
     const Limits& limits,
     bool fSearchForParents /* = true */) const
 {
-    CTxMemPoolEntry::Parents staged_ancestors;
+    CTxMemPoolEntry::EntryRefSet staged_ancestors;
     const CTransaction &tx = entry.GetTx();
 
     if (fSearchForParents) {
@@ -265,7 +267,8 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateMemPoolAncestors(
         // If we're not searching for parents, we require this to already be an
         // entry in the mempool and use the entry's cached parents.
         txiter it = mapTx.iterator_to(entry);
-        staged_ancestors = it->GetMemPoolParentsConst();
+        const CTxMemPoolEntry::Parents& parents = it->GetMemPoolParentsConst();
+        staged_ancestors.insert(parents.begin(), parents.end());
     }
 
     return CalculateAncestorsAndCheckLimits(entry.GetTxSize(), /*entry_count=*/1, staged_ancestors,
@@ -315,18 +318,12 @@ void CTxMemPool::UpdateEntryForAncestors(txiter it, const setEntries &setAncesto
     mapTx.modify(it, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(updateSize, updateFee, updateCount, updateSigOpsCost); });
 }
 
-void CTxMemPool::UpdateChildrenForRemoval(txiter it)
-{
-    const CTxMemPoolEntry::Children& children = it->GetMemPoolChildrenConst();
-    for (const CTxMemPoolEntry& updateIt : children) {
-        UpdateParent(mapTx.iterator_to(updateIt), it, false);
-    }
-}
-
 void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, bool updateDescendants)
 {
-    // For each entry, walk back all ancestors and decrement size associated with this
-    // transaction
+    // Entries being removed are left as they are: only those staying in the mempool need their
+    // links and statistics updated. Replacing or evicting a whole chain or a parent with many
+    // children thus doesn't keep updating entries that are about to go, and each ancestor staying
+    // behind is updated once for all its removed descendants.
     if (updateDescendants) {
         // updateDescendants should be true whenever we're not recursively
         // removing a tx and all its descendants, eg when a transaction is
@@ -337,15 +334,21 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         for (txiter removeIt : entriesToRemove) {
             setEntries setDescendants;
             CalculateDescendants(removeIt, setDescendants);
-            setDescendants.erase(removeIt); // don't update state for self
             int32_t modifySize = -removeIt->GetTxSize();
             CAmount modifyFee = -removeIt->GetModifiedFee();
             int modifySigOps = -removeIt->GetSigOpCost();
             for (txiter dit : setDescendants) {
+                if (entriesToRemove.count(dit)) continue; // includes removeIt itself
                 mapTx.modify(dit, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(modifySize, modifyFee, -1, modifySigOps); });
             }
         }
     }
+    struct DescendantsRemoved {
+        int32_t size{0};
+        CAmount fee{0};
+        int64_t count{0};
+    };
+    std::map<txiter, DescendantsRemoved, CompareIteratorByHash> ancestors_remaining;
     for (txiter removeIt : entriesToRemove) {
         const CTxMemPoolEntry &entry = *removeIt;
         // Since this is a tx that is already in the mempool, we can call CMPA
@@ -368,15 +371,30 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // we use the cached notion of ancestor transactions as the set of
         // things to update for removal.
         auto ancestors{AssumeCalculateMemPoolAncestors(__func__, entry, Limits::NoLimits(), /*fSearchForParents=*/false)};
-        // Note that UpdateAncestorsOf severs the child links that point to
-        // removeIt in the entries for the parents of removeIt.
-        UpdateAncestorsOf(false, removeIt, ancestors);
+        for (txiter ancestorIt : ancestors) {
+            if (entriesToRemove.count(ancestorIt)) continue;
+            DescendantsRemoved& removed = ancestors_remaining[ancestorIt];
+            removed.size += entry.GetTxSize();
+            removed.fee += entry.GetModifiedFee();
+            ++removed.count;
+        }
+        // Sever the child links that point to removeIt in the entries for its parents.
+        for (const CTxMemPoolEntry& parent : entry.GetMemPoolParentsConst()) {
+            const txiter parentIt = mapTx.iterator_to(parent);
+            if (!entriesToRemove.count(parentIt)) UpdateChild(parentIt, removeIt, false);
+        }
+    }
+    for (const auto& [ancestorIt, removed] : ancestors_remaining) {
+        mapTx.modify(ancestorIt, [&](CTxMemPoolEntry& e) { e.UpdateDescendantState(-removed.size, -removed.fee, -removed.count); });
     }
     // After updating all the ancestor sizes, we can now sever the link between each
     // transaction being removed and any mempool children (ie, update CTxMemPoolEntry::m_parents
     // for each direct child of a transaction being removed).
     for (txiter removeIt : entriesToRemove) {
-        UpdateChildrenForRemoval(removeIt);
+        for (const CTxMemPoolEntry& child : removeIt->GetMemPoolChildrenConst()) {
+            const txiter childIt = mapTx.iterator_to(child);
+            if (!entriesToRemove.count(childIt)) UpdateParent(childIt, removeIt, false);
+        }
     }
 }
 
@@ -476,6 +494,7 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, setEntries &setAnces
     nTransactionsUpdated++;
     totalTxSize += entry.GetTxSize();
     m_total_fee += entry.GetFee();
+    m_feerate_histogram.Add(newit->GetModifiedFee(), newit->GetTxSize());
     if (minerPolicyEstimator) {
         minerPolicyEstimator->processTransaction(entry, validFeeEstimate);
     }
@@ -528,8 +547,9 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 
     totalTxSize -= it->GetTxSize();
     m_total_fee -= it->GetFee();
+    m_feerate_histogram.Remove(it->GetModifiedFee(), it->GetTxSize());
     cachedInnerUsage -= it->DynamicMemoryUsage();
-    cachedInnerUsage -= memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
+    cachedInnerUsage -= it->GetMemPoolParentsConst().DynamicMemoryUsage() + it->GetMemPoolChildrenConst().DynamicMemoryUsage();
     mapTx.erase(it);
     nTransactionsUpdated++;
     if (minerPolicyEstimator) {minerPolicyEstimator->removeTx(hash, false);}
@@ -676,6 +696,7 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
 
     uint64_t checkTotal = 0;
     CAmount check_total_fee{0};
+    FeerateHistogram check_feerate_histogram;
     uint64_t innerUsage = 0;
     uint64_t prev_ancestor_count{0};
 
@@ -684,10 +705,11 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
     for (const auto& it : GetSortedDepthAndScore()) {
         checkTotal += it->GetTxSize();
         check_total_fee += it->GetFee();
+        check_feerate_histogram.Add(it->GetModifiedFee(), it->GetTxSize());
         innerUsage += it->DynamicMemoryUsage();
         const CTransaction& tx = it->GetTx();
-        innerUsage += memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
-        CTxMemPoolEntry::Parents setParentCheck;
+        innerUsage += it->GetMemPoolParentsConst().DynamicMemoryUsage() + it->GetMemPoolChildrenConst().DynamicMemoryUsage();
+        CTxMemPoolEntry::EntryRefSet setParentCheck;
         for (const CTxIn &txin : tx.vin) {
             // Check that every mempool transaction's inputs refer to available coins, or other mempool tx's.
             indexed_transaction_set::const_iterator it2 = mapTx.find(txin.prevout.hash);
@@ -733,7 +755,7 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
         prev_ancestor_count = it->GetCountWithAncestors();
 
         // Check children against mapNextTx
-        CTxMemPoolEntry::Children setChildrenCheck;
+        CTxMemPoolEntry::EntryRefSet setChildrenCheck;
         auto iter = mapNextTx.lower_bound(COutPoint(it->GetTx().GetHash(), 0));
         int32_t child_sizes{0};
         for (; iter != mapNextTx.end() && iter->first->hash == it->GetTx().GetHash(); ++iter) {
@@ -766,6 +788,7 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
 
     assert(totalTxSize == checkTotal);
     assert(m_total_fee == check_total_fee);
+    assert(m_feerate_histogram == check_feerate_histogram);
     assert(innerUsage == cachedInnerUsage);
 }
 
@@ -887,7 +910,9 @@ void CTxMemPool::PrioritiseTransaction(const uint256& hash, const CAmount& nFeeD
         delta = SaturatingAdd(delta, nFeeDelta);
         txiter it = mapTx.find(hash);
         if (it != mapTx.end()) {
+            m_feerate_histogram.Remove(it->GetModifiedFee(), it->GetTxSize());
             mapTx.modify(it, [&nFeeDelta](CTxMemPoolEntry& e) { e.UpdateModifiedFee(nFeeDelta); });
+            m_feerate_histogram.Add(it->GetModifiedFee(), it->GetTxSize());
             // Now update all ancestors' modified fees with descendants
             auto ancestors{AssumeCalculateMemPoolAncestors(__func__, *it, Limits::NoLimits(), /*fSearchForParents=*/false)};
             for (txiter ancestorIt : ancestors) {
@@ -1032,8 +1057,10 @@ void CCoinsViewMemPool::Reset()
 
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
-    // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    // Estimate the overhead of mapTx to be 15 pointers per entry, as no exact formula for boost::multi_index_contained is implemented.
+    // Its nodes come from m_entry_resource without any per-allocation overhead. Count the nodes in use rather than the
+    // arena's chunks, so that evicting entries makes room: freed nodes are reused for the next entries.
+    return MAPTX_NODE_BYTES * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked) {
@@ -1056,15 +1083,9 @@ void CTxMemPool::RemoveStaged(setEntries &stage, bool updateDescendants, MemPool
 int CTxMemPool::Expire(std::chrono::seconds time)
 {
     AssertLockHeld(cs);
-    indexed_transaction_set::index<entry_time>::type::iterator it = mapTx.get<entry_time>().begin();
-    setEntries toremove;
-    while (it != mapTx.get<entry_time>().end() && it->GetTime() < time) {
-        toremove.insert(mapTx.project<0>(it));
-        it++;
-    }
     setEntries stage;
-    for (txiter removeit : toremove) {
-        CalculateDescendants(removeit, stage);
+    for (auto it = mapTx.get<entry_time>().begin(); it != mapTx.get<entry_time>().end() && it->GetTime() < time; ++it) {
+        CalculateDescendants(mapTx.project<0>(it), stage);
     }
     RemoveStaged(stage, false, MemPoolRemovalReason::EXPIRY);
     return stage.size();
@@ -1079,23 +1100,27 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, bool validFeeEstimat
 void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add)
 {
     AssertLockHeld(cs);
-    CTxMemPoolEntry::Children s;
-    if (add && entry->GetMemPoolChildren().insert(*child).second) {
-        cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
-    } else if (!add && entry->GetMemPoolChildren().erase(*child)) {
-        cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    CTxMemPoolEntry::Children& children = entry->GetMemPoolChildren();
+    cachedInnerUsage -= children.DynamicMemoryUsage();
+    if (add) {
+        children.insert(*child);
+    } else {
+        children.erase(*child);
     }
+    cachedInnerUsage += children.DynamicMemoryUsage();
 }
 
 void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add)
 {
     AssertLockHeld(cs);
-    CTxMemPoolEntry::Parents s;
-    if (add && entry->GetMemPoolParents().insert(*parent).second) {
-        cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
-    } else if (!add && entry->GetMemPoolParents().erase(*parent)) {
-        cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    CTxMemPoolEntry::Parents& parents = entry->GetMemPoolParents();
+    cachedInnerUsage -= parents.DynamicMemoryUsage();
+    if (add) {
+        parents.insert(*parent);
+    } else {
+        parents.erase(*parent);
     }
+    cachedInnerUsage += parents.DynamicMemoryUsage();
 }
 
 CFeeRate CTxMemPool::GetMinFee(size_t sizelimit) const {
@@ -1135,20 +1160,38 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
 
     unsigned nTxnRemoved = 0;
     CFeeRate maxFeeRateRemoved(0);
+    // Clusters linearized so far, and how many of their chunks are left. Dropping the last chunk of a
+    // linearization leaves a valid linearization with the same chunks, so a cluster is linearized
+    // once however many of its chunks are evicted.
+    std::vector<Cluster> clusters;
+    std::vector<size_t> chunks_left;
+    std::unordered_map<const CTxMemPoolEntry*, size_t> cluster_of;
     while (!mapTx.empty() && DynamicMemoryUsage() > sizelimit) {
-        indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
+        const txiter worst{mapTx.project<0>(mapTx.get<descendant_score>().begin())};
+
+        // Evict the last chunk of the cluster of the worst descendant package: it has the lowest
+        // chunk feerate of the cluster and, being at the end of its linearization, nothing left in
+        // the mempool depends on it.
+        const auto [pos, inserted]{cluster_of.try_emplace(&*worst, clusters.size())};
+        const size_t index{pos->second};
+        if (inserted) {
+            clusters.push_back(GetCluster(worst));
+            chunks_left.push_back(clusters.back().chunks.size());
+            for (const txiter it : clusters.back().txs) cluster_of.emplace(&*it, index);
+        }
+        const Cluster& cluster{clusters[index]};
+        if (!Assume(chunks_left[index] > 0)) break;
+        const cluster_linearize::Chunk& chunk{cluster.chunks[--chunks_left[index]]};
 
         // We set the new mempool min fee to the feerate of the removed set, plus the
         // "minimum reasonable fee rate" (ie some value under which we consider txn
         // to have 0 fee). This way, we don't allow txn to enter mempool with feerate
         // equal to txn which were removed with no block in between.
-        CFeeRate removed(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
+        CFeeRate removed(chunk.fee, chunk.size);
         removed += m_incremental_relay_feerate;
-        trackPackageRemoved(removed);
         maxFeeRateRemoved = std::max(maxFeeRateRemoved, removed);
 
-        setEntries stage;
-        CalculateDescendants(mapTx.project<0>(it), stage);
+        setEntries stage(cluster.txs.begin() + chunk.begin, cluster.txs.begin() + chunk.end);
         nTxnRemoved += stage.size();
 
         std::vector<CTransaction> txn;
@@ -1157,6 +1200,7 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
             for (txiter iter : stage)
                 txn.push_back(iter->GetTx());
         }
+        for (txiter iter : stage) cluster_of.erase(&*iter);
         RemoveStaged(stage, false, MemPoolRemovalReason::SIZELIMIT);
         if (pvNoSpendsRemaining) {
             for (const CTransaction& tx : txn) {
@@ -1169,10 +1213,19 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
     }
 
     if (maxFeeRateRemoved > CFeeRate(0)) {
+        // Bumping to the highest feerate removed at once is the same as bumping for each chunk.
+        trackPackageRemoved(maxFeeRateRemoved);
         LogPrint(BCLog::MEMPOOL, "Removed %u txn, rolling minimum fee bumped to %s\n", nTxnRemoved, maxFeeRateRemoved.ToString());
     }
 }
 
+void CTxMemPool::LimitSize(std::vector<COutPoint>* pvNoSpendsRemaining)
+{
+    AssertLockHeld(cs);
+    if (DynamicMemoryUsage() <= static_cast<size_t>(m_max_size_bytes)) return;
+    TrimToSize(m_max_size_bytes / 100 * TRIM_TARGET_PERCENT, pvNoSpendsRemaining);
+}
+
 uint64_t CTxMemPool::CalculateDescendantMaximum(txiter entry) const {
     // find parent with highest descendant count
     std::vector<txiter> candidates;
@@ -1245,3 +1298,102 @@ std::vector<CTxMemPool::txiter> CTxMemPool::GatherClusters(const std::vector<uin
     }
     return clustered_txs;
 }
+
+CTxMemPool::Cluster CTxMemPool::CollectCluster(txiter it) const
+{
+    AssertLockHeld(cs);
+    Cluster cluster;
+    cluster.txs.push_back(it);
+    visited(it);
+    const auto add_unvisited{[&](const auto& entries) EXCLUSIVE_LOCKS_REQUIRED(cs, m_epoch) {
+        for (const CTxMemPoolEntry& entry : entries) {
+            const auto entry_it{mapTx.iterator_to(entry)};
+            if (!visited(entry_it)) cluster.txs.push_back(entry_it);
+        }
+    }};
+    for (size_t i{0}; i < cluster.txs.size(); ++i) {
+        add_unvisited(cluster.txs[i]->GetMemPoolParentsConst());
+        add_unvisited(cluster.txs[i]->GetMemPoolChildrenConst());
+    }
+
+    // A transaction has more ancestors than any of its parents, so this order is topological.
+    std::sort(cluster.txs.begin(), cluster.txs.end(), [](const txiter& a, const txiter& b) {
+        if (a->GetCountWithAncestors() != b->GetCountWithAncestors()) {
+            return a->GetCountWithAncestors() < b->GetCountWithAncestors();
+        }
+        return CompareIteratorByHash()(a, b);
+    });
+    std::unordered_map<const CTxMemPoolEntry*, uint32_t> positions;
+    positions.reserve(cluster.txs.size());
+    std::vector<cluster_linearize::ClusterTx> txs(cluster.txs.size());
+    for (uint32_t pos{0}; pos < cluster.txs.size(); ++pos) {
+        const CTxMemPoolEntry& entry{*cluster.txs[pos]};
+        positions.emplace(&entry, pos);
+        txs[pos].fee = entry.GetModifiedFee();
+        txs[pos].size = entry.GetTxSize();
+        for (const CTxMemPoolEntry& parent : entry.GetMemPoolParentsConst()) {
+            txs[pos].parents.push_back(positions.at(&parent));
+        }
+    }
+
+    const std::vector<uint32_t> linearization{cluster_linearize::Linearize(txs)};
+    cluster.chunks = cluster_linearize::ChunkLinearization(txs, linearization);
+    std::vector<txiter> ordered;
+    ordered.reserve(linearization.size());
+    for (const uint32_t pos : linearization) ordered.push_back(cluster.txs[pos]);
+    cluster.txs = std::move(ordered);
+    return cluster;
+}
+
+CTxMemPool::Cluster CTxMemPool::GetCluster(txiter it) const
+{
+    AssertLockHeld(cs);
+    WITH_FRESH_EPOCH(m_epoch);
+    return CollectCluster(it);
+}
+
+std::vector<CTxMemPool::Cluster> CTxMemPool::GetAllClusters() const
+{
+    AssertLockHeld(cs);
+    std::vector<Cluster> clusters;
+    WITH_FRESH_EPOCH(m_epoch);
+    for (txiter it = mapTx.begin(); it != mapTx.end(); ++it) {
+        if (visited(it)) continue;
+        // CollectCluster marks it visited again, which is harmless.
+        clusters.push_back(CollectCluster(it));
+    }
+    return clusters;
+}
+
+CFeeRate CTxMemPool::GetChunkFeerate(txiter it) const
+{
+    AssertLockHeld(cs);
+    const Cluster cluster{GetCluster(it)};
+    const auto pos{std::find(cluster.txs.begin(), cluster.txs.end(), it) - cluster.txs.begin()};
+    for (const auto& chunk : cluster.chunks) {
+        if (pos < chunk.end) return CFeeRate(chunk.fee, chunk.size);
+    }
+    Assume(false);
+    return CFeeRate(it->GetModifiedFee(), it->GetTxSize());
+}
+
+std::map<CTxMemPool::txiter, CFeeRate, CompareIteratorByHash> CTxMemPool::GetChunkFeerates(const setEntries& entries) const
+{
+    AssertLockHeld(cs);
+    std::map<txiter, CFeeRate, CompareIteratorByHash> feerates;
+    WITH_FRESH_EPOCH(m_epoch);
+    for (txiter it : entries) {
+        // Entries of a cluster collected before are visited already.
+        if (visited(it)) continue;
+        const Cluster cluster{CollectCluster(it)};
+        size_t chunk_index{0};
+        for (size_t pos = 0; pos < cluster.txs.size(); ++pos) {
+            while (pos >= cluster.chunks[chunk_index].end) ++chunk_index;
+            if (entries.count(cluster.txs[pos])) {
+                const cluster_linearize::Chunk& chunk{cluster.chunks[chunk_index]};
+                feerates.emplace(cluster.txs[pos], CFeeRate(chunk.fee, chunk.size));
+            }
+        }
+    }
+    return feerates;
+}
@@ -6,6 +6,7 @@
 #ifndef BITCOIN_TXMEMPOOL_H
 #define BITCOIN_TXMEMPOOL_H
 
+#include <cluster_linearize.h>
 #include <coins.h>
 #include <consensus/amount.h>
 #include <indirectmap.h>
@@ -15,8 +16,10 @@
 #include <kernel/mempool_options.h>        // IWYU pragma: export
 #include <kernel/mempool_removal_reason.h> // IWYU pragma: export
 #include <policy/feerate.h>
+#include <policy/feerate_histogram.h>
 #include <policy/packages.h>
 #include <primitives/transaction.h>
+#include <support/allocators/pool.h>
 #include <sync.h>
 #include <util/epochguard.h>
 #include <util/hasher.h>
@@ -308,6 +311,7 @@ protected:
     uint64_t totalTxSize GUARDED_BY(cs){0};      //!< sum of all mempool tx's virtual sizes. Differs from serialized tx size since witness data is discounted. Defined in BIP 141.
     CAmount m_total_fee GUARDED_BY(cs){0};       //!< sum of all mempool tx's fees (NOT modified fee)
     uint64_t cachedInnerUsage GUARDED_BY(cs){0}; //!< sum of dynamic memory usage of all the map elements (NOT the maps themselves)
+    FeerateHistogram m_feerate_histogram GUARDED_BY(cs); //!< virtual sizes of all mempool txs by modified feerate
 
     mutable int64_t lastRollingFeeUpdate GUARDED_BY(cs){GetTime()};
     mutable bool blockSinceLastRollingFeeBump GUARDED_BY(cs){false};
@@ -328,6 +332,16 @@ protected:
 public:
 
     static const int ROLLING_FEE_HALFLIFE = 60 * 60 * 12; // public only for testing
+    /** Once over its size limit, the mempool is trimmed down to this percentage of the limit, so
+     * that a steady inflow of transactions does not trigger a trim after every one of them. */
+    static constexpr int64_t TRIM_TARGET_PERCENT{95};
+
+    /** Estimated size of a mapTx node: the entry and 15 pointers for the five indexes. */
+    static constexpr size_t MAPTX_NODE_BYTES{sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)};
+    /** mapTx nodes are carved out of an arena rather than allocated one by one, which saves the
+     * per-allocation overhead and keeps entries close together. Nodes larger than estimated, and
+     * the hash bucket arrays, fall back to the regular allocator. */
+    using EntryAllocator = PoolAllocator<CTxMemPoolEntry, MAPTX_NODE_BYTES>;
 
     typedef boost::multi_index_container<
         CTxMemPoolEntry,
@@ -358,7 +372,8 @@ public:
                 boost::multi_index::identity<CTxMemPoolEntry>,
                 CompareTxMemPoolEntryByAncestorFee
             >
-        >
+        >,
+        EntryAllocator
     > indexed_transaction_set;
 
     /**
@@ -389,7 +404,9 @@ public:
      * the mempool is consistent with the new chain tip and fully populated.
      */
     mutable RecursiveMutex cs;
-    indexed_transaction_set mapTx GUARDED_BY(cs);
+    //! Arena for the mapTx nodes. Must outlive mapTx.
+    EntryAllocator::ResourceType m_entry_resource;
+    indexed_transaction_set mapTx GUARDED_BY(cs){indexed_transaction_set::ctor_args_list{}, &m_entry_resource};
 
     using txiter = indexed_transaction_set::nth_index<0>::type::const_iterator;
     std::vector<std::pair<uint256, txiter>> vTxHashes GUARDED_BY(cs); //!< All tx witness hashes/entries in mapTx, in random order
@@ -427,7 +444,7 @@ private:
      */
     util::Result<setEntries> CalculateAncestorsAndCheckLimits(int64_t entry_size,
                                                               size_t entry_count,
-                                                              CTxMemPoolEntry::Parents &staged_ancestors,
+                                                              CTxMemPoolEntry::EntryRefSet& staged_ancestors,
                                                               const Limits& limits
                                                               ) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -597,6 +614,26 @@ public:
      * more transactions as a DoS protection. */
     std::vector<txiter> GatherClusters(const std::vector<uint256>& txids) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** A cluster of connected transactions, linearized by modified fee (see cluster_linearize.h). */
+    struct Cluster {
+        /** The transactions, in linearization order. */
+        std::vector<txiter> txs;
+        /** Chunks of txs, by decreasing feerate. */
+        std::vector<cluster_linearize::Chunk> chunks;
+    };
+
+    /** Linearize the cluster the given entry belongs to. */
+    Cluster GetCluster(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** Linearize every cluster in the mempool. */
+    std::vector<Cluster> GetAllClusters() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** The feerate of the chunk the given entry is included in: the feerate it is mined at. */
+    CFeeRate GetChunkFeerate(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** The chunk feerates of the given entries, linearizing each cluster they belong to once. */
+    std::map<txiter, CFeeRate, CompareIteratorByHash> GetChunkFeerates(const setEntries& entries) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** Calculate all in-mempool ancestors of a set of transactions not already in the mempool and
      * check ancestor and descendant limits. Heuristics are used to estimate the ancestor and
      * descendant count of all entries if the package were to be added to the mempool.  The limits
@@ -634,6 +671,11 @@ public:
       */
     void TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpendsRemaining = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** If the mempool exceeds its size limit, trim it to TRIM_TARGET_PERCENT of the limit.
+      *  pvNoSpendsRemaining is populated as in TrimToSize().
+      */
+    void LimitSize(std::vector<COutPoint>* pvNoSpendsRemaining = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** Expire all transaction (and their dependencies) in the mempool older than time. Return the number of removed transactions. */
     int Expire(std::chrono::seconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -675,6 +717,12 @@ public:
         return m_total_fee;
     }
 
+    const FeerateHistogram& GetFeerateHistogram() const EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        AssertLockHeld(cs);
+        return m_feerate_histogram;
+    }
+
     bool exists(const GenTxid& gtxid) const
     {
         LOCK(cs);
@@ -773,8 +821,6 @@ private:
       * If updateDescendants is true, then also update in-mempool descendants'
       * ancestor state. */
     void UpdateForRemoveFromMempool(const setEntries &entriesToRemove, bool updateDescendants) EXCLUSIVE_LOCKS_REQUIRED(cs);
-    /** Sever link between specified transaction and direct children. */
-    void UpdateChildrenForRemoval(txiter entry) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     /** Before calling removeUnchecked for a given transaction,
      *  UpdateForRemoveFromMempool must be called on the entire (dependent) set
@@ -785,6 +831,8 @@ private:
      *  removal.
      */
     void removeUnchecked(txiter entry, MemPoolRemovalReason reason) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /** Collect the cluster of the given entry, marking its transactions visited, and linearize it. */
+    Cluster CollectCluster(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs, m_epoch);
 public:
     /** visited marks a CTxMemPoolEntry as having been traversed
      * during the lifetime of the most recently created Epoch::Guard
@@ -5,9 +5,11 @@
 #include <txorphanage.h>
 
 #include <consensus/validation.h>
+#include <core_memusage.h>
 #include <logging.h>
 #include <policy/policy.h>
 
+#include <algorithm>
 #include <cassert>
 
 /** Expiration time for orphan transactions in seconds */
@@ -30,8 +32,8 @@ bool TxOrphanage::AddTx(const CTransactionRef& tx, NodeId peer)
     // large transaction with a missing parent then we assume
     // it will rebroadcast it later, after the parent transaction(s)
     // have been mined or received.
-    // 100 orphans, each of which is at most 100,000 bytes big is
-    // at most 10 megabytes of orphans and somewhat more byprev index (in the worst case):
+    // The total size of the orphans is bounded by LimitOrphans() anyway,
+    // but a single big orphan would evict many others:
     unsigned int sz = GetTransactionWeight(*tx);
     if (sz > MAX_STANDARD_TX_WEIGHT)
     {
@@ -39,17 +41,21 @@ bool TxOrphanage::AddTx(const CTransactionRef& tx, NodeId peer)
         return false;
     }
 
-    auto ret = m_orphans.emplace(hash, OrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, m_orphan_list.size()});
+    const size_t usage{RecursiveDynamicUsage(tx)};
+    PeerOrphans& peer_orphans{m_peer_orphans[peer]};
+    auto ret = m_orphans.emplace(hash, OrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, usage, peer_orphans.orphans.size()});
     assert(ret.second);
-    m_orphan_list.push_back(ret.first);
+    peer_orphans.orphans.push_back(ret.first);
+    peer_orphans.usage += usage;
+    m_total_usage += usage;
     // Allow for lookups in the orphan pool by wtxid, as well as txid
     m_wtxid_to_orphan_it.emplace(tx->GetWitnessHash(), ret.first);
     for (const CTxIn& txin : tx->vin) {
         m_outpoint_to_orphan_it[txin.prevout].insert(ret.first);
     }
 
-    LogPrint(BCLog::TXPACKAGES, "stored orphan tx %s (wtxid=%s) (mapsz %u outsz %u)\n", hash.ToString(), wtxid.ToString(),
-             m_orphans.size(), m_outpoint_to_orphan_it.size());
+    LogPrint(BCLog::TXPACKAGES, "stored orphan tx %s (wtxid=%s) (mapsz %u outsz %u usage %u)\n", hash.ToString(), wtxid.ToString(),
+             m_orphans.size(), m_outpoint_to_orphan_it.size(), m_total_usage);
     return true;
 }
 
@@ -75,18 +81,24 @@ int TxOrphanage::EraseTxNoLock(const uint256& txid)
             m_outpoint_to_orphan_it.erase(itPrev);
     }
 
+    const auto peer_it = m_peer_orphans.find(it->second.fromPeer);
+    assert(peer_it != m_peer_orphans.end());
+    PeerOrphans& peer_orphans = peer_it->second;
     size_t old_pos = it->second.list_pos;
-    assert(m_orphan_list[old_pos] == it);
-    if (old_pos + 1 != m_orphan_list.size()) {
-        // Unless we're deleting the last entry in m_orphan_list, move the last
+    assert(peer_orphans.orphans[old_pos] == it);
+    if (old_pos + 1 != peer_orphans.orphans.size()) {
+        // Unless we're deleting the last entry in the peer's orphans, move the last
         // entry to the position we're deleting.
-        auto it_last = m_orphan_list.back();
-        m_orphan_list[old_pos] = it_last;
+        auto it_last = peer_orphans.orphans.back();
+        peer_orphans.orphans[old_pos] = it_last;
         it_last->second.list_pos = old_pos;
     }
     const auto& wtxid = it->second.tx->GetWitnessHash();
     LogPrint(BCLog::TXPACKAGES, "   removed orphan tx %s (wtxid=%s)\n", txid.ToString(), wtxid.ToString());
-    m_orphan_list.pop_back();
+    peer_orphans.orphans.pop_back();
+    peer_orphans.usage -= it->second.usage;
+    m_total_usage -= it->second.usage;
+    if (peer_orphans.orphans.empty()) m_peer_orphans.erase(peer_it);
     m_wtxid_to_orphan_it.erase(it->second.tx->GetWitnessHash());
 
     m_orphans.erase(it);
@@ -100,19 +112,16 @@ void TxOrphanage::EraseForPeer(NodeId peer)
     m_peer_work_set.erase(peer);
 
     int nErased = 0;
-    std::map<uint256, OrphanTx>::iterator iter = m_orphans.begin();
-    while (iter != m_orphans.end())
-    {
-        std::map<uint256, OrphanTx>::iterator maybeErase = iter++; // increment to avoid iterator becoming invalid
-        if (maybeErase->second.fromPeer == peer)
-        {
-            nErased += EraseTxNoLock(maybeErase->second.tx->GetHash());
-        }
+    // Erasing the peer's last orphan erases its entry in m_peer_orphans.
+    while (true) {
+        const auto peer_it = m_peer_orphans.find(peer);
+        if (peer_it == m_peer_orphans.end()) break;
+        nErased += EraseTxNoLock(peer_it->second.orphans.back()->first);
     }
     if (nErased > 0) LogPrint(BCLog::TXPACKAGES, "Erased %d orphan tx from peer=%d\n", nErased, peer);
 }
 
-void TxOrphanage::LimitOrphans(unsigned int max_orphans)
+void TxOrphanage::LimitOrphans(unsigned int max_orphans, size_t max_usage)
 {
     LOCK(m_mutex);
 
@@ -138,11 +147,15 @@ void TxOrphanage::LimitOrphans(unsigned int max_orphans)
         if (nErased > 0) LogPrint(BCLog::TXPACKAGES, "Erased %d orphan tx due to expiration\n", nErased);
     }
     FastRandomContext rng;
-    while (m_orphans.size() > max_orphans)
+    while (m_orphans.size() > max_orphans || m_total_usage > max_usage)
     {
-        // Evict a random orphan:
-        size_t randompos = rng.randrange(m_orphan_list.size());
-        EraseTxNoLock(m_orphan_list[randompos]->first);
+        // Evict a random orphan of the peer using the most memory, so that peers
+        // sending us many or big orphans don't push out the orphans of others:
+        const auto peer_it = std::max_element(m_peer_orphans.begin(), m_peer_orphans.end(),
+            [](const auto& a, const auto& b) { return a.second.usage < b.second.usage; });
+        const std::vector<OrphanMap::iterator>& orphans = peer_it->second.orphans;
+        size_t randompos = rng.randrange(orphans.size());
+        EraseTxNoLock(orphans[randompos]->first);
         ++nEvicted;
     }
     if (nEvicted > 0) LogPrint(BCLog::TXPACKAGES, "orphanage overflow, removed %u tx\n", nEvicted);
@@ -199,6 +212,23 @@ CTransactionRef TxOrphanage::GetTxToReconsider(NodeId peer)
     return nullptr;
 }
 
+std::vector<CTransactionRef> TxOrphanage::GetTxsToReconsider(NodeId peer, size_t max_txs)
+{
+    LOCK(m_mutex);
+
+    std::vector<CTransactionRef> txs;
+    auto work_set_it = m_peer_work_set.find(peer);
+    if (work_set_it != m_peer_work_set.end()) {
+        auto& work_set = work_set_it->second;
+        while (!work_set.empty() && txs.size() < max_txs) {
+            const auto orphan_it = m_orphans.find(*work_set.begin());
+            work_set.erase(work_set.begin());
+            if (orphan_it != m_orphans.end()) txs.push_back(orphan_it->second.tx);
+        }
+    }
+    return txs;
+}
+
 bool TxOrphanage::HaveTxToReconsider(NodeId peer)
 {
     LOCK(m_mutex);
@@ -211,6 +241,13 @@ bool TxOrphanage::HaveTxToReconsider(NodeId peer)
     return false;
 }
 
+size_t TxOrphanage::UsageByPeer(NodeId peer) const
+{
+    LOCK(m_mutex);
+    const auto peer_it = m_peer_orphans.find(peer);
+    return peer_it == m_peer_orphans.end() ? 0 : peer_it->second.usage;
+}
+
 void TxOrphanage::EraseForBlock(const CBlock& block)
 {
     LOCK(m_mutex);
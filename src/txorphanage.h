@@ -9,14 +9,20 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <sync.h>
+#include <util/hasher.h>
 
+#include <limits>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 /** A class to track orphan transactions (failed on TX_MISSING_INPUTS)
  * Since we cannot distinguish orphans from bad transactions with
- * non-existent inputs, we heavily limit the number of orphans
- * we keep and the duration we keep them for.
+ * non-existent inputs, we limit the number of orphans we keep, the
+ * memory they use and the duration we keep them for. The memory each
+ * peer's orphans use is accounted for, so that a peer flooding us with
+ * orphans only evicts its own.
  */
 class TxOrphanage {
 public:
@@ -33,6 +39,9 @@ public:
      */
     CTransactionRef GetTxToReconsider(NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
+    /** Extract up to max_txs transactions from a peer's work set, to be reconsidered together. */
+    std::vector<CTransactionRef> GetTxsToReconsider(NodeId peer, size_t max_txs) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
     /** Erase an orphan by txid */
     int EraseTx(const uint256& txid) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
@@ -42,8 +51,9 @@ public:
     /** Erase all orphans included in or invalidated by a new block */
     void EraseForBlock(const CBlock& block) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
-    /** Limit the orphanage to the given maximum */
-    void LimitOrphans(unsigned int max_orphans) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Limit the orphanage to the given maximum number of transactions and memory usage, evicting
+     *  random orphans of the peer whose orphans use the most memory first */
+    void LimitOrphans(unsigned int max_orphans, size_t max_usage = std::numeric_limits<size_t>::max()) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
     /** Add any orphans that list a particular tx as a parent into the from peer's work set */
     void AddChildrenToWorkSet(const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);;
@@ -58,6 +68,16 @@ public:
         return m_orphans.size();
     }
 
+    /** Return the memory used by the orphans, in bytes */
+    size_t TotalUsage() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        return m_total_usage;
+    }
+
+    /** Return the memory used by the orphans a peer provided, in bytes */
+    size_t UsageByPeer(NodeId peer) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
 protected:
     /** Guards orphan transactions */
     mutable Mutex m_mutex;
@@ -66,11 +86,15 @@ protected:
         CTransactionRef tx;
         NodeId fromPeer;
         int64_t nTimeExpire;
+        /** Memory used by the transaction */
+        size_t usage;
+        /** Position in the orphan list of fromPeer */
         size_t list_pos;
     };
 
     /** Map from txid to orphan transaction record. Limited by
-     *  -maxorphantx/DEFAULT_MAX_ORPHAN_TRANSACTIONS */
+     *  -maxorphantx/DEFAULT_MAX_ORPHAN_TRANSACTIONS and
+     *  -maxorphanmemory/DEFAULT_MAX_ORPHAN_MEMORY */
     std::map<uint256, OrphanTx> m_orphans GUARDED_BY(m_mutex);
 
     /** Which peer provided the orphans that need to be reconsidered */
@@ -89,10 +113,20 @@ protected:
 
     /** Index from the parents' COutPoint into the m_orphans. Used
      *  to remove orphan transactions from the m_orphans */
-    std::map<COutPoint, std::set<OrphanMap::iterator, IteratorComparator>> m_outpoint_to_orphan_it GUARDED_BY(m_mutex);
+    std::unordered_map<COutPoint, std::set<OrphanMap::iterator, IteratorComparator>, SaltedOutpointHasher> m_outpoint_to_orphan_it GUARDED_BY(m_mutex);
+
+    struct PeerOrphans {
+        /** The orphans this peer provided, in a vector for quick random eviction */
+        std::vector<OrphanMap::iterator> orphans;
+        /** Memory used by these orphans */
+        size_t usage{0};
+    };
+
+    /** Orphan transactions and their memory usage by the peer that provided them */
+    std::map<NodeId, PeerOrphans> m_peer_orphans GUARDED_BY(m_mutex);
 
-    /** Orphan transactions in vector for quick random eviction */
-    std::vector<OrphanMap::iterator> m_orphan_list GUARDED_BY(m_mutex);
+    /** Memory used by all orphan transactions */
+    size_t m_total_usage GUARDED_BY(m_mutex){0};
 
     /** Index from wtxid into the m_orphans to lookup orphan
      *  transactions using their witness ids. */
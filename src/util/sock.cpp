@@ -11,6 +11,7 @@
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
+#include <array>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -47,6 +48,32 @@ ssize_t Sock::Send(const void* data, size_t len, int flags) const
     return send(m_socket, static_cast<const char*>(data), len, flags);
 }
 
+ssize_t Sock::SendV(Span<const Span<const uint8_t>> bufs, int flags) const
+{
+#ifdef WIN32
+    for (const auto& buf : bufs) {
+        if (!buf.empty()) return Send(buf.data(), buf.size(), flags);
+    }
+    return 0;
+#else
+    // Keep the I/O vector on the stack; bytes beyond it are left for the next call.
+    std::array<iovec, 8> iov;
+    size_t count{0};
+    for (const auto& buf : bufs) {
+        if (buf.empty()) continue;
+        if (count == iov.size()) break;
+        iov[count].iov_base = const_cast<uint8_t*>(buf.data());
+        iov[count].iov_len = buf.size();
+        ++count;
+    }
+    if (count == 1) return Send(iov[0].iov_base, iov[0].iov_len, flags);
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void* buf, size_t len, int flags) const
 {
     return recv(m_socket, static_cast<char*>(buf), len, flags);
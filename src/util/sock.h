@@ -6,6 +6,7 @@
 #define BITCOIN_UTIL_SOCK_H
 
 #include <compat/compat.h>
+#include <span.h>
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
@@ -64,6 +65,15 @@ public:
      */
     [[nodiscard]] virtual ssize_t Send(const void* data, size_t len, int flags) const;
 
+    /**
+     * Gathering send(2) wrapper: send the concatenation of bufs with a single sendmsg(2) call,
+     * without copying them into one buffer first. Like send(2), this may send fewer bytes than
+     * requested (and on systems without sendmsg(2), never more than the first non-empty buffer).
+     * Code that uses this wrapper can be unit tested if this method is overridden by a mock Sock
+     * implementation.
+     */
+    [[nodiscard]] virtual ssize_t SendV(Span<const Span<const uint8_t>> bufs, int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(m_socket, buf, len, flags);`. Code that uses this
      * wrapper can be unit tested if this method is overridden by a mock Sock implementation.
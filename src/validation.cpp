@@ -59,6 +59,7 @@
 #include <primitives/block.h>
 #include <txmempool.h>
 #include <primitives/transaction.h>
+#include <pubkey.h>
 #include <random.h>
 #include <reverse_iterator.h>
 #include <script/script.h>
@@ -88,6 +89,7 @@
 #include <deque>
 #include <numeric>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -177,8 +179,7 @@ const CBlockIndex* Chainstate::FindForkInGlobalIndex(const CBlockLocator& locato
 bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
-                       std::vector<CScriptCheck>* pvChecks = nullptr)
-                       EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+                       std::vector<CScriptCheck>* pvChecks = nullptr, bool batch_schnorr = false);
 
 bool CheckFinalTxAtTip(const CBlockIndex& active_chain_tip, const CTransaction& tx)
 {
@@ -315,7 +316,7 @@ static void LimitMempoolSize(CTxMemPool& pool, CCoinsViewCache& coins_cache)
     }
 
     std::vector<COutPoint> vNoSpendsRemaining;
-    pool.TrimToSize(pool.m_max_size_bytes, &vNoSpendsRemaining);
+    pool.LimitSize(&vNoSpendsRemaining);
     for (const COutPoint& removed : vNoSpendsRemaining)
         coins_cache.Uncache(removed);
 }
@@ -472,6 +473,9 @@ static bool CheckInputsFromMempoolAndCache(const CTransaction& tx, TxValidationS
     return CheckInputScripts(tx, state, view, flags, /* cacheSigStore= */ true, /* cacheFullScriptStore= */ true, txdata);
 }
 
+/** Shared by block connection and batch mempool acceptance, which both hold cs_main while using it. */
+static CCheckQueue<CScriptCheck, SchnorrBatch> scriptcheckqueue(128);
+
 namespace {
 
 class MemPoolAccept
@@ -513,6 +517,13 @@ public:
          * policies such as mempool min fee and min relay fee.
          */
         const bool m_package_feerates;
+        /** If set, transactions paying a feerate above this, before any fee delta set with
+         * prioritisetransaction, are rejected. Used to protect clients from absurd fees. */
+        const std::optional<CFeeRate> m_client_maxfeerate;
+        /** When true, the scripts are not verified, because they were verified before against the
+         * current tip with the current flags. Only for transactions read back from our own mempool
+         * dump. */
+        const bool m_scripts_verified;
 
         /** Parameters for single transaction mempool validation. */
         static ATMPArgs SingleAccept(const CChainParams& chainparams, int64_t accept_time,
@@ -526,6 +537,8 @@ public:
                             /* m_allow_replacement */ true,
                             /* m_package_submission */ false,
                             /* m_package_feerates */ false,
+                            /* m_client_maxfeerate */ std::nullopt,
+                            /* m_scripts_verified */ false,
             };
         }
 
@@ -540,6 +553,8 @@ public:
                             /* m_allow_replacement */ false,
                             /* m_package_submission */ false, // not submitting to mempool
                             /* m_package_feerates */ false,
+                            /* m_client_maxfeerate */ std::nullopt,
+                            /* m_scripts_verified */ false,
             };
         }
 
@@ -554,6 +569,25 @@ public:
                             /* m_allow_replacement */ false,
                             /* m_package_submission */ true,
                             /* m_package_feerates */ true,
+                            /* m_client_maxfeerate */ std::nullopt,
+                            /* m_scripts_verified */ false,
+            };
+        }
+
+        /** Parameters for batch acceptance of independent or chained transactions. */
+        static ATMPArgs BatchAccept(const CChainParams& chainparams, int64_t accept_time,
+                                    std::vector<COutPoint>& coins_to_uncache, bool test_accept,
+                                    std::optional<CFeeRate> client_maxfeerate, bool scripts_verified = false) {
+            return ATMPArgs{/* m_chainparams */ chainparams,
+                            /* m_accept_time */ accept_time,
+                            /* m_bypass_limits */ false,
+                            /* m_coins_to_uncache */ coins_to_uncache,
+                            /* m_test_accept */ test_accept,
+                            /* m_allow_replacement */ false,
+                            /* m_package_submission */ true, // LimitMempoolSize once, after the whole batch
+                            /* m_package_feerates */ false,
+                            /* m_client_maxfeerate */ client_maxfeerate,
+                            /* m_scripts_verified */ scripts_verified,
             };
         }
 
@@ -567,6 +601,8 @@ public:
                             /* m_allow_replacement */ true,
                             /* m_package_submission */ true, // do not LimitMempoolSize in Finalize()
                             /* m_package_feerates */ false, // only 1 transaction
+                            /* m_client_maxfeerate */ package_args.m_client_maxfeerate,
+                            /* m_scripts_verified */ false,
             };
         }
 
@@ -580,7 +616,9 @@ public:
                  bool test_accept,
                  bool allow_replacement,
                  bool package_submission,
-                 bool package_feerates)
+                 bool package_feerates,
+                 std::optional<CFeeRate> client_maxfeerate,
+                 bool scripts_verified)
             : m_chainparams{chainparams},
               m_accept_time{accept_time},
               m_bypass_limits{bypass_limits},
@@ -588,7 +626,9 @@ public:
               m_test_accept{test_accept},
               m_allow_replacement{allow_replacement},
               m_package_submission{package_submission},
-              m_package_feerates{package_feerates}
+              m_package_feerates{package_feerates},
+              m_client_maxfeerate{client_maxfeerate},
+              m_scripts_verified{scripts_verified}
         {
         }
     };
@@ -596,6 +636,21 @@ public:
     // Single transaction acceptance
     MempoolAcceptResult AcceptSingleTransaction(const CTransactionRef& ptx, ATMPArgs& args) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Single transaction acceptance that only holds cs_main and the mempool lock for the checks
+     * that need them, so that several threads can accept transactions at once.
+     *
+     * Context-free checks run without any lock. PreChecks() and ReplacementChecks() run under
+     * both locks, which are then released while the scripts are verified against the coins
+     * gathered in m_view. Committing takes the locks again: if the chain tip or the mempool
+     * changed in the meantime, the inputs, fees, limits and conflicts are checked again against
+     * the current state. The scripts are not verified again, as the prevouts commit to the coins
+     * they were verified against; ConsensusScriptChecks() finds them in the script cache unless
+     * the tip's script flags changed.
+     */
+    MempoolAcceptResult AcceptSingleTransactionConcurrent(const CTransactionRef& ptx, ATMPArgs& args)
+        LOCKS_EXCLUDED(::cs_main, m_pool.cs);
+
     /**
     * Multiple transaction acceptance. Transactions may or may not be interdependent, but must not
     * conflict with each other, and the transactions cannot already be in the mempool. Parents must
@@ -622,6 +677,24 @@ public:
      */
     PackageMempoolAcceptResult AcceptPackage(const Package& package, ATMPArgs& args) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Batch acceptance of transactions that may be unrelated or chained, parents before children.
+     * Unlike AcceptMultipleTransactions(), each transaction is accepted or rejected on its own and
+     * gets its own feerate; a failure only takes down the transactions spending its outputs.
+     *
+     * All transactions are looked up against one coins view while holding the mempool lock once.
+     * The script checks of those that pass PreChecks() are then run together on the script check
+     * queue, and the survivors are submitted in order. Replacements are not allowed, nor are two
+     * transactions of the batch spending the same coin. The mempool is trimmed once, at the end.
+     *
+     * @param[in]  accept_times  If not empty, the time each transaction entered the mempool,
+     *                           instead of args.m_accept_time for all of them.
+     * @returns one result per transaction, in the order given.
+     */
+    std::vector<MempoolAcceptResult> AcceptTransactionBatch(const std::vector<CTransactionRef>& txns, ATMPArgs& args,
+                                                            const std::vector<int64_t>& accept_times = {})
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 private:
     // All the intermediate state that gets passed between the various levels
     // of checking a given transaction.
@@ -669,8 +742,16 @@ private:
         /** A temporary cache containing serialized transaction data for signature verification.
          * Reused across PolicyScriptChecks and ConsensusScriptChecks. */
         PrecomputedTransactionData m_precomputed_txdata;
+        /** Whether ContextFreeChecks() passed already, so that PreChecks() can skip them. */
+        bool m_context_free_checked{false};
+        /** If set, the entry time to use instead of ATMPArgs::m_accept_time. */
+        std::optional<int64_t> m_accept_time;
     };
 
+    // Run the checks that only depend on the transaction itself and on mempool options, not on
+    // the chain or the mempool contents. They need neither cs_main nor the mempool lock.
+    bool ContextFreeChecks(Workspace& ws);
+
     // Run the policy checks on a given transaction, excluding any script checks.
     // Looks up inputs, calculates feerate, considers replacement, evaluates
     // package limits, etc. As this function can be invoked for "free" by a peer,
@@ -688,7 +769,8 @@ private:
 
     // Run the script checks using our policy flags. As this can be slow, we should
     // only invoke this on transactions that have otherwise passed policy checks.
-    bool PolicyScriptChecks(const ATMPArgs& args, Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+    // Only uses the coins cached in m_view by PreChecks(), so it does not need any lock.
+    bool PolicyScriptChecks(const ATMPArgs& args, Workspace& ws);
 
     // Re-run the script checks, using consensus flags, and try to cache the
     // result in the scriptcache. This should be done after
@@ -737,22 +819,10 @@ private:
     bool m_rbf{false};
 };
 
-bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
+bool MemPoolAccept::ContextFreeChecks(Workspace& ws)
 {
-    AssertLockHeld(cs_main);
-    AssertLockHeld(m_pool.cs);
-   
     const CTransaction& tx = *ws.m_ptx;
-    const uint256& hash = ws.m_hash;
-
-    // Copy/alias what we need out of args
-    
-    const bool bypass_limits = args.m_bypass_limits;
-    std::vector<COutPoint>& coins_to_uncache = args.m_coins_to_uncache;
-
-    // Alias what we need out of ws
     TxValidationState& state = ws.m_state;
-    std::unique_ptr<CTxMemPoolEntry>& entry = ws.m_entry;
 
     if (!CheckTransaction(tx, state)) {
         return false; // state filled in by CheckTransaction
@@ -772,6 +842,31 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     if (::GetSerializeSize(tx, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS) < MIN_STANDARD_TX_NONWITNESS_SIZE)
         return state.Invalid(TxValidationResult::TX_NOT_STANDARD, "tx-size-small");
 
+    ws.m_context_free_checked = true;
+    return true;
+}
+
+bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(m_pool.cs);
+   
+    const CTransaction& tx = *ws.m_ptx;
+    const uint256& hash = ws.m_hash;
+
+    // Copy/alias what we need out of args
+    
+    const bool bypass_limits = args.m_bypass_limits;
+    std::vector<COutPoint>& coins_to_uncache = args.m_coins_to_uncache;
+
+    // Alias what we need out of ws
+    TxValidationState& state = ws.m_state;
+    std::unique_ptr<CTxMemPoolEntry>& entry = ws.m_entry;
+
+    if (!ws.m_context_free_checked && !ContextFreeChecks(ws)) {
+        return false; // state filled in by ContextFreeChecks
+    }
+
     // Only accept nLockTime-using transactions that can be mined in the next
     // block; we don't want our mempool filled up with transactions that can't
     // be mined yet.
@@ -916,7 +1011,7 @@ if (ws.m_conflicts.size() == 1) {
 // ===== BTCBT FIX: 반드시 entry를 만들어서 CalculateMemPoolAncestors에 넘긴다 =====
 // (네 gdb 크래시의 직접 원인: entry == NULL 인데 *entry 역참조)
 if (!entry) {
-    const int64_t accept_time = GetTime();
+    const int64_t accept_time = ws.m_accept_time.value_or(args.m_accept_time);
 
     bool spends_coinbase = false;
     for (const CTxIn& txin : tx.vin) {
@@ -1001,15 +1096,14 @@ bool MemPoolAccept::ReplacementChecks(Workspace& ws)
     // Enforce Rule #6. The replacement transaction must have a higher feerate than its direct conflicts.
     // - The motivation for this check is to ensure that the replacement transaction is preferable for
     //   block-inclusion, compared to what would be removed from the mempool.
-    // - This logic predates ancestor feerate-based transaction selection, which is why it doesn't
-    //   consider feerates of descendants.
-    // - Note: Ancestor feerate-based transaction selection has made this comparison insufficient to
-    //   guarantee that this is incentive-compatible for miners, because it is possible for a
-    //   descendant transaction of a direct conflict to pay a higher feerate than the transaction that
-    //   might replace them, under these rules.
+    // - Blocks are assembled by chunk feerate, so a direct conflict that descendants pay for is
+    //   mined at its chunk feerate rather than its own: the replacement has to beat both.
     if (const auto err_string{PaysMoreThanConflicts(ws.m_iters_conflicting, newFeeRate, hash)}) {
         return state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "insufficient fee", *err_string);
     }
+    if (const auto err_string{PaysMoreThanConflictChunks(m_pool, ws.m_iters_conflicting, newFeeRate, hash)}) {
+        return state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "insufficient fee", *err_string);
+    }
 
     // Calculate all conflicting entries and enforce Rule #5.
     if (const auto err_string{GetEntriesForConflicts(tx, m_pool, ws.m_iters_conflicting, ws.m_all_conflicting)}) {
@@ -1055,8 +1149,6 @@ bool MemPoolAccept::PackageMempoolChecks(const std::vector<CTransactionRef>& txn
 
 bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
 {
-    AssertLockHeld(cs_main);
-    AssertLockHeld(m_pool.cs);
     const CTransaction& tx = *ws.m_ptx;
     TxValidationState& state = ws.m_state;
 
@@ -1280,6 +1372,73 @@ MempoolAcceptResult MemPoolAccept::AcceptSingleTransaction(const CTransactionRef
                                         effective_feerate, single_wtxid);
 }
 
+MempoolAcceptResult MemPoolAccept::AcceptSingleTransactionConcurrent(const CTransactionRef& ptx, ATMPArgs& args)
+{
+    AssertLockNotHeld(::cs_main);
+    AssertLockNotHeld(m_pool.cs);
+
+    Workspace ws(ptx);
+
+    if (!ContextFreeChecks(ws)) return MempoolAcceptResult::Failure(ws.m_state);
+
+    const CBlockIndex* tip;
+    uint64_t mempool_sequence;
+    unsigned int script_flags;
+    {
+        LOCK2(::cs_main, m_pool.cs);
+        if (!PreChecks(args, ws)) return MempoolAcceptResult::Failure(ws.m_state);
+
+        if (m_rbf && !ReplacementChecks(ws)) return MempoolAcceptResult::Failure(ws.m_state);
+
+        tip = m_active_chainstate.m_chain.Tip();
+        mempool_sequence = m_pool.GetSequence();
+        script_flags = GetBlockScriptFlags(*tip, m_active_chainstate.m_chainman);
+    }
+
+    if (!PolicyScriptChecks(args, ws)) return MempoolAcceptResult::Failure(ws.m_state);
+
+    // Cache the consensus script result now, so that ConsensusScriptChecks() only has to look it up.
+    if (!CheckInputScripts(*ptx, ws.m_state, m_view, script_flags, /*cacheSigStore=*/true,
+                           /*cacheFullScriptStore=*/true, ws.m_precomputed_txdata)) {
+        LogPrintf("BUG! PLEASE REPORT THIS! CheckInputScripts failed against latest-block but not STANDARD flags %s, %s\n", ptx->GetHash().ToString(), ws.m_state.ToString());
+        Assume(false);
+        return MempoolAcceptResult::Failure(ws.m_state);
+    }
+
+    LOCK2(::cs_main, m_pool.cs); // held through GetMainSignals().TransactionAddedToMempool()
+
+    std::optional<Workspace> ws_current;
+    if (m_active_chainstate.m_chain.Tip() != tip || m_pool.GetSequence() != mempool_sequence) {
+        // The coins cached in m_view may have been spent since, and the mempool may now hold
+        // conflicts or ancestors that were not there before.
+        for (const CTxIn& txin : ptx->vin) m_view.Uncache(txin.prevout);
+        ws_current.emplace(ptx);
+        ws_current->m_context_free_checked = true;
+        ws_current->m_precomputed_txdata = std::move(ws.m_precomputed_txdata);
+        m_rbf = false;
+        if (!PreChecks(args, *ws_current)) return MempoolAcceptResult::Failure(ws_current->m_state);
+
+        if (m_rbf && !ReplacementChecks(*ws_current)) return MempoolAcceptResult::Failure(ws_current->m_state);
+    }
+    Workspace& ws_commit{ws_current ? *ws_current : ws};
+
+    if (!ConsensusScriptChecks(args, ws_commit)) return MempoolAcceptResult::Failure(ws_commit.m_state);
+
+    const CFeeRate effective_feerate{ws_commit.m_modified_fees, static_cast<uint32_t>(ws_commit.m_vsize)};
+    const std::vector<uint256> single_wtxid{ptx->GetWitnessHash()};
+    if (args.m_test_accept) {
+        return MempoolAcceptResult::Success(std::move(ws_commit.m_replaced_transactions), ws_commit.m_vsize,
+                                            ws_commit.m_base_fees, effective_feerate, single_wtxid);
+    }
+
+    if (!Finalize(args, ws_commit)) return MempoolAcceptResult::Failure(ws_commit.m_state);
+
+    GetMainSignals().TransactionAddedToMempool(ptx, m_pool.GetAndIncrementSequence());
+
+    return MempoolAcceptResult::Success(std::move(ws_commit.m_replaced_transactions), ws_commit.m_vsize,
+                                        ws_commit.m_base_fees, effective_feerate, single_wtxid);
+}
+
 PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::vector<CTransactionRef>& txns, ATMPArgs& args)
 {
     AssertLockHeld(cs_main);
@@ -1598,6 +1757,147 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptPackage(const Package& package,
     return PackageMempoolAcceptResult(package_state_final, std::move(results_final));
 }
 
+std::vector<MempoolAcceptResult> MemPoolAccept::AcceptTransactionBatch(const std::vector<CTransactionRef>& txns, ATMPArgs& args,
+                                                                      const std::vector<int64_t>& accept_times)
+{
+    AssertLockHeld(cs_main);
+    assert(!args.m_allow_replacement);
+    assert(accept_times.empty() || accept_times.size() == txns.size());
+
+    std::vector<Workspace> workspaces;
+    workspaces.reserve(txns.size());
+    for (const auto& tx : txns) workspaces.emplace_back(tx);
+    for (size_t i = 0; i < accept_times.size(); ++i) workspaces[i].m_accept_time = accept_times[i];
+    // Positions of the transactions that are still candidates for submission.
+    std::vector<size_t> candidates;
+    candidates.reserve(txns.size());
+    std::vector<bool> failed(txns.size(), false);
+
+    // Context-free checks first, without the mempool lock.
+    for (size_t i = 0; i < workspaces.size(); ++i) {
+        if (!ContextFreeChecks(workspaces[i])) failed[i] = true;
+    }
+
+    LOCK(m_pool.cs);
+
+    // Look up every transaction's inputs in one view. Outputs of transactions that pass are made
+    // available to the ones after them; outputs of those that fail are not, so their children fail
+    // with missing inputs.
+    std::map<uint256, size_t> batch_txids;
+    std::set<COutPoint> spent_in_batch;
+    for (size_t i = 0; i < workspaces.size(); ++i) {
+        if (failed[i]) continue;
+        Workspace& ws = workspaces[i];
+        if (std::any_of(ws.m_ptx->vin.cbegin(), ws.m_ptx->vin.cend(),
+                        [&](const CTxIn& txin) { return spent_in_batch.count(txin.prevout) > 0; })) {
+            ws.m_state.Invalid(TxValidationResult::TX_CONFLICT, "batch-txn-conflict",
+                               "spends an input already spent earlier in the batch");
+            failed[i] = true;
+            continue;
+        }
+        if (!PreChecks(args, ws)) {
+            failed[i] = true;
+            continue;
+        }
+        if (args.m_client_maxfeerate && CFeeRate(ws.m_base_fees, ws.m_vsize) > *args.m_client_maxfeerate) {
+            ws.m_state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "max feerate exceeded",
+                               strprintf("%s > %s", CFeeRate(ws.m_base_fees, ws.m_vsize).ToString(), args.m_client_maxfeerate->ToString()));
+            failed[i] = true;
+            continue;
+        }
+        for (const CTxIn& txin : ws.m_ptx->vin) spent_in_batch.insert(txin.prevout);
+        m_viewmempool.PackageAddTransaction(ws.m_ptx);
+        batch_txids.emplace(ws.m_hash, i);
+        candidates.push_back(i);
+    }
+
+    // Verify the scripts of all candidates at once on the script check queue. The coins they spend
+    // are all in m_view by now. A failure does not tell which transaction it came from, so in that
+    // case, and when there are no script check threads, check the transactions one by one instead,
+    // which also reports witness stripping the same way as single transaction acceptance.
+    bool scripts_checked{args.m_scripts_verified};
+    if (!scripts_checked && scriptcheckqueue.HasThreads() && candidates.size() > 1) {
+        CCheckQueueControl<CScriptCheck, SchnorrBatch> control(&scriptcheckqueue);
+        bool all_queued{true};
+        for (const size_t i : candidates) {
+            Workspace& ws = workspaces[i];
+            std::vector<CScriptCheck> checks;
+            if (!CheckInputScripts(*ws.m_ptx, ws.m_state, m_view, STANDARD_SCRIPT_VERIFY_FLAGS, /*cacheSigStore=*/true,
+                                   /*cacheFullScriptStore=*/false, ws.m_precomputed_txdata, &checks)) {
+                all_queued = false;
+                break;
+            }
+            control.Add(std::move(checks));
+        }
+        scripts_checked = control.Wait() && all_queued;
+    }
+    if (!scripts_checked) {
+        for (const size_t i : candidates) {
+            workspaces[i].m_state = TxValidationState{};
+            if (!PolicyScriptChecks(args, workspaces[i])) failed[i] = true;
+        }
+    }
+
+    // Submit in order, so that parents are in the mempool before their children.
+    for (const size_t i : candidates) {
+        Workspace& ws = workspaces[i];
+        if (failed[i]) continue;
+        bool has_batch_parent{false};
+        for (const CTxIn& txin : ws.m_ptx->vin) {
+            const auto parent{batch_txids.find(txin.prevout.hash)};
+            if (parent == batch_txids.end()) continue;
+            has_batch_parent = true;
+            if (failed[parent->second]) {
+                ws.m_state.Invalid(TxValidationResult::TX_MISSING_INPUTS, "bad-txns-inputs-missingorspent",
+                                   "spends an output of a rejected transaction of the batch");
+                failed[i] = true;
+                break;
+            }
+        }
+        if (failed[i]) continue;
+        if (has_batch_parent) {
+            // PreChecks() could not count the parents of the batch towards the ancestor and
+            // descendant limits, as they were not in the mempool yet.
+            auto ancestors{m_pool.CalculateMemPoolAncestors(*ws.m_entry, m_pool.m_limits)};
+            if (!ancestors) {
+                ws.m_state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "too-long-mempool-chain", util::ErrorString(ancestors).original);
+                failed[i] = true;
+                continue;
+            }
+            ws.m_ancestors = std::move(*ancestors);
+        }
+        if (args.m_test_accept) continue;
+        if ((!args.m_scripts_verified && !ConsensusScriptChecks(args, ws)) || !Finalize(args, ws)) {
+            failed[i] = true;
+            continue;
+        }
+        GetMainSignals().TransactionAddedToMempool(ws.m_ptx, m_pool.GetAndIncrementSequence());
+    }
+
+    // Trim once for the whole batch, which may evict transactions of the batch again.
+    if (!args.m_test_accept && !candidates.empty()) {
+        LimitMempoolSize(m_pool, m_active_chainstate.CoinsTip());
+    }
+
+    std::vector<MempoolAcceptResult> results;
+    results.reserve(workspaces.size());
+    for (size_t i = 0; i < workspaces.size(); ++i) {
+        Workspace& ws = workspaces[i];
+        if (failed[i]) {
+            results.push_back(MempoolAcceptResult::Failure(ws.m_state));
+        } else if (!args.m_test_accept && !m_pool.exists(GenTxid::Wtxid(ws.m_ptx->GetWitnessHash()))) {
+            TxValidationState mempool_full_state;
+            mempool_full_state.Invalid(TxValidationResult::TX_MEMPOOL_POLICY, "mempool full");
+            results.push_back(MempoolAcceptResult::Failure(mempool_full_state));
+        } else {
+            results.push_back(MempoolAcceptResult::Success(std::move(ws.m_replaced_transactions), ws.m_vsize, ws.m_base_fees,
+                                                           CFeeRate{ws.m_modified_fees, static_cast<uint32_t>(ws.m_vsize)},
+                                                           {ws.m_ptx->GetWitnessHash()}));
+        }
+    }
+    return results;
+}
+
 } // anon namespace
 
 MempoolAcceptResult AcceptToMemoryPool(Chainstate& active_chainstate, const CTransactionRef& tx,
@@ -1631,6 +1931,47 @@ MempoolAcceptResult AcceptToMemoryPool(Chainstate& active_chainstate, const CTra
     return result;
 }
 
+/** Batch acceptance shared by ChainstateManager::ProcessTransactionBatch() and AcceptBatchToMemoryPool(). */
+static std::vector<MempoolAcceptResult> ProcessBatch(Chainstate& active_chainstate, const std::vector<CTransactionRef>& txs,
+                                                     MemPoolAccept::ATMPArgs& args, const std::vector<int64_t>& accept_times)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+{
+    AssertLockHeld(::cs_main);
+    if (!active_chainstate.GetMempool()) {
+        TxValidationState state;
+        state.Invalid(TxValidationResult::TX_NO_MEMPOOL, "no-mempool");
+        return std::vector<MempoolAcceptResult>(txs.size(), MempoolAcceptResult::Failure(state));
+    }
+    CTxMemPool& pool{*active_chainstate.GetMempool()};
+    if (txs.empty()) return {};
+
+    auto results = MemPoolAccept(pool, active_chainstate).AcceptTransactionBatch(txs, args, accept_times);
+
+    // Uncache coins pertaining to transactions that were not submitted to the mempool.
+    const std::set<COutPoint> fetched(args.m_coins_to_uncache.begin(), args.m_coins_to_uncache.end());
+    for (size_t i = 0; i < txs.size(); ++i) {
+        if (!args.m_test_accept && results[i].m_result_type == MempoolAcceptResult::ResultType::VALID) continue;
+        for (const CTxIn& txin : txs[i]->vin) {
+            if (fetched.count(txin.prevout)) active_chainstate.CoinsTip().Uncache(txin.prevout);
+        }
+    }
+    // Ensure the coins cache is still within limits.
+    BlockValidationState state_dummy;
+    active_chainstate.FlushStateToDisk(state_dummy, FlushStateMode::PERIODIC);
+    pool.check(active_chainstate.CoinsTip(), active_chainstate.m_chain.Height() + 1);
+    return results;
+}
+
+std::vector<MempoolAcceptResult> AcceptBatchToMemoryPool(Chainstate& active_chainstate, const std::vector<CTransactionRef>& txs,
+                                                         const std::vector<int64_t>& accept_times, bool scripts_verified)
+{
+    AssertLockHeld(::cs_main);
+    std::vector<COutPoint> coins_to_uncache;
+    auto args = MemPoolAccept::ATMPArgs::BatchAccept(active_chainstate.m_chainman.GetParams(), GetTime(), coins_to_uncache,
+                                                     /*test_accept=*/false, /*client_maxfeerate=*/std::nullopt, scripts_verified);
+    return ProcessBatch(active_chainstate, txs, args, accept_times);
+}
+
 PackageMempoolAcceptResult ProcessNewPackage(Chainstate& active_chainstate, CTxMemPool& pool,
                                                    const Package& package, bool test_accept)
 {
@@ -1882,8 +2223,17 @@ bool CScriptCheck::operator()() {
     return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata), &error);
 }
 
+bool CScriptCheck::operator()(SchnorrBatch& batch) {
+    if (!m_batch_schnorr) return (*this)();
+    const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
+    const CScriptWitness *witness = &ptxTo->vin[nIn].scriptWitness;
+    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata, &batch), &error);
+}
+
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
 static CSHA256 g_scriptExecutionCacheHasher;
+//! Guards g_scriptExecutionCache, which is used by mempool acceptance without cs_main held.
+static std::shared_mutex g_scriptExecutionCacheMutex;
 
 bool InitScriptExecutionCache(size_t max_size_bytes)
 {
@@ -1912,7 +2262,8 @@ bool InitScriptExecutionCache(size_t max_size_bytes)
  *
  * If pvChecks is not nullptr, script checks are pushed onto it instead of being performed inline. Any
  * script checks which are not necessary (eg due to script execution cache hits) are, obviously,
- * not pushed onto pvChecks/run.
+ * not pushed onto pvChecks/run. With batch_schnorr, those checks add the Schnorr signatures they
+ * do not find in the signature cache to the batch of the check queue worker running them.
  *
  * Setting cacheSigStore/cacheFullScriptStore to false will remove elements from the corresponding cache
  * which are matched. This is useful for checking blocks where we will likely never need the cache
@@ -1926,7 +2277,7 @@ bool InitScriptExecutionCache(size_t max_size_bytes)
 bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
-                       std::vector<CScriptCheck>* pvChecks)
+                       std::vector<CScriptCheck>* pvChecks, bool batch_schnorr)
 {
     if (tx.IsCoinBase()) return true;
 
@@ -1942,9 +2293,12 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     uint256 hashCacheEntry;
     CSHA256 hasher = g_scriptExecutionCacheHasher;
     hasher.Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
-    AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
-    if (g_scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
-        return true;
+    {
+        // Erasing only sets an atomic flag, so a shared lock suffices, as in the signature cache.
+        std::shared_lock<std::shared_mutex> lock(g_scriptExecutionCacheMutex);
+        if (g_scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
+            return true;
+        }
     }
 
     if (!txdata.m_spent_outputs_ready) {
@@ -1970,7 +2324,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
         // spent being checked as a part of CScriptCheck.
 
         // Verify signature
-        CScriptCheck check(txdata.m_spent_outputs[i], tx, i, flags, cacheSigStore, &txdata);
+        CScriptCheck check(txdata.m_spent_outputs[i], tx, i, flags, cacheSigStore, &txdata, batch_schnorr);
         if (pvChecks) {
             pvChecks->emplace_back(std::move(check));
         } else if (!check()) {
@@ -2004,6 +2358,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     if (cacheFullScriptStore && !pvChecks) {
         // We executed all of the provided scripts, and were told to
         // cache the result. Do so now.
+        std::unique_lock<std::shared_mutex> lock(g_scriptExecutionCacheMutex);
         g_scriptExecutionCache.insert(hashCacheEntry);
     }
 
@@ -2124,8 +2479,6 @@ DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIn
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
-
 void StartScriptCheckWorkerThreads(int threads_num)
 {
     scriptcheckqueue.StartWorkerThreads(threads_num);
@@ -2390,7 +2743,11 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // in multiple threads). Preallocate the vector size so a new allocation
     // doesn't invalidate pointers into the vector, and keep txsdata in scope
     // for as long as `control`.
-    CCheckQueueControl<CScriptCheck> control(fScriptChecks && parallel_script_checks ? &scriptcheckqueue : nullptr);
+    // Signatures are only batched when they are not to be stored in the signature cache. Batches are
+    // verified on the check queue, also without worker threads.
+    const bool batch_schnorr{fScriptChecks && m_chainman.m_options.batch_verify && !fJustCheck};
+    const bool queue_script_checks{parallel_script_checks || batch_schnorr};
+    CCheckQueueControl<CScriptCheck, SchnorrBatch> control(fScriptChecks && queue_script_checks ? &scriptcheckqueue : nullptr);
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
 
     std::vector<int> prevheights;
@@ -2488,7 +2845,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             std::vector<CScriptCheck> vChecks;
             bool fCacheResults = fJustCheck; /* Don't cache results if we're actually connecting blocks (still consult the cache, though) */
             TxValidationState tx_state;
-            if (fScriptChecks && !CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], parallel_script_checks ? &vChecks : nullptr)) {
+            if (fScriptChecks && !CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], queue_script_checks ? &vChecks : nullptr, batch_schnorr)) {
                 // Any transaction validation failure in ConnectBlock is a block consensus failure
                 state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
                               tx_state.GetRejectReason(), tx_state.GetDebugMessage());
@@ -2578,6 +2935,21 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
 
 
     if (!control.Wait()) {
+        if (batch_schnorr) {
+            // A failed batch does not tell which input is invalid, so find it by checking the
+            // transactions again one by one. The coins they spend are gone from the view, but those
+            // of every transaction that was queued are in its txsdata.
+            for (unsigned int i = 1; i < block.vtx.size(); i++) {
+                if (!txsdata[i].m_spent_outputs_ready) continue;
+                TxValidationState tx_state;
+                if (!CheckInputScripts(*block.vtx[i], tx_state, view, flags, /*cacheSigStore=*/false, /*cacheFullScriptStore=*/false, txsdata[i])) {
+                    state.Invalid(BlockValidationResult::BLOCK_CONSENSUS,
+                                  tx_state.GetRejectReason(), tx_state.GetDebugMessage());
+                    return error("ConnectBlock(): CheckInputScripts on %s failed with %s",
+                        block.vtx[i]->GetHash().ToString(), state.ToString());
+                }
+            }
+        }
         LogPrintf("ERROR: %s: CheckQueue failed\n", __func__);
         return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, "block-validation-failed");
     }
@@ -3790,15 +4162,20 @@ void ChainstateManager::ReceivedBlockTransactions(const CBlock& block, CBlockInd
     }
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+static bool CheckBlockHeader(const CBlockHeader& block, const uint256& hash, BlockValidationState& state, const Consensus::Params& consensusParams)
 {
     // Check proof of work matches claimed amount
-    if (fCheckPOW && !CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
+    if (!CheckProofOfWork(hash, block.nBits, consensusParams))
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "high-hash", "proof of work failed");
 
     return true;
 }
 
+static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+{
+    return !fCheckPOW || CheckBlockHeader(block, block.GetHash(), state, consensusParams);
+}
+
 bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot)
 {
     // 이 블록이 이미 검증되었다면 통과
@@ -3933,8 +4310,16 @@ std::vector<unsigned char> ChainstateManager::GenerateCoinbaseCommitment(CBlock&
 
 bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams)
 {
-    return std::all_of(headers.cbegin(), headers.cend(),
-            [&](const auto& header) { return CheckProofOfWork(header.GetHash(), header.nBits, consensusParams);});
+    return HasValidProofOfWork(headers, GetBlockHeaderHashes(headers), consensusParams);
+}
+
+bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, Span<const uint256> hashes, const Consensus::Params& consensusParams)
+{
+    assert(hashes.size() == headers.size());
+    for (size_t i = 0; i < headers.size(); ++i) {
+        if (!CheckProofOfWork(hashes[i], headers[i].nBits, consensusParams)) return false;
+    }
+    return true;
 }
 
 arith_uint256 CalculateHeadersWork(const std::vector<CBlockHeader>& headers)
@@ -3966,8 +4351,8 @@ static bool ContextualCheckBlockHeader(const CBlockHeader& block, BlockValidatio
     const Consensus::Params& consensusParams = chainman.GetConsensus();
     // === POWDBG: 기대 vs 실제 nBits 찍기 ===
     unsigned int exp = GetNextWorkRequired(pindexPrev, &block, consensusParams);
-    LogPrintf("POWDBG[HDR]: h=%d exp=%08x got=%08x prev=%08x\n",
-              pindexPrev->nHeight + 1, exp, block.nBits, pindexPrev->nBits);
+    LogPrint(BCLog::VALIDATION, "POWDBG[HDR]: h=%d exp=%08x got=%08x prev=%08x\n",
+             pindexPrev->nHeight + 1, exp, block.nBits, pindexPrev->nBits);
     if (block.nBits != exp)
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "bad-diffbits", "incorrect proof of work");
 
@@ -4112,11 +4497,16 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
 
 
 bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
+{
+    return AcceptBlockHeader(block, block.GetHash(), state, ppindex, min_pow_checked);
+}
+
+bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, const uint256& hash, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
 {
     AssertLockHeld(cs_main);
+    Assume(hash == block.GetHash());
 
     // Check for duplicate
-    uint256 hash = block.GetHash();
     BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
     if (hash != GetConsensus().hashGenesisBlock) {
         if (miSelf != m_blockman.m_block_index.end()) {
@@ -4131,7 +4521,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, GetConsensus())) {
+        if (!CheckBlockHeader(block, hash, state, GetConsensus())) {
             LogPrint(BCLog::VALIDATION, "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__, hash.ToString(), state.ToString());
             return false;
         }
@@ -4196,7 +4586,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
         LogPrint(BCLog::VALIDATION, "%s: not adding new block header %s, missing anti-dos proof-of-work validation\n", __func__, hash.ToString());
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_LOW_WORK, "too-little-chainwork");
     }
-    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, m_best_header)};
+    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, hash, m_best_header)};
 
     if (ppindex)
         *ppindex = pindex;
@@ -4209,13 +4599,13 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
     // nodes in the network, this might be an indication of selfish mining. Having
     // this log by default when not in IBD ensures broad availability of this data
     // in case investigation is merited.
-    const auto msg = strprintf(
-        "Saw new header hash=%s height=%d", hash.ToString(), pindex->nHeight);
-
+    //
+    // The message is only formatted when it is logged, as this runs for
+    // every header during headers sync.
     if (IsInitialBlockDownload()) {
-        LogPrintLevel(BCLog::VALIDATION, BCLog::Level::Debug, "%s\n", msg);
+        LogPrintLevel(BCLog::VALIDATION, BCLog::Level::Debug, "Saw new header hash=%s height=%d\n", hash.ToString(), pindex->nHeight);
     } else {
-        LogPrintf("%s\n", msg);
+        LogPrintf("Saw new header hash=%s height=%d\n", hash.ToString(), pindex->nHeight);
     }
 
     return true;
@@ -4225,20 +4615,23 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
 bool ChainstateManager::ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex)
 {
     AssertLockNotHeld(cs_main);
+    // Hashing is the bulk of the context-free work, do it for the whole batch before taking cs_main.
+    const std::vector<uint256> hashes{GetBlockHeaderHashes(headers)};
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < headers.size(); ++i) {
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            bool accepted{AcceptBlockHeader(header, state, &pindex, /*min_pow_checked=*/true)};
-            CheckBlockIndex();
+            bool accepted{AcceptBlockHeader(headers[i], hashes[i], state, &pindex, /*min_pow_checked=*/true)};
 
             if (!accepted) {
+                CheckBlockIndex();
                 return false;
             }
             if (ppindex) {
                 *ppindex = pindex;
             }
         }
+        CheckBlockIndex();
     }
     if (NotifyHeaderTip(*this)) {
         if (IsInitialBlockDownload() && ppindex && *ppindex) {
@@ -4428,6 +4821,47 @@ MempoolAcceptResult ChainstateManager::ProcessTransaction(const CTransactionRef&
     return result;
 }
 
+std::vector<MempoolAcceptResult> ChainstateManager::ProcessTransactionBatch(const std::vector<CTransactionRef>& txs, bool test_accept,
+                                                                           std::optional<CFeeRate> client_maxfeerate)
+{
+    AssertLockHeld(cs_main);
+    std::vector<COutPoint> coins_to_uncache;
+    auto args = MemPoolAccept::ATMPArgs::BatchAccept(GetParams(), GetTime(), coins_to_uncache, test_accept, client_maxfeerate);
+    return ProcessBatch(ActiveChainstate(), txs, args, /*accept_times=*/{});
+}
+
+MempoolAcceptResult ChainstateManager::ProcessTransactionConcurrent(const CTransactionRef& tx, bool test_accept)
+{
+    AssertLockNotHeld(cs_main);
+    Chainstate& active_chainstate = ActiveChainstate();
+    if (!active_chainstate.GetMempool()) {
+        TxValidationState state;
+        state.Invalid(TxValidationResult::TX_NO_MEMPOOL, "no-mempool");
+        return MempoolAcceptResult::Failure(state);
+    }
+    CTxMemPool& pool{*active_chainstate.GetMempool()};
+
+    std::vector<COutPoint> coins_to_uncache;
+    auto args = MemPoolAccept::ATMPArgs::SingleAccept(GetParams(), GetTime(), /*bypass_limits=*/false, coins_to_uncache, test_accept);
+    MempoolAcceptResult result = MemPoolAccept(pool, active_chainstate).AcceptSingleTransactionConcurrent(tx, args);
+
+    LOCK(cs_main);
+    if (result.m_result_type != MempoolAcceptResult::ResultType::VALID) {
+        // See AcceptToMemoryPool().
+        for (const COutPoint& outpoint : coins_to_uncache) {
+            active_chainstate.CoinsTip().Uncache(outpoint);
+        }
+        TRACE2(mempool, rejected,
+                tx->GetHash().data(),
+                result.m_state.GetRejectReason().c_str()
+        );
+    }
+    BlockValidationState state_dummy;
+    active_chainstate.FlushStateToDisk(state_dummy, FlushStateMode::PERIODIC);
+    pool.check(active_chainstate.CoinsTip(), active_chainstate.m_chain.Height() + 1);
+    return result;
+}
+
 // 찾기용 앵커(시작): TESTBLOCKVALIDITY REGTEST BYPASS START
 bool TestBlockValidity(BlockValidationState& state,
                        const CChainParams& chainparams,
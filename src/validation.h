@@ -24,6 +24,7 @@
 #include <policy/packages.h>
 #include <policy/policy.h>
 #include <script/script_error.h>
+#include <span.h>
 #include <sync.h>
 #include <txdb.h>
 #include <txmempool.h> // For CTxMemPool::cs
@@ -53,6 +54,7 @@ class ChainstateManager;
 struct ChainTxData;
 class DisconnectedBlockTransactions;
 struct PrecomputedTransactionData;
+class SchnorrBatch;
 struct LockPoints;
 struct AssumeutxoData;
 namespace node {
@@ -251,6 +253,22 @@ MempoolAcceptResult AcceptToMemoryPool(Chainstate& active_chainstate, const CTra
                                        int64_t accept_time, bool bypass_limits, bool test_accept)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Try to add a batch of transactions read back from a mempool dump to the mempool, as done by
+ * ChainstateManager::ProcessTransactionBatch(), but keeping the time each entered the mempool.
+ *
+ * @param[in]  active_chainstate  Reference to the active chainstate.
+ * @param[in]  txs                The transactions, parents before children.
+ * @param[in]  accept_times       The time each transaction was first accepted to the mempool.
+ * @param[in]  scripts_verified   When true, don't verify the scripts, because they were verified
+ *                                against the current tip with the current flags before the dump.
+ *
+ * @returns one MempoolAcceptResult per transaction, in the order given.
+ */
+std::vector<MempoolAcceptResult> AcceptBatchToMemoryPool(Chainstate& active_chainstate, const std::vector<CTransactionRef>& txs,
+                                                         const std::vector<int64_t>& accept_times, bool scripts_verified)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /**
 * Validate (and maybe submit) a package to the mempool. See doc/policy/packages.md for full details
 * on package validation rules.
@@ -319,10 +337,12 @@ private:
     bool cacheStore;
     ScriptError error{SCRIPT_ERR_UNKNOWN_ERROR};
     PrecomputedTransactionData *txdata;
+    //! Whether to defer Schnorr signature verification to the batch of the check queue worker.
+    bool m_batch_schnorr;
 
 public:
-    CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn) :
-        m_tx_out(outIn), ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), txdata(txdataIn) { }
+    CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn, bool batch_schnorr = false) :
+        m_tx_out(outIn), ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), txdata(txdataIn), m_batch_schnorr(batch_schnorr) { }
 
     CScriptCheck(const CScriptCheck&) = delete;
     CScriptCheck& operator=(const CScriptCheck&) = delete;
@@ -330,6 +350,9 @@ public:
     CScriptCheck& operator=(CScriptCheck&&) = default;
 
     bool operator()();
+    /** Run the check, adding its Schnorr signatures to the batch if requested at construction. A
+     *  script error caused by an invalid batched signature is only detected when verifying it. */
+    bool operator()(SchnorrBatch& batch);
 
     ScriptError GetScriptError() const { return error; }
 };
@@ -359,6 +382,8 @@ bool TestBlockValidity(BlockValidationState& state,
 
 /** Check with the proof of work on each blockheader matches the value in nBits */
 bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams);
+/** Same as above, given the hashes of the headers (see GetBlockHeaderHashes) */
+bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, Span<const uint256> hashes, const Consensus::Params& consensusParams);
 
 /** Return the sum of the work on a given set of headers */
 arith_uint256 CalculateHeadersWork(const std::vector<CBlockHeader>& headers);
@@ -878,6 +903,13 @@ private:
         BlockValidationState& state,
         CBlockIndex** ppindex,
         bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    /** Same as above, for a header whose hash the caller already computed. */
+    bool AcceptBlockHeader(
+        const CBlockHeader& block,
+        const uint256& hash,
+        BlockValidationState& state,
+        CBlockIndex** ppindex,
+        bool min_pow_checked) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     friend Chainstate;
 
     /** Most recent headers presync progress update, for rate-limiting. */
@@ -1138,6 +1170,9 @@ public:
     /**
      * Process incoming block headers.
      *
+     * The headers are hashed as one batch before cs_main is taken, and are then all
+     * accepted while holding it once.
+     *
      * May not be called in a
      * validationinterface callback.
      *
@@ -1180,6 +1215,32 @@ public:
     [[nodiscard]] MempoolAcceptResult ProcessTransaction(const CTransactionRef& tx, bool test_accept=false)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Try to add a transaction to the memory pool, like ProcessTransaction(), but only holding
+     * cs_main and the mempool lock around the lookups and the final insertion, not while the
+     * transaction's scripts are verified. Safe to call from several threads at once.
+     *
+     * @param[in]  tx              The transaction to submit for mempool acceptance.
+     * @param[in]  test_accept     When true, run validation checks but don't submit to mempool.
+     */
+    [[nodiscard]] MempoolAcceptResult ProcessTransactionConcurrent(const CTransactionRef& tx, bool test_accept=false)
+        LOCKS_EXCLUDED(cs_main);
+
+    /**
+     * Try to add a batch of transactions to the memory pool. The transactions may be unrelated or
+     * spend each other, parents before children, but must not replace mempool transactions or
+     * spend the same coins. Each is accepted or rejected on its own; their scripts are verified
+     * in parallel on the script check threads.
+     *
+     * @param[in]  txs                The transactions to submit for mempool acceptance.
+     * @param[in]  test_accept        When true, run validation checks but don't submit to mempool.
+     * @param[in]  client_maxfeerate  If set, reject transactions paying a higher feerate.
+     * @returns one result per transaction, in the order given.
+     */
+    [[nodiscard]] std::vector<MempoolAcceptResult> ProcessTransactionBatch(const std::vector<CTransactionRef>& txs, bool test_accept = false,
+                                                                         std::optional<CFeeRate> client_maxfeerate = std::nullopt)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     //! Load the block tree and coins database from disk, initializing state if we're running with -reindex
     bool LoadBlockIndex() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
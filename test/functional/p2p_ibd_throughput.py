@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""
+Test block download scheduling during IBD with peers of different speeds.
+
+One peer serves blocks as fast as it can, another one serves them at a limited
+rate. Check that the node measures their download rates, asks the throttled peer
+for fewer blocks at once and doesn't mistake it for a staller. The time taken to
+sync is logged.
+"""
+
+import time
+
+from test_framework.blocktools import (
+        create_block,
+        create_coinbase,
+)
+from test_framework.messages import (
+        MSG_BLOCK,
+        MSG_TYPE_MASK,
+)
+from test_framework.p2p import (
+        CBlockHeader,
+        msg_block,
+        msg_headers,
+        NetworkThread,
+        P2PDataStore,
+)
+from test_framework.script import (
+        CScript,
+        OP_RETURN,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+        assert_equal,
+        assert_greater_than,
+)
+
+# Mirrors MAX_BLOCKS_IN_TRANSIT_PER_PEER in net_processing.cpp
+MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16
+BLOCK_PADDING = 200_000
+SLOW_PEER_RATE = 1_000_000  # bytes per second
+
+
+class P2PThrottled(P2PDataStore):
+    """Serves blocks one after the other at a limited rate, as if over a slow link."""
+    def __init__(self, rate=None):
+        super().__init__()
+        self.rate = rate
+        self.link_free_at = 0
+        self.blocks_served = 0
+
+    def on_getdata(self, message):
+        for inv in message.inv:
+            if (inv.type & MSG_TYPE_MASK) != MSG_BLOCK:
+                continue
+            msg = msg_block(self.block_store[inv.hash])
+            self.blocks_served += 1
+            if self.rate is None:
+                self.send_message(msg)
+                continue
+            loop = NetworkThread.network_event_loop
+            self.link_free_at = max(self.link_free_at, loop.time()) + len(msg.serialize()) / self.rate
+            loop.call_at(self.link_free_at, self.send_message, msg)
+
+    def on_getheaders(self, message):
+        pass
+
+
+class P2PIBDThroughputTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def build_chain(self, tip, height, block_time, count):
+        blocks = []
+        for _ in range(count):
+            coinbase = create_coinbase(height, nValue=0, extra_output_script=CScript([OP_RETURN, b'\x00' * BLOCK_PADDING]))
+            blocks.append(create_block(tip, coinbase, block_time))
+            blocks[-1].solve()
+            tip = blocks[-1].sha256
+            block_time += 1
+            height += 1
+        return blocks
+
+    def send_headers(self, peer, blocks):
+        headers_message = msg_headers()
+        headers_message.headers = [CBlockHeader(b) for b in blocks]
+        peer.send_message(headers_message)
+
+    def run_test(self):
+        NUM_BLOCKS = 120
+        node = self.nodes[0]
+        tip = int(node.getbestblockhash(), 16)
+        block_time = node.getblock(node.getbestblockhash())['time'] + 1
+
+        self.log.info("Prepare blocks without sending them to the node")
+        blocks = self.build_chain(tip, 1, block_time, NUM_BLOCKS)
+        block_dict = {b.sha256: b for b in blocks}
+        total_bytes = sum(len(b.serialize()) for b in blocks)
+
+        fast_peer = node.add_outbound_p2p_connection(P2PThrottled(), p2p_idx=0, connection_type="outbound-full-relay")
+        slow_peer = node.add_outbound_p2p_connection(P2PThrottled(SLOW_PEER_RATE), p2p_idx=1, connection_type="outbound-full-relay")
+        for peer in (fast_peer, slow_peer):
+            peer.block_store = block_dict
+
+        self.log.info(f"Sync {NUM_BLOCKS} blocks ({total_bytes / 1e6:.1f} MB) from a fast and a throttled peer")
+        start = time.time()
+        for peer in (fast_peer, slow_peer):
+            self.send_headers(peer, blocks)
+        self.wait_until(lambda: node.getbestblockhash() == blocks[-1].hash, timeout=120)
+        elapsed = time.time() - start
+        self.log.info(f"Synced in {elapsed:.2f}s ({total_bytes / 1e6 / elapsed:.1f} MB/s); blocks served: fast={fast_peer.blocks_served}, throttled={slow_peer.blocks_served}")
+
+        self.log.info("Check that the throttled peer was not disconnected for stalling")
+        assert_equal(node.num_test_p2p_connections(), 2)
+
+        self.log.info("Check that download rates were measured and the fast peer did most of the work")
+        fast_info, slow_info = node.getpeerinfo()
+        assert_greater_than(slow_info['block_download_rate'], 0)
+        assert_greater_than(fast_info['block_download_rate'], slow_info['block_download_rate'])
+        assert_greater_than(fast_peer.blocks_served, slow_peer.blocks_served)
+
+        self.log.info("Check that the throttled peer is asked for no more blocks than it can deliver in time")
+        fast_peer.peer_disconnect()
+        fast_peer.wait_for_disconnect()
+        self.wait_until(lambda: node.num_test_p2p_connections() == 1)
+        more_blocks = self.build_chain(blocks[-1].sha256, NUM_BLOCKS + 1, blocks[-1].nTime + 1, 30)
+        slow_peer.block_store.update({b.sha256: b for b in more_blocks})
+        self.send_headers(slow_peer, more_blocks)
+        self.wait_until(lambda: len(node.getpeerinfo()[0]['inflight']) > 0)
+        assert_greater_than(MAX_BLOCKS_IN_TRANSIT_PER_PEER, len(node.getpeerinfo()[0]['inflight']))
+        self.wait_until(lambda: node.getbestblockhash() == more_blocks[-1].hash, timeout=120)
+        assert_equal(node.num_test_p2p_connections(), 1)
+
+
+if __name__ == '__main__':
+    P2PIBDThroughputTest().main()
@@ -7,10 +7,17 @@
 Test the following RPCs:
    - estimatesmartfee
    - estimaterawfee
+   - getmempoolinfo (feerate histogram and simulated blocks)
 """
 
+from decimal import Decimal
+
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_raises_rpc_error
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import MiniWallet
 
 class EstimateFeeTest(BitcoinTestFramework):
     def set_test_params(self):
@@ -50,6 +57,47 @@ class EstimateFeeTest(BitcoinTestFramework):
         self.nodes[0].estimaterawfee(1, None)
         self.nodes[0].estimaterawfee(1, 1)
 
+        self.test_mempool_mode()
+
+    def test_mempool_mode(self):
+        node = self.nodes[0]
+        self.log.info("Test estimates from the mempool contents")
+        assert_raises_rpc_error(-8, "Invalid conf_target, must be between 1 and 1008", node.estimatesmartfee, 1009, "mempool")
+        assert_raises_rpc_error(-8, "Invalid blocks, must be between 0 and 1008", node.getmempoolinfo, 1009)
+
+        info = node.getmempoolinfo()
+        assert_equal(info["feerate_histogram"], [])
+        assert "blocks" not in info
+        # An empty mempool leaves the mempool minimum fee.
+        assert_equal(node.estimatesmartfee(1, "mempool"), {"feerate": info["mempoolminfee"], "blocks": 1})
+        assert_equal(node.estimatesmartfee(1008, "MEMPOOL"), {"feerate": info["mempoolminfee"], "blocks": 1008})
+
+        wallet = MiniWallet(node)
+        low = wallet.send_self_transfer(from_node=node, fee_rate=Decimal("0.00002"))
+        high = wallet.send_self_transfer(from_node=node, fee_rate=Decimal("0.00020"))
+        info = node.getmempoolinfo(blocks=3)
+        histogram = info["feerate_histogram"]
+        assert_equal(len(histogram), 2)
+        assert_equal(sum(bucket["vsize"] for bucket in histogram), info["bytes"])
+        assert histogram[0]["feerate"] <= Decimal("0.00002") < histogram[1]["feerate"] <= Decimal("0.00020")
+        assert_equal([bucket["vsize"] for bucket in histogram], [low["tx"].get_vsize(), high["tx"].get_vsize()])
+
+        # Both transactions fit in the next block, which is not full.
+        assert_equal(len(info["blocks"]), 1)
+        block = info["blocks"][0]
+        assert_equal(block["vsize"], info["bytes"])
+        assert_equal(block["fees"], info["total_fee"])
+        assert_equal(block["full"], False)
+        assert_equal(block["minfeerate"], Decimal(low["fee"] * 1000 / low["tx"].get_vsize()).quantize(Decimal("0.00000001"), rounding="ROUND_DOWN"))
+        assert_equal(node.estimatesmartfee(1, "mempool")["feerate"], info["mempoolminfee"])
+
+        self.log.info("Prioritisation counts")
+        node.prioritisetransaction(txid=low["txid"], fee_delta=100000)
+        info = node.getmempoolinfo(blocks=3)
+        assert_equal(info["feerate_histogram"][-1]["vsize"], low["tx"].get_vsize())
+        assert_equal(info["blocks"][0]["fees"], info["total_fee"] + Decimal("0.001"))
+        assert_equal(info["blocks"][0]["minfeerate"], Decimal(high["fee"] * 1000 / high["tx"].get_vsize()).quantize(Decimal("0.00000001"), rounding="ROUND_DOWN"))
+
 
 if __name__ == '__main__':
     EstimateFeeTest().main()
@@ -123,6 +123,7 @@ class NetTest(BitcoinTestFramework):
                 "addr_rate_limited": 0,
                 "addr_relay_enabled": False,
                 "bip152_hb_from": False,
+                "block_download_rate": 0,
                 "bip152_hb_to": False,
                 "bytesrecv": 0,
                 "bytesrecv_per_msg": {},
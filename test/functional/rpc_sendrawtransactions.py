@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test batch transaction submission through the sendrawtransactions RPC and REST endpoint."""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import MiniWallet
+
+
+class SendRawTransactionsTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [["-rest", "-whitelist=noban@127.0.0.1"], ["-whitelist=noban@127.0.0.1"]]
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+
+        self.test_independent()
+        self.test_chain()
+        self.test_failures()
+        self.test_rest()
+
+    def assert_allowed(self, results, txs):
+        assert_equal([res["txid"] for res in results], [tx["txid"] for tx in txs])
+        for res, tx in zip(results, txs):
+            assert_equal(res["wtxid"], tx["wtxid"])
+            assert_equal(res["allowed"], True)
+            assert_equal(res["vsize"], tx["tx"].get_vsize())
+            assert res["txid"] in self.nodes[0].getrawmempool()
+
+    def test_independent(self):
+        self.log.info("Submit unrelated transactions in one batch")
+        node = self.nodes[0]
+        txs = [self.wallet.create_self_transfer() for _ in range(20)]
+        results = node.sendrawtransactions([tx["hex"] for tx in txs])
+        self.assert_allowed(results, txs)
+        self.log.info("Accepted transactions are relayed")
+        self.sync_mempools()
+
+    def test_chain(self):
+        self.log.info("Submit a chain of transactions, parents first")
+        node = self.nodes[0]
+        chain = self.wallet.create_self_transfer_chain(chain_length=10)
+        results = node.sendrawtransactions([tx["hex"] for tx in chain])
+        self.assert_allowed(results, chain)
+        self.sync_mempools()
+
+        self.log.info("Transactions already in the mempool are rejected")
+        results = node.sendrawtransactions([chain[0]["hex"]])
+        assert_equal(results[0]["allowed"], False)
+        assert_equal(results[0]["reject-reason"], "txn-already-in-mempool")
+
+    def test_failures(self):
+        node = self.nodes[0]
+        self.log.info("A transaction failing does not take down unrelated ones")
+        good = self.wallet.create_self_transfer()
+        expensive = self.wallet.create_self_transfer(fee_rate=Decimal("0.5"))
+        expensive_child = self.wallet.create_self_transfer(utxo_to_spend=expensive["new_utxo"])
+        results = node.sendrawtransactions([expensive["hex"], expensive_child["hex"], good["hex"]])
+        assert_equal(results[0]["allowed"], False)
+        assert_equal(results[0]["reject-reason"], "max feerate exceeded")
+        assert_equal(results[1]["allowed"], False)
+        assert_equal(results[1]["reject-reason"], "missing-inputs")
+        self.assert_allowed(results[2:], [good])
+
+        self.log.info("The maximum feerate can be lifted")
+        results = node.sendrawtransactions([expensive["hex"], expensive_child["hex"]], 0)
+        self.assert_allowed(results, [expensive, expensive_child])
+
+        self.log.info("Two transactions of the batch cannot spend the same coin")
+        utxo = self.wallet.get_utxo()
+        first = self.wallet.create_self_transfer(utxo_to_spend=utxo)
+        second = self.wallet.create_self_transfer(utxo_to_spend=utxo, fee_rate=Decimal("0.01"))
+        results = node.sendrawtransactions([first["hex"], second["hex"]])
+        self.assert_allowed(results[:1], [first])
+        assert_equal(results[1]["allowed"], False)
+        assert_equal(results[1]["reject-reason"], "batch-txn-conflict")
+
+        self.log.info("Check the arguments")
+        assert_raises_rpc_error(-8, "Array must contain between 1 and", node.sendrawtransactions, [])
+        assert_raises_rpc_error(-22, "TX decode failed", node.sendrawtransactions, ["00"])
+
+    def test_rest(self):
+        self.log.info("Submit a batch through REST")
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        chain = self.wallet.create_self_transfer_chain(chain_length=3)
+
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request("POST", "/rest/sendrawtransactions.json", json.dumps([tx["hex"] for tx in chain]))
+        resp = conn.getresponse()
+        assert_equal(resp.status, 200)
+        self.assert_allowed(json.loads(resp.read().decode("utf-8"), parse_float=Decimal), chain)
+        self.sync_mempools()
+
+        conn.request("GET", "/rest/sendrawtransactions.json")
+        resp = conn.getresponse()
+        assert_equal(resp.status, 405)
+        resp.read()
+
+        conn.request("POST", "/rest/sendrawtransactions.json", "not json")
+        resp = conn.getresponse()
+        assert_equal(resp.status, 400)
+        resp.read()
+
+
+if __name__ == '__main__':
+    SendRawTransactionsTest().main()
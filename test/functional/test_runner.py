@@ -140,6 +140,7 @@ BASE_SCRIPTS = [
     'wallet_taproot.py --descriptors',
     'feature_bip68_sequence.py',
     'rpc_packages.py',
+    'rpc_sendrawtransactions.py',
     'rpc_bind.py --ipv4',
     'rpc_bind.py --ipv6',
     'rpc_bind.py --nonloopback',
@@ -279,6 +280,7 @@ BASE_SCRIPTS = [
     'p2p_eviction.py',
     'p2p_ibd_stalling.py',
     'p2p_ibd_stalling.py --v2transport',
+    'p2p_ibd_throughput.py',
     'p2p_net_deadlock.py',
     'p2p_net_deadlock.py --v2transport',
     'wallet_signmessagewithaddress.py',